@@ -1,17 +1,34 @@
 
 #pragma once
 
+#include "CancellationToken.hh"
 #include "CoreObject.hh"
 #include "JobPriority.hh"
+#include "TimeUtils.hh"
 #include <memory>
+#include <optional>
 
 namespace utils {
 
+/// @brief - Base class of the jobs executed by a thread pool. Inheriting classes
+/// implement `compute`, which receives a token telling whether the result of the
+/// job is still needed. Jobs which used to override `compute()` without argument
+/// should override `compute(const CancellationToken &)` instead and can ignore
+/// the token. Callers running a job outside of a pool use `run`.
 class AsynchronousJob : public CoreObject {
 public:
   /// @brief - Interface method allowing to schedule the operations related to
-  /// this object. Used by the thread pool to execute this job.
-  virtual void compute() = 0;
+  /// this object. The token tells whether the result of the job is still needed:
+  /// long jobs should poll `token.stopRequested()` to bail out early once their
+  /// batch is cancelled or their deadline is past. Used by the thread pool to
+  /// execute this job.
+  /// @param token - the token of this execution of the job.
+  virtual void compute(const CancellationToken &token) = 0;
+
+  /// @brief - Execute the job with a token which is never cancelled. It has a
+  /// different name than `compute` so that overriding the latter doesn't hide
+  /// it in inheriting classes.
+  void run();
 
   /// @brief - Retrieve the priority associated to this job. We assume that the
   /// priority cannot be modified once the job has been created hence the fact
@@ -19,6 +36,19 @@ public:
   /// @return - the priority associated to this job.
   auto getPriority() const noexcept -> Priority;
 
+  /// @brief - Retrieve the memory node close to the data used by this job. The
+  /// thread pool runs the job on a thread of this node whenever possible. Just
+  /// like the priority it cannot be modified once the job has been created.
+  /// @return - the preferred node of this job or an empty value if it has no
+  /// preference.
+  auto getNodeHint() const noexcept -> std::optional<unsigned>;
+
+  /// @brief - Retrieve the time by which this job should be done. The thread pool
+  /// uses it to order the jobs when configured to do so. The default is to have
+  /// no deadline: inheriting classes can override this behavior.
+  /// @return - the deadline of the job or an empty value if it has none.
+  virtual auto getDeadline() const noexcept -> std::optional<TimeStamp>;
+
 protected:
   /// @brief - Creates a new job with the specified priority. The default
   /// priority is set to normal. This constructor is only accessible to
@@ -26,12 +56,17 @@ protected:
   /// create a new job.
   ///@param name - the name of this job.Used to provide decent logging.
   /// @param priority - the priority of the job to create.
+  /// @param node - the memory node on which the job should preferably run.
   AsynchronousJob(const std::string &name,
-                  const Priority &priority = Priority::Normal);
+                  const Priority &priority = Priority::Normal,
+                  const std::optional<unsigned> &node = {});
 
 private:
   /// @brief - The priority associated to this job.
   Priority m_priority;
+
+  /// @brief - The memory node on which this job should preferably run.
+  std::optional<unsigned> m_node;
 };
 
 using AsynchronousJobShPtr = std::shared_ptr<AsynchronousJob>;
@@ -6,15 +6,28 @@
 namespace utils {
 
 inline AsynchronousJob::AsynchronousJob(const std::string &name,
-                                        const Priority &priority)
+                                        const Priority &priority,
+                                        const std::optional<unsigned> &node)
     : CoreObject(name),
 
-      m_priority(priority) {
+      m_priority(priority), m_node(node) {
   setService("job");
 }
 
+inline void AsynchronousJob::run() { compute(CancellationToken()); }
+
 inline auto AsynchronousJob::getPriority() const noexcept -> Priority {
   return m_priority;
 }
 
+inline auto AsynchronousJob::getNodeHint() const noexcept
+    -> std::optional<unsigned> {
+  return m_node;
+}
+
+inline auto AsynchronousJob::getDeadline() const noexcept
+    -> std::optional<TimeStamp> {
+  return {};
+}
+
 } // namespace utils
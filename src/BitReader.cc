@@ -1,58 +1,130 @@
-
 #include "BitReader.hh"
+#include <algorithm>
+#include <cstring>
 
 namespace utils {
-constexpr auto BITS_IN_A_BYTE = 8u;
+/// @brief - The size in bytes of the blocks read from a stream.
+constexpr auto BLOCK_SIZE = 65536u;
+
+BitReader::BitReader(std::istream &in)
+  : CoreObject("reader")
+  , m_in(&in)
+  , m_block(std::make_unique<unsigned char[]>(BLOCK_SIZE))
+{
+  setService("binary");
+
+  m_next = m_block.get();
+  m_end  = m_block.get();
+}
 
-BitReader::BitReader(std::ifstream &in)
+BitReader::BitReader(std::span<const unsigned char> data)
   : CoreObject("reader")
-  , m_in(in)
-  , m_pending(BITS_IN_A_BYTE, false)
+  , m_next(data.data())
+  , m_end(data.data() + data.size())
 {
   setService("binary");
 }
 
+BitReader::BitReader(const std::filesystem::path &path)
+  : CoreObject("reader")
+  , m_file(std::make_unique<MappedFile>(path))
+{
+  setService("binary");
+
+  m_file->adviseSequential();
+
+  m_next = m_file->bytes().data();
+  m_end  = m_next + m_file->size();
+}
+
 bool BitReader::done() const noexcept
 {
-  return !m_in.good();
+  return m_available == 0u && m_next == m_end && (m_in == nullptr || !m_in->good());
 }
 
-bool BitReader::read() noexcept
+void BitReader::skip(std::uint64_t nbits) noexcept
 {
-  if (done())
+  // Skip whole bytes of the source without going through the buffer:
+  // the bits of the next byte which might be in the buffer are cleared.
+  if (nbits > m_available)
   {
-    return false;
+    nbits      -= m_available;
+    m_consumed += m_available;
+    m_buffer    = 0u;
+    m_available = 0u;
+
+    const auto bytes = std::min<std::uint64_t>(nbits / 8u, m_end - m_next);
+    m_next     += bytes;
+    m_consumed += 8u * bytes;
+    nbits      -= 8u * bytes;
   }
 
-  if (m_bit < 0)
+  while (nbits > 0u)
   {
-    fetch();
+    refill();
+    if (m_available == 0u)
+    {
+      return;
+    }
+
+    const auto count = static_cast<unsigned>(std::min<std::uint64_t>(nbits, m_available));
+    consume(count);
+    nbits -= count;
   }
+}
+
+auto BitReader::readUnary() noexcept -> std::uint64_t
+{
+  std::uint64_t out = 0u;
+
+  while (true)
+  {
+    refill();
+    if (m_available == 0u)
+    {
+      return out;
+    }
 
-  const auto b = m_pending[m_bit];
-  --m_bit;
+    const auto zeros = static_cast<unsigned>(std::countl_zero(m_buffer));
+    if (zeros < m_available)
+    {
+      consume(zeros + 1u);
+      return out + zeros;
+    }
 
-  return b;
+    out += m_available;
+    consume(m_available);
+  }
 }
 
-void BitReader::fetch() noexcept
+void BitReader::refillSlow() noexcept
 {
-  // Note that we assume that the file defines an entire
-  // amount of bytes (with maybe some padding). If this
-  // assumption is not verified we might not get the last
-  // bits out of the input stream and so fail to get the
-  // last data.
-  unsigned char buf = 0u;
-  m_in.read(reinterpret_cast<char *>(&buf), sizeof(unsigned char));
-
-  // Parse the content of the byte.
-  for (unsigned id = 0u; id < 8u; ++id)
+  // Move the remaining bytes at the beginning of the block and
+  // complete it with the next bytes of the stream.
+  if (m_in != nullptr && m_in->good())
   {
-    m_pending[id] = (buf >> id) & 1;
+    const auto remaining = static_cast<std::size_t>(m_end - m_next);
+    std::memmove(m_block.get(), m_next, remaining);
+
+    m_in->read(reinterpret_cast<char *>(m_block.get() + remaining), BLOCK_SIZE - remaining);
+
+    m_next = m_block.get();
+    m_end  = m_block.get() + remaining + m_in->gcount();
+
+    if (m_end - m_next >= 8)
+    {
+      refill();
+      return;
+    }
   }
 
-  // Reset the internal counter.
-  m_bit = 7u;
+  // The source is almost over: add the last bytes one at a time.
+  while (m_available < MAX_PEEK_BITS && m_next < m_end)
+  {
+    m_buffer |= std::uint64_t{*m_next} << (MAX_PEEK_BITS - m_available);
+    ++m_next;
+    m_available += 8u;
+  }
 }
 
 } // namespace utils
@@ -2,21 +2,44 @@
 #pragma once
 
 #include "CoreObject.hh"
-#include <fstream>
-#include <vector>
+#include "MappedFile.hh"
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <span>
 
 namespace utils {
 
+/// @brief - Reads bits from a source, in the order they are written by the
+/// `BitWriter`: bits are unpacked from each byte starting with the most
+/// significant one. The reader keeps a 64-bit buffer of bits which is refilled
+/// a word at a time from a block of memory: either the input data, a memory
+/// mapping of a file or a block read from a stream. Bits past the end of the
+/// source are read as zeros.
 class BitReader : public CoreObject
 {
   public:
   /// @brief - Generate a new bit reader which will read a file a get bits individually.
   /// @param in - the input stream from which bits should be read. We assume that the
   /// stream is already *opened and valid.
-  BitReader(std::ifstream &in);
+  BitReader(std::istream &in);
 
-  /// @brief - Whether the stream reached its end.
-  /// @return - `true` if the stream is over.
+  /// @brief - Generate a new bit reader reading the input bytes.
+  /// @param data - the bytes to read. They should outlive the reader.
+  BitReader(std::span<const unsigned char> data);
+
+  /// @brief - Generate a new bit reader mapping the input file in memory. An
+  /// exception is raised in case the file can't be mapped.
+  /// @param path - the path to the file to read.
+  BitReader(const std::filesystem::path &path);
+
+  BitReader(const BitReader &) = delete;
+  BitReader &operator=(const BitReader &) = delete;
+
+  /// @brief - Whether all the bits of the source were read. When reading from a
+  /// stream the end is only detected once a read from the stream fails.
+  /// @return - `true` if the source is over.
   bool done() const noexcept;
 
   /// @brief - Read a single bit from the input file. In case the stream is over
@@ -24,23 +47,69 @@ class BitReader : public CoreObject
   /// @return - the value of the next bit.
   bool read() noexcept;
 
+  /// @brief - Return the value of the next bits without consuming them, the first
+  /// bit being the most significant one.
+  /// @param nbits - the number of bits to look at, at most `MAX_PEEK_BITS`.
+  /// @return - the value of the bits.
+  auto peek(const unsigned nbits) noexcept -> std::uint64_t;
+
+  /// @brief - Read the next bits, the first bit being the most significant one.
+  /// @param nbits - the number of bits to read, at most `64`.
+  /// @return - the value of the bits.
+  auto read(const unsigned nbits) noexcept -> std::uint64_t;
+
+  /// @brief - Ignore the next bits.
+  /// @param nbits - the number of bits to skip.
+  void skip(std::uint64_t nbits) noexcept;
+
+  /// @brief - Read a number coded in unary: the count of `0` bits before the
+  /// next `1` bit, which is consumed as well.
+  /// @return - the number of `0` bits read.
+  auto readUnary() noexcept -> std::uint64_t;
+
+  /// @brief - The number of bits read or skipped since the creation of the reader.
+  auto bitsRead() const noexcept -> std::uint64_t;
+
+  /// @brief - The maximum number of bits which can be peeked at once.
+  static constexpr auto MAX_PEEK_BITS = 56u;
+
   private:
-  /// @brief - Fetch the next bits from the input stream.
-  void fetch() noexcept;
+  /// @brief - Make sure that the buffer holds at least `MAX_PEEK_BITS` bits, in
+  /// case the source has enough of them.
+  void refill() noexcept;
+
+  /// @brief - Used by `refill` when less than a word is available in the block:
+  /// the next block is read from the stream if any, otherwise the last bytes are
+  /// added one by one.
+  void refillSlow() noexcept;
+
+  /// @brief - Remove bits from the buffer. The buffer never holds more than `63` bits.
+  void consume(const unsigned nbits) noexcept;
 
   private:
-  /// @brief - Where bits will be saved.
-  std::ifstream &m_in;
-
-  /// @brief - The pending bits to read. Note that the bits are stored in the reverse
-  /// order as they are in the file: typically the last bit of the vector is the last
-  /// value of the byte read from the file. So we have to read the bits from the end
-  /// of the vector to the beginning.
-  std::vector<bool> m_pending{};
-
-  /// @brief - In order to avoid allocating and freeing the bits each time we read
-  /// them we use an index which references the position of the next bit to read.
-  int m_bit{-1};
+  /// @brief - The stream to read from, if any.
+  std::istream *m_in{nullptr};
+
+  /// @brief - The block read from the stream.
+  std::unique_ptr<unsigned char[]> m_block{};
+
+  /// @brief - The file to read, if any.
+  std::unique_ptr<MappedFile> m_file{};
+
+  /// @brief - The next byte to add to the buffer and the end of the available
+  /// bytes.
+  const unsigned char *m_next{nullptr};
+  const unsigned char *m_end{nullptr};
+
+  /// @brief - The bits to read next, starting with the most significant bit. The
+  /// bits after the first `m_available` ones are either `0` or the first bits of
+  /// the next byte.
+  std::uint64_t m_buffer{0u};
+  unsigned m_available{0u};
+
+  std::uint64_t m_consumed{0u};
 };
 
 } // namespace utils
+
+#include "BitReader.hxx"
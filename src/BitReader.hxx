@@ -0,0 +1,73 @@
+#pragma once
+
+#include "BitReader.hh"
+#include <bit>
+#include <cstring>
+
+namespace utils {
+
+inline bool BitReader::read() noexcept
+{
+  return read(1u) != 0u;
+}
+
+inline auto BitReader::peek(const unsigned nbits) noexcept -> std::uint64_t
+{
+  refill();
+  return nbits == 0u ? 0u : m_buffer >> (64u - nbits);
+}
+
+inline auto BitReader::read(const unsigned nbits) noexcept -> std::uint64_t
+{
+  if (nbits > MAX_PEEK_BITS)
+  {
+    const auto high = read(nbits - 32u);
+    return (high << 32u) | read(32u);
+  }
+
+  const auto out = peek(nbits);
+  consume(nbits);
+
+  return out;
+}
+
+inline auto BitReader::bitsRead() const noexcept -> std::uint64_t
+{
+  return m_consumed;
+}
+
+inline void BitReader::refill() noexcept
+{
+  if (m_available >= MAX_PEEK_BITS)
+  {
+    return;
+  }
+
+  if (m_end - m_next < 8)
+  {
+    refillSlow();
+    return;
+  }
+
+  // Load a whole word and keep as many complete bytes as possible: the
+  // remaining bits of the word are loaded again by the next refill.
+  std::uint64_t word;
+  std::memcpy(&word, m_next, sizeof(word));
+  if constexpr (std::endian::native == std::endian::little)
+  {
+    word = __builtin_bswap64(word);
+  }
+
+  m_buffer    |= word >> m_available;
+  m_next      += (63u - m_available) / 8u;
+  m_available |= MAX_PEEK_BITS;
+}
+
+inline void BitReader::consume(const unsigned nbits) noexcept
+{
+  m_buffer  <<= nbits;
+  m_consumed += nbits;
+  m_available = (nbits < m_available ? m_available - nbits : 0u);
+}
+
+} // namespace utils
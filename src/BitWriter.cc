@@ -1,66 +1,134 @@
-
 #include "BitWriter.hh"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
 
 namespace utils {
 
-BitWriter::BitWriter(std::ofstream &out)
+BitWriter::BitWriter(std::ostream &out)
   : CoreObject("writer")
-  , m_out(out)
-  , m_pending()
+  , m_sink(Sink::Stream)
+  , m_out(&out)
+  , m_block(std::make_unique<unsigned char[]>(BLOCK_SIZE))
 {
   setService("binary");
 }
 
-void BitWriter::push(bool b) noexcept
+BitWriter::BitWriter(std::vector<unsigned char> &out)
+  : CoreObject("writer")
+  , m_sink(Sink::Memory)
+  , m_memory(&out)
+  , m_block(std::make_unique<unsigned char[]>(BLOCK_SIZE))
 {
-  m_pending.push_back(b);
+  setService("binary");
+}
 
-  // Flush to the output stream if needed.
-  if (m_pending.size() == 8u)
-  {
-    flush(false);
-  }
+BitWriter::BitWriter(const int fd)
+  : CoreObject("writer")
+  , m_sink(Sink::File)
+  , m_fd(fd)
+  , m_block(std::make_unique<unsigned char[]>(BLOCK_SIZE))
+{
+  setService("binary");
+}
+
+BitWriter::~BitWriter()
+{
+  // Write the complete bytes: the remaining bits are lost unless they
+  // were flushed.
+  spillBytes();
+  drain();
 }
 
 void BitWriter::flush(bool pad) noexcept
 {
-  // Create the output byte. The code is inspired from this topic:
-  // https://stackoverflow.com/questions/1856514/writing-files-in-bit-form-to-a-file-in-c?rq=1
-  unsigned char buf = 0u;
+  // Complete the last byte with padding: in case it is empty, a whole
+  // byte of padding is written.
+  const auto missing = 8u - m_count % 8u;
+  push(pad ? ~std::uint64_t{0u} : 0u, missing);
+
+  spillBytes();
+  drain();
+}
 
-  unsigned id = 0u;
-  while (id < m_pending.size())
+void BitWriter::spill() noexcept
+{
+  if (m_used + sizeof(m_bits) > BLOCK_SIZE)
   {
-    // As we traverse the bits in reverse order (as we're
-    // decrementing the internal counter), we will register
-    // the bits in the same order as we read them from the
-    // value.
-    buf <<= 1;
-    if (m_pending[id])
+    drain();
+  }
+
+  // The accumulator is full: write it starting with its most
+  // significant byte.
+  for (unsigned id = 0u; id < sizeof(m_bits); ++id)
+  {
+    const auto shift     = ACCUMULATOR_BITS - 8u * (id + 1u);
+    m_block[m_used + id] = static_cast<unsigned char>(m_bits >> shift);
+  }
+
+  m_used += sizeof(m_bits);
+}
+
+void BitWriter::spillBytes() noexcept
+{
+  while (m_count >= 8u)
+  {
+    if (m_used == BLOCK_SIZE)
     {
-      buf |= 0x1;
+      drain();
     }
 
-    ++id;
+    m_count -= 8u;
+
+    m_block[m_used] = static_cast<unsigned char>(m_bits >> m_count);
+    ++m_used;
   }
 
-  // Add padding.
-  while (id < 8u)
+  m_bits &= (std::uint64_t{1u} << m_count) - 1u;
+}
+
+void BitWriter::drain() noexcept
+{
+  if (m_used == 0u)
   {
-    buf <<= 1;
+    return;
+  }
 
-    if (pad)
+  switch (m_sink)
+  {
+    case Sink::Stream:
+      m_out->write(reinterpret_cast<const char *>(m_block.get()),
+                   static_cast<std::streamsize>(m_used));
+      break;
+    case Sink::Memory:
+      m_memory->insert(m_memory->end(), m_block.get(), m_block.get() + m_used);
+      break;
+    case Sink::File:
+    default:
     {
-      buf |= 0x1;
-    }
+      std::size_t offset = 0u;
+      while (offset < m_used)
+      {
+        const auto written = ::write(m_fd, m_block.get() + offset, m_used - offset);
+        if (written < 0 && errno == EINTR)
+        {
+          continue;
+        }
+        if (written <= 0)
+        {
+          warn("Failed to write " + std::to_string(m_used - offset) + " byte(s)",
+               std::string(std::strerror(errno)));
+          break;
+        }
 
-    ++id;
+        offset += static_cast<std::size_t>(written);
+      }
+      break;
+    }
   }
 
-  m_out.write(reinterpret_cast<char *>(&buf), sizeof(unsigned char));
-
-  // Clear pending queue of bits to be flushed.
-  m_pending.clear();
+  m_written += m_used;
+  m_used     = 0u;
 }
 
 } // namespace utils
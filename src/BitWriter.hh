@@ -2,11 +2,19 @@
 #pragma once
 
 #include "CoreObject.hh"
-#include <fstream>
+#include <cstdint>
+#include <memory>
+#include <ostream>
 #include <vector>
 
 namespace utils {
 
+/// @brief - Accumulates bits and writes them to a sink. The bits are packed in
+/// bytes starting with the most significant bit of each byte. Bits are gathered
+/// in a 64-bit accumulator and then in a block of memory which is written to the
+/// sink in one go when it is full, so that pushing bits is cheap. Only complete
+/// bytes reach the sink: use `flush` to write the last bits with some padding.
+/// The pending complete bytes are written when the writer is destroyed.
 class BitWriter : public CoreObject
 {
   public:
@@ -14,7 +22,20 @@ class BitWriter : public CoreObject
   /// in the provided stream.
   /// @param out - the output stream to which bits should be saved. We assume that
   /// the stream is already opened and valid.
-  BitWriter(std::ofstream &out);
+  BitWriter(std::ostream &out);
+
+  /// @brief - Generate a new bit writer appending the bytes to the input buffer.
+  /// @param out - the buffer receiving the bytes.
+  BitWriter(std::vector<unsigned char> &out);
+
+  /// @brief - Generate a new bit writer writing bytes to a file descriptor.
+  /// @param fd - the file descriptor to write to. It is not closed by the writer.
+  BitWriter(const int fd);
+
+  ~BitWriter();
+
+  BitWriter(const BitWriter &) = delete;
+  BitWriter &operator=(const BitWriter &) = delete;
 
   /// @brief - Push the value of a single bit to the output stream. It might be
   /// that nothing is actually written just yet in case we didn't accumulate
@@ -22,17 +43,68 @@ class BitWriter : public CoreObject
   /// @param b - the value to accumulate.
   void push(bool b) noexcept;
 
+  /// @brief - Push the `nbits` lowest bits of the value, starting with the most
+  /// significant of them. Other bits of the value are ignored.
+  /// @param value - the bits to push.
+  /// @param nbits - the number of bits to push, at most `64`.
+  void push(const std::uint64_t value, const unsigned nbits) noexcept;
+
   /// @brief - Flush the remaining content of the bits that might be pending for
-  /// writing.
+  /// writing. The last byte is completed with padding: in case no bits are
+  /// pending a whole byte of padding is written. All the bytes are then written
+  /// to the sink.
   /// @param pad - the value to use as padding.
   void flush(bool pad) noexcept;
 
+  /// @brief - The number of bits pushed since the creation of the writer,
+  /// including padding.
+  auto bitsWritten() const noexcept -> std::uint64_t;
+
   private:
-  ///@brief - Where bits will be saved.
-  std::ofstream &m_out;
+  /// @brief - Where the bytes are written.
+  enum class Sink
+  {
+    Stream,
+    Memory,
+    File
+  };
+
+  static constexpr auto ACCUMULATOR_BITS = 64u;
+
+  /// @brief - The size in bytes of the block gathering bytes before writing them
+  /// to the sink.
+  static constexpr auto BLOCK_SIZE = 65536u;
+
+  /// @brief - Move the full accumulator to the block.
+  void spill() noexcept;
 
-  /// @brief - The pending bits to save.
-  std::vector<bool> m_pending;
+  /// @brief - Move the complete bytes of the accumulator to the block, keeping
+  /// the remaining bits in the accumulator.
+  void spillBytes() noexcept;
+
+  /// @brief - Write the content of the block to the sink.
+  void drain() noexcept;
+
+  private:
+  Sink m_sink;
+
+  ///@brief - Where bits will be saved, depending on the sink.
+  std::ostream *m_out{nullptr};
+  std::vector<unsigned char> *m_memory{nullptr};
+  int m_fd{-1};
+
+  /// @brief - The pending bits, in the lowest `m_count` bits of the accumulator.
+  std::uint64_t m_bits{0u};
+  unsigned m_count{0u};
+
+  /// @brief - The bytes waiting to be written to the sink.
+  std::unique_ptr<unsigned char[]> m_block;
+  std::size_t m_used{0u};
+
+  /// @brief - The number of bytes written to the sink.
+  std::uint64_t m_written{0u};
 };
 
 } // namespace utils
+
+#include "BitWriter.hxx"
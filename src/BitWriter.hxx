@@ -0,0 +1,40 @@
+#pragma once
+
+#include "BitWriter.hh"
+
+namespace utils {
+
+inline void BitWriter::push(bool b) noexcept
+{
+  push(b ? 1u : 0u, 1u);
+}
+
+inline void BitWriter::push(const std::uint64_t value, const unsigned nbits) noexcept
+{
+  const auto room = ACCUMULATOR_BITS - m_count;
+  const auto bits = (nbits < ACCUMULATOR_BITS ? value & ((std::uint64_t{1u} << nbits) - 1u)
+                                              : value);
+
+  if (nbits < room)
+  {
+    m_bits  = (m_bits << nbits) | bits;
+    m_count += nbits;
+    return;
+  }
+
+  // Complete the accumulator with the most significant bits of the
+  // value and keep the others for later.
+  const auto rest = nbits - room;
+  m_bits          = (room < ACCUMULATOR_BITS ? m_bits << room : 0u) | (bits >> rest);
+  spill();
+
+  m_bits  = (rest > 0u ? bits & ((std::uint64_t{1u} << rest) - 1u) : 0u);
+  m_count = rest;
+}
+
+inline auto BitWriter::bitsWritten() const noexcept -> std::uint64_t
+{
+  return (m_written + m_used) * 8u + m_count;
+}
+
+} // namespace utils
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "TimeUtils.hh"
+#include <atomic>
+#include <optional>
+
+namespace utils {
+
+/// @brief - Allows a job to find out during its computation whether its result
+/// is still needed, so that long jobs can poll it and bail out early. A token is
+/// cancelled once the generation it watches moves away from the expected value,
+/// which is how a thread pool invalidates the jobs of a batch. A token can also
+/// carry a deadline after which the job is considered late.
+/// A default constructed token is never cancelled and has no deadline. Polling
+/// a token only costs a couple of relaxed atomic loads, and a clock read when it
+/// has a deadline.
+class CancellationToken
+{
+  public:
+  CancellationToken() noexcept = default;
+
+  /// @brief - Create a token watching the input generation.
+  /// @param generation - the generation to watch. It should outlive the token.
+  /// @param expected - the value of the generation for which the token is valid.
+  /// @param armed - in case it is provided, the token is only cancelled while
+  /// this flag is set. It should outlive the token.
+  /// @param deadline - the time by which the job should be done, if any.
+  CancellationToken(const std::atomic_uint &generation,
+                    const unsigned expected,
+                    const std::atomic_bool *armed           = nullptr,
+                    const std::optional<TimeStamp> &deadline = {}) noexcept;
+
+  /// @brief - Whether the result of the job is not needed anymore.
+  /// @return - `true` if the token is cancelled.
+  bool cancelled() const noexcept;
+
+  /// @brief - Whether the deadline of the token is reached.
+  /// @return - `true` if the token has a deadline which is past.
+  bool expired() const noexcept;
+
+  /// @brief - Whether the job should stop, either because it was cancelled or
+  /// because it is late. This is the method jobs are expected to poll.
+  /// @return - `true` if the job should stop.
+  bool stopRequested() const noexcept;
+
+  /// @brief - Whether a previous poll of the token returned `true`. Used by the
+  /// thread pool to find out which jobs stopped early.
+  /// @return - `true` if the stop of the job was requested at some point.
+  bool stopObserved() const noexcept;
+
+  /// @brief - The time by which the job should be done, if any.
+  auto deadline() const noexcept -> const std::optional<TimeStamp> &;
+
+  private:
+  const std::atomic_uint *m_generation{nullptr};
+  unsigned m_expected{0u};
+  const std::atomic_bool *m_armed{nullptr};
+  std::optional<TimeStamp> m_deadline{};
+
+  /// @brief - Tokens are used by a single thread: no need to protect this.
+  mutable bool m_observed{false};
+};
+
+} // namespace utils
+
+#include "CancellationToken.hxx"
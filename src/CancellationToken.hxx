@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CancellationToken.hh"
+
+namespace utils {
+
+inline CancellationToken::CancellationToken(const std::atomic_uint &generation,
+                                            const unsigned expected,
+                                            const std::atomic_bool *armed,
+                                            const std::optional<TimeStamp> &deadline) noexcept
+  : m_generation(&generation)
+  , m_expected(expected)
+  , m_armed(armed)
+  , m_deadline(deadline)
+{}
+
+inline bool CancellationToken::cancelled() const noexcept
+{
+  if (m_generation == nullptr || m_generation->load(std::memory_order_relaxed) == m_expected)
+  {
+    return false;
+  }
+
+  const auto out = (m_armed == nullptr || m_armed->load(std::memory_order_relaxed));
+  m_observed     = m_observed || out;
+
+  return out;
+}
+
+inline bool CancellationToken::expired() const noexcept
+{
+  if (!m_deadline)
+  {
+    return false;
+  }
+
+  const auto out = (now() >= *m_deadline);
+  m_observed     = m_observed || out;
+
+  return out;
+}
+
+inline bool CancellationToken::stopRequested() const noexcept
+{
+  return cancelled() || expired();
+}
+
+inline bool CancellationToken::stopObserved() const noexcept
+{
+  return m_observed;
+}
+
+inline auto CancellationToken::deadline() const noexcept -> const std::optional<TimeStamp> &
+{
+  return m_deadline;
+}
+
+} // namespace utils
@@ -35,6 +35,11 @@ void CoreObject::addModule(const std::string &module)
   m_logger.addModule(module);
 }
 
+bool CoreObject::isLogEnabled(const log::Severity severity) const noexcept
+{
+  return m_logger.isEnabled(severity);
+}
+
 void CoreObject::verbose(const std::string &message) const
 {
   m_logger.verbose(message);
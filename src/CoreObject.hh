@@ -29,6 +29,12 @@ class CoreObject
   /// @param module - the new module to register.
   void addModule(const std::string &module);
 
+  /// @brief - Whether messages with the input severity are displayed. Used to
+  /// avoid building messages which would be discarded anyway.
+  /// @param severity - the severity of the message.
+  /// @return - `true` if messages with this severity are displayed.
+  bool isLogEnabled(const log::Severity severity) const noexcept;
+
   void verbose(const std::string &message) const;
   void debug(const std::string &message) const;
   void info(const std::string &message) const;
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+/// @brief - The type of the arguments received by a delegate: references are
+/// forwarded as is and values are passed by constant reference, so that calling
+/// several delegates with the same arguments doesn't copy them for each call.
+template<typename T>
+using SlotArgument = std::conditional_t<std::is_reference<T>::value, T, const T &>;
+
+/// @brief - A copyable type-erased callable taking the input arguments and not
+/// returning anything, used as the slots of a signal. Compared to a function
+/// it stores small callables directly in the object and calls them through a
+/// single indirection. Member and free functions known at compile time can be
+/// bound with `bind`, in which case the call to the function can be inlined in
+/// the stub generated for it. Callables bigger than the inline storage are
+/// allocated on the heap.
+template<typename... Args>
+class Delegate
+{
+  public:
+  /// @brief - The size in bytes available to store a callable without any
+  /// memory allocation. Large enough for a pointer to a member function and
+  /// the instance to call it on.
+  static constexpr std::size_t INLINE_SIZE = 32u;
+
+  Delegate() noexcept = default;
+
+  /// @brief - Create a new delegate wrapping the input callable.
+  /// @param func - the callable to wrap.
+  template<typename F,
+           std::enable_if_t<!std::is_same<std::decay_t<F>, Delegate>::value, bool> = true>
+  Delegate(F &&func);
+
+  /// @brief - Create a delegate calling the input member function on the input
+  /// instance. The instance should outlive the delegate.
+  /// @param instance - the instance to call the method on.
+  /// @return - the created delegate.
+  template<auto Method, typename T>
+  static auto bind(T *instance) noexcept -> Delegate;
+
+  /// @brief - Create a delegate calling the input free function.
+  /// @return - the created delegate.
+  template<auto Function>
+  static auto bind() noexcept -> Delegate;
+
+  Delegate(const Delegate &rhs);
+  Delegate &operator=(const Delegate &rhs);
+
+  Delegate(Delegate &&rhs) noexcept;
+  Delegate &operator=(Delegate &&rhs) noexcept;
+
+  ~Delegate();
+
+  /// @brief - Whether this delegate wraps a callable.
+  /// @return - `true` if a callable is attached to this delegate.
+  explicit operator bool() const noexcept;
+
+  /// @brief - Invoke the wrapped callable. The delegate should not be empty.
+  /// Just like for a `std::function` the callable is not required to be const.
+  /// @param args - the arguments to forward to the callable.
+  void operator()(SlotArgument<Args>... args) const;
+
+  /// @brief - Whether a callable of type `F` can be stored without allocating
+  /// memory.
+  template<typename F>
+  static constexpr bool fitsInline() noexcept;
+
+  private:
+  using Invoke = void (*)(const void *storage, SlotArgument<Args>... args);
+
+  /// @brief - The operations allowing to copy and destroy the stored callable
+  /// without knowing its type. Callables which are trivially copyable and
+  /// destructible don't need any and are copied bytewise.
+  struct Operations
+  {
+    void (*copy)(void *to, const void *from);
+    void (*move)(void *to, void *from) noexcept;
+    void (*destroy)(void *storage) noexcept;
+  };
+
+  template<typename F>
+  static const Operations *inlineOperations() noexcept;
+
+  template<typename F>
+  static const Operations *heapOperations() noexcept;
+
+  void copyFrom(const Delegate &rhs);
+  void moveFrom(Delegate &rhs) noexcept;
+  void reset() noexcept;
+
+  private:
+  alignas(std::max_align_t) unsigned char m_storage[INLINE_SIZE]{};
+  Invoke m_invoke{nullptr};
+  const Operations *m_operations{nullptr};
+};
+
+} // namespace utils
+
+#include "Delegate.hxx"
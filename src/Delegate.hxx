@@ -0,0 +1,210 @@
+#pragma once
+
+#include "Delegate.hh"
+#include <cstring>
+#include <functional>
+#include <new>
+
+namespace utils {
+
+template<typename... Args>
+template<typename F>
+inline constexpr bool Delegate<Args...>::fitsInline() noexcept
+{
+  return sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t)
+         && std::is_nothrow_move_constructible<F>::value;
+}
+
+template<typename... Args>
+template<typename F,
+         std::enable_if_t<!std::is_same<std::decay_t<F>, Delegate<Args...>>::value, bool>>
+inline Delegate<Args...>::Delegate(F &&func)
+{
+  using Callable = std::decay_t<F>;
+  static_assert(std::is_invocable<Callable &, SlotArgument<Args>...>::value,
+                "The callable can't be called with the arguments of the delegate");
+
+  if constexpr (fitsInline<Callable>())
+  {
+    new (m_storage) Callable(std::forward<F>(func));
+    m_invoke = [](const void *storage, SlotArgument<Args>... args) {
+      auto *callable = std::launder(static_cast<Callable *>(const_cast<void *>(storage)));
+      (*callable)(args...);
+    };
+    m_operations = inlineOperations<Callable>();
+  }
+  else
+  {
+    *reinterpret_cast<Callable **>(m_storage) = new Callable(std::forward<F>(func));
+    m_invoke = [](const void *storage, SlotArgument<Args>... args) {
+      (**static_cast<Callable *const *>(storage))(args...);
+    };
+    m_operations = heapOperations<Callable>();
+  }
+}
+
+template<typename... Args>
+template<auto Method, typename T>
+inline auto Delegate<Args...>::bind(T *instance) noexcept -> Delegate
+{
+  Delegate out;
+
+  *reinterpret_cast<T **>(out.m_storage) = instance;
+  out.m_invoke = [](const void *storage, SlotArgument<Args>... args) {
+    std::invoke(Method, *static_cast<T *const *>(storage), args...);
+  };
+
+  return out;
+}
+
+template<typename... Args>
+template<auto Function>
+inline auto Delegate<Args...>::bind() noexcept -> Delegate
+{
+  Delegate out;
+
+  out.m_invoke = [](const void * /*storage*/, SlotArgument<Args>... args) {
+    std::invoke(Function, args...);
+  };
+
+  return out;
+}
+
+template<typename... Args>
+inline Delegate<Args...>::Delegate(const Delegate &rhs)
+{
+  copyFrom(rhs);
+}
+
+template<typename... Args>
+inline Delegate<Args...> &Delegate<Args...>::operator=(const Delegate &rhs)
+{
+  if (this != &rhs)
+  {
+    reset();
+    copyFrom(rhs);
+  }
+
+  return *this;
+}
+
+template<typename... Args>
+inline Delegate<Args...>::Delegate(Delegate &&rhs) noexcept
+{
+  moveFrom(rhs);
+}
+
+template<typename... Args>
+inline Delegate<Args...> &Delegate<Args...>::operator=(Delegate &&rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    reset();
+    moveFrom(rhs);
+  }
+
+  return *this;
+}
+
+template<typename... Args>
+inline Delegate<Args...>::~Delegate()
+{
+  reset();
+}
+
+template<typename... Args>
+inline Delegate<Args...>::operator bool() const noexcept
+{
+  return m_invoke != nullptr;
+}
+
+template<typename... Args>
+inline void Delegate<Args...>::operator()(SlotArgument<Args>... args) const
+{
+  m_invoke(m_storage, args...);
+}
+
+template<typename... Args>
+template<typename F>
+inline const typename Delegate<Args...>::Operations *Delegate<Args...>::inlineOperations() noexcept
+{
+  if constexpr (std::is_trivially_copyable<F>::value && std::is_trivially_destructible<F>::value)
+  {
+    return nullptr;
+  }
+  else
+  {
+    static constexpr Operations operations{
+      [](void *to, const void *from) { new (to) F(*std::launder(static_cast<const F *>(from))); },
+      [](void *to, void *from) noexcept {
+        auto *src = std::launder(static_cast<F *>(from));
+        new (to) F(std::move(*src));
+        src->~F();
+      },
+      [](void *storage) noexcept { std::launder(static_cast<F *>(storage))->~F(); }};
+
+    return &operations;
+  }
+}
+
+template<typename... Args>
+template<typename F>
+inline const typename Delegate<Args...>::Operations *Delegate<Args...>::heapOperations() noexcept
+{
+  static constexpr Operations operations{
+    [](void *to, const void *from) {
+      *static_cast<F **>(to) = new F(**static_cast<F *const *>(from));
+    },
+    [](void *to, void *from) noexcept {
+      *static_cast<F **>(to) = std::exchange(*static_cast<F **>(from), nullptr);
+    },
+    [](void *storage) noexcept { delete *static_cast<F **>(storage); }};
+
+  return &operations;
+}
+
+template<typename... Args>
+inline void Delegate<Args...>::copyFrom(const Delegate &rhs)
+{
+  if (rhs.m_operations != nullptr)
+  {
+    rhs.m_operations->copy(m_storage, rhs.m_storage);
+  }
+  else
+  {
+    std::memcpy(m_storage, rhs.m_storage, INLINE_SIZE);
+  }
+
+  m_invoke     = rhs.m_invoke;
+  m_operations = rhs.m_operations;
+}
+
+template<typename... Args>
+inline void Delegate<Args...>::moveFrom(Delegate &rhs) noexcept
+{
+  if (rhs.m_operations != nullptr)
+  {
+    rhs.m_operations->move(m_storage, rhs.m_storage);
+  }
+  else
+  {
+    std::memcpy(m_storage, rhs.m_storage, INLINE_SIZE);
+  }
+
+  m_invoke     = std::exchange(rhs.m_invoke, nullptr);
+  m_operations = std::exchange(rhs.m_operations, nullptr);
+}
+
+template<typename... Args>
+inline void Delegate<Args...>::reset() noexcept
+{
+  if (m_operations != nullptr)
+  {
+    m_operations->destroy(m_storage);
+  }
+
+  m_invoke     = nullptr;
+  m_operations = nullptr;
+}
+
+} // namespace utils
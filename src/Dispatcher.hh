@@ -0,0 +1,20 @@
+#pragma once
+
+#include "SmallTask.hh"
+
+namespace utils {
+
+/// @brief - Interface of the objects able to run callables later, possibly in
+/// another thread. Signals use it to deliver events to queued slots.
+class Dispatcher
+{
+  public:
+  virtual ~Dispatcher() = default;
+
+  /// @brief - Schedule the execution of the input callable. This method can be
+  /// called from any thread.
+  /// @param task - the callable to execute.
+  virtual void dispatch(SmallTask &&task) = 0;
+};
+
+} // namespace utils
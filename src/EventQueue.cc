@@ -0,0 +1,42 @@
+#include "EventQueue.hh"
+#include "SafetyNet.hh"
+
+namespace utils {
+
+void EventQueue::dispatch(SmallTask &&task)
+{
+  const std::lock_guard guard(m_locker);
+  m_pending.push_back(std::move(task));
+}
+
+auto EventQueue::process() -> std::size_t
+{
+  {
+    const std::lock_guard guard(m_locker);
+    m_processing.swap(m_pending);
+  }
+
+  for (auto &task : m_processing)
+  {
+    launchProtected([&task]() { task(); }, "process", "queue", "utils");
+  }
+
+  const auto count = m_processing.size();
+  m_processing.clear();
+
+  return count;
+}
+
+auto EventQueue::size() const -> std::size_t
+{
+  const std::lock_guard guard(m_locker);
+  return m_pending.size();
+}
+
+bool EventQueue::empty() const
+{
+  const std::lock_guard guard(m_locker);
+  return m_pending.empty();
+}
+
+} // namespace utils
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Dispatcher.hh"
+#include <mutex>
+#include <vector>
+
+namespace utils {
+
+/// @brief - A queue of callables which are executed when the owner of the queue
+/// processes it, typically from the loop of a thread dedicated to some other
+/// task such as a user interface. Callables can be dispatched from any thread.
+class EventQueue : public Dispatcher
+{
+  public:
+  EventQueue() = default;
+
+  EventQueue(const EventQueue &) = delete;
+  EventQueue &operator=(const EventQueue &) = delete;
+
+  void dispatch(SmallTask &&task) override;
+
+  /// @brief - Execute in the calling thread the callables which were dispatched
+  /// before the call. Callables dispatched while processing are executed by the
+  /// next call. Exceptions raised by the callables are caught and logged. The
+  /// queue should only be processed by a single thread at a time.
+  /// @return - the number of callables executed.
+  auto process() -> std::size_t;
+
+  /// @brief - The number of callables waiting to be processed.
+  auto size() const -> std::size_t;
+
+  bool empty() const;
+
+  private:
+  /// @brief - Protects the pending callables.
+  mutable std::mutex m_locker{};
+
+  /// @brief - The callables waiting to be processed.
+  std::vector<SmallTask> m_pending{};
+
+  /// @brief - The callables being processed, kept as an attribute to reuse its
+  /// memory. Only accessed by the thread processing the queue.
+  std::vector<SmallTask> m_processing{};
+};
+
+} // namespace utils
@@ -0,0 +1,91 @@
+#include "FrameAllocator.hh"
+#include <array>
+#include <new>
+#include <utility>
+
+namespace utils {
+namespace {
+/// @brief - The sizes of frames handled by the free lists are multiples of this
+/// value, up to `SIZE_CLASSES_COUNT` times this value.
+constexpr auto SIZE_CLASS_GRANULARITY = std::size_t{64u};
+constexpr auto SIZE_CLASSES_COUNT     = std::size_t{16u};
+
+/// @brief - The maximum number of frames kept in each free list. Frames released
+/// when the list is full are given back to the global allocator.
+constexpr auto MAXIMUM_CACHED_FRAMES = 64u;
+
+struct FreeFrame
+{
+  FreeFrame *next{nullptr};
+};
+
+/// @brief - The free lists of a thread. The frames are released when the thread
+/// terminates.
+struct FrameCache
+{
+  std::array<FreeFrame *, SIZE_CLASSES_COUNT> heads{};
+  std::array<unsigned, SIZE_CLASSES_COUNT> counts{};
+
+  /// @brief - Set once the cache is destroyed: frames released afterwards, for
+  /// example by destructors of other thread-local objects, bypass the cache.
+  bool closed{false};
+
+  ~FrameCache()
+  {
+    for (auto &head : heads)
+    {
+      while (head != nullptr)
+      {
+        ::operator delete(std::exchange(head, head->next));
+      }
+    }
+
+    closed = true;
+  }
+};
+
+thread_local FrameCache cache{};
+
+auto sizeClassOf(const std::size_t size) noexcept -> std::size_t
+{
+  return (size + SIZE_CLASS_GRANULARITY - 1u) / SIZE_CLASS_GRANULARITY - 1u;
+}
+} // namespace
+
+auto FrameAllocator::allocate(const std::size_t size) -> void *
+{
+  const auto sizeClass = sizeClassOf(size);
+  if (sizeClass >= SIZE_CLASSES_COUNT)
+  {
+    return ::operator new(size);
+  }
+
+  if (auto *frame = cache.heads[sizeClass]; frame != nullptr)
+  {
+    cache.heads[sizeClass] = frame->next;
+    --cache.counts[sizeClass];
+    return frame;
+  }
+
+  // Allocate the whole size class so that the frame can be reused for any
+  // size falling in this class, even when it is freed by another thread
+  // whose cache is still open.
+  return ::operator new((sizeClass + 1u) * SIZE_CLASS_GRANULARITY);
+}
+
+void FrameAllocator::deallocate(void *frame, const std::size_t size) noexcept
+{
+  const auto sizeClass = sizeClassOf(size);
+  if (sizeClass >= SIZE_CLASSES_COUNT || cache.closed
+      || cache.counts[sizeClass] >= MAXIMUM_CACHED_FRAMES)
+  {
+    ::operator delete(frame);
+    return;
+  }
+
+  auto *free             = ::new (frame) FreeFrame{cache.heads[sizeClass]};
+  cache.heads[sizeClass] = free;
+  ++cache.counts[sizeClass];
+}
+
+} // namespace utils
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+namespace utils {
+
+/// @brief - Allocates the frames of the coroutines. Frames are grouped in a few
+/// size classes and released frames are kept in a free list local to the thread
+/// releasing them, so that creating a coroutine usually doesn't hit the global
+/// allocator. Frames larger than the biggest size class are directly allocated
+/// with `operator new`.
+class FrameAllocator
+{
+  public:
+  /// @brief - Allocate a frame of at least the input size.
+  /// @param size - the size of the frame in bytes.
+  /// @return - the memory for the frame.
+  static auto allocate(const std::size_t size) -> void *;
+
+  /// @brief - Release a frame previously obtained through `allocate`.
+  /// @param frame - the frame to release.
+  /// @param size - the size which was requested when allocating the frame.
+  static void deallocate(void *frame, const std::size_t size) noexcept;
+};
+
+} // namespace utils
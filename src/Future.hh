@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <variant>
+
+namespace utils {
+
+/// @brief - The state shared between a promise and the future(s) attached to
+/// it. It holds either the value produced by the computation, the exception
+/// it raised or the fact that it was cancelled before producing anything.
+template<typename T>
+class SharedState
+{
+  static_assert(!std::is_reference<T>::value, "Results must be stored by value");
+
+  public:
+  /// @brief - Convenience define to refer to the stored value. Allows to use the
+  /// same storage for computations returning `void`.
+  using Value = std::conditional_t<std::is_void<T>::value, std::monostate, T>;
+
+  SharedState() = default;
+
+  /// @brief - Store the value produced by the computation and wake up anyone
+  /// waiting for it.
+  /// @param args - the arguments used to construct the value.
+  template<typename... Args>
+  void setValue(Args &&...args);
+
+  /// @brief - Store the exception raised by the computation and wake up anyone
+  /// waiting for it.
+  /// @param exception - the exception to store.
+  void setException(std::exception_ptr exception) noexcept;
+
+  /// @brief - Mark the computation as cancelled and wake up anyone waiting for
+  /// it.
+  void cancel() noexcept;
+
+  /// @brief - Whether the computation is done, successfully or not.
+  /// @return - `true` if the computation is finished.
+  bool ready() const noexcept;
+
+  /// @brief - Block until the computation is done.
+  void wait() const noexcept;
+
+  /// @brief - Wait for the computation to be done and extract its result. In
+  /// case the computation failed the exception is rethrown and in case it was
+  /// cancelled an exception is raised.
+  /// @return - the result of the computation.
+  auto take() -> T;
+
+  private:
+  /// @brief - The possible states of the computation.
+  enum class Status { Pending, Value, Exception, Cancelled };
+
+  /// @brief - Update the status of the computation and notify waiters.
+  /// @param status - the new status.
+  void publish(const Status status) noexcept;
+
+  private:
+  std::atomic<Status> m_status{Status::Pending};
+  std::optional<Value> m_value{};
+  std::exception_ptr m_exception{};
+};
+
+/// @brief - Allows to retrieve the result of a computation executed by another
+/// thread, typically submitted to a `ThreadPool`.
+template<typename T>
+class Future
+{
+  public:
+  /// @brief - Create an invalid future, not attached to any computation.
+  Future() = default;
+
+  /// @brief - Create a future attached to the input state.
+  /// @param state - the state shared with the promise producing the result.
+  explicit Future(std::shared_ptr<SharedState<T>> state) noexcept;
+
+  /// @brief - Whether this future is attached to a computation. A future is
+  /// no longer valid after its result was retrieved through `get`.
+  /// @return - `true` if the future is valid.
+  bool valid() const noexcept;
+
+  /// @brief - Whether the result of the computation is available.
+  /// @return - `true` if calling `get` would not block.
+  bool ready() const noexcept;
+
+  /// @brief - Block until the result of the computation is available.
+  void wait() const noexcept;
+
+  /// @brief - Wait for the result of the computation and return it. In case the
+  /// computation raised an exception it is rethrown here. In case it was dropped
+  /// before being executed (for example by `ThreadPool::cancelJobs`) an exception
+  /// is raised. The future becomes invalid after this call.
+  /// @return - the result of the computation.
+  auto get() -> T;
+
+  private:
+  std::shared_ptr<SharedState<T>> m_state{};
+};
+
+/// @brief - The producing side of a `Future`. The promise is expected to be
+/// fulfilled exactly once: if it is destroyed before that the future reports
+/// that the computation was cancelled.
+template<typename T>
+class Promise
+{
+  public:
+  Promise();
+
+  Promise(Promise &&rhs) noexcept = default;
+  Promise &operator=(Promise &&rhs) noexcept;
+
+  Promise(const Promise &) = delete;
+  Promise &operator=(const Promise &) = delete;
+
+  ~Promise();
+
+  /// @brief - Create a future attached to this promise.
+  /// @return - the future which will receive the result.
+  auto getFuture() const -> Future<T>;
+
+  /// @brief - Fulfill the promise with a value.
+  /// @param args - the arguments used to construct the value.
+  template<typename... Args>
+  void setValue(Args &&...args);
+
+  /// @brief - Fulfill the promise with an exception.
+  /// @param exception - the exception to transmit to the future.
+  void setException(std::exception_ptr exception) noexcept;
+
+  private:
+  /// @brief - Cancel the attached state if it was not fulfilled yet.
+  void abandon() noexcept;
+
+  private:
+  std::shared_ptr<SharedState<T>> m_state{};
+};
+
+} // namespace utils
+
+#include "Future.hxx"
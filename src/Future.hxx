@@ -0,0 +1,167 @@
+#pragma once
+
+#include "CoreException.hh"
+#include "Future.hh"
+
+namespace utils {
+
+template<typename T>
+template<typename... Args>
+inline void SharedState<T>::setValue(Args &&...args)
+{
+  m_value.emplace(std::forward<Args>(args)...);
+  publish(Status::Value);
+}
+
+template<typename T>
+inline void SharedState<T>::setException(std::exception_ptr exception) noexcept
+{
+  m_exception = exception;
+  publish(Status::Exception);
+}
+
+template<typename T>
+inline void SharedState<T>::cancel() noexcept
+{
+  publish(Status::Cancelled);
+}
+
+template<typename T>
+inline bool SharedState<T>::ready() const noexcept
+{
+  return m_status.load(std::memory_order_acquire) != Status::Pending;
+}
+
+template<typename T>
+inline void SharedState<T>::wait() const noexcept
+{
+  m_status.wait(Status::Pending, std::memory_order_acquire);
+}
+
+template<typename T>
+inline auto SharedState<T>::take() -> T
+{
+  wait();
+
+  switch (m_status.load(std::memory_order_acquire))
+  {
+    case Status::Value:
+      if constexpr (!std::is_void<T>::value)
+      {
+        return std::move(*m_value);
+      }
+      else
+      {
+        return;
+      }
+    case Status::Exception:
+      std::rethrow_exception(m_exception);
+    case Status::Cancelled:
+    default:
+      throw CoreException("Failed to get result of computation",
+                          "future",
+                          "utils",
+                          std::string("Computation was cancelled"));
+  }
+}
+
+template<typename T>
+inline void SharedState<T>::publish(const Status status) noexcept
+{
+  m_status.store(status, std::memory_order_release);
+  m_status.notify_all();
+}
+
+template<typename T>
+inline Future<T>::Future(std::shared_ptr<SharedState<T>> state) noexcept
+  : m_state(std::move(state))
+{}
+
+template<typename T>
+inline bool Future<T>::valid() const noexcept
+{
+  return m_state != nullptr;
+}
+
+template<typename T>
+inline bool Future<T>::ready() const noexcept
+{
+  return m_state != nullptr && m_state->ready();
+}
+
+template<typename T>
+inline void Future<T>::wait() const noexcept
+{
+  if (m_state != nullptr)
+  {
+    m_state->wait();
+  }
+}
+
+template<typename T>
+inline auto Future<T>::get() -> T
+{
+  if (m_state == nullptr)
+  {
+    throw CoreException("Failed to get result of computation",
+                        "future",
+                        "utils",
+                        std::string("Future is not valid"));
+  }
+
+  auto state = std::move(m_state);
+  return state->take();
+}
+
+template<typename T>
+inline Promise<T>::Promise()
+  : m_state(std::make_shared<SharedState<T>>())
+{}
+
+template<typename T>
+inline Promise<T> &Promise<T>::operator=(Promise &&rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    abandon();
+    m_state = std::move(rhs.m_state);
+  }
+
+  return *this;
+}
+
+template<typename T>
+inline Promise<T>::~Promise()
+{
+  abandon();
+}
+
+template<typename T>
+inline auto Promise<T>::getFuture() const -> Future<T>
+{
+  return Future<T>(m_state);
+}
+
+template<typename T>
+template<typename... Args>
+inline void Promise<T>::setValue(Args &&...args)
+{
+  m_state->setValue(std::forward<Args>(args)...);
+}
+
+template<typename T>
+inline void Promise<T>::setException(std::exception_ptr exception) noexcept
+{
+  m_state->setException(exception);
+}
+
+template<typename T>
+inline void Promise<T>::abandon() noexcept
+{
+  if (m_state != nullptr && !m_state->ready())
+  {
+    m_state->cancel();
+  }
+}
+
+} // namespace utils
@@ -0,0 +1,228 @@
+#include "HuffmanCoder.hh"
+#include "CoreException.hh"
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace utils {
+namespace {
+/// @brief - The number of bits used to save the size of the alphabet and the
+/// length of a code.
+constexpr auto SIZE_BITS   = 16u;
+constexpr auto LENGTH_BITS = 4u;
+
+auto error(const std::string &message, const std::string &cause) -> CoreException
+{
+  return CoreException(message, "huffman", "binary", cause);
+}
+
+/// @brief - Compute the depth of each leaf of the Huffman tree built from the
+/// input frequencies. Only symbols with a positive frequency get a depth.
+auto computeDepths(const std::vector<std::uint64_t> &frequencies) -> std::vector<unsigned>
+{
+  // Leaves come first, then internal nodes in the order they're
+  // created: a node is always created after its children.
+  using Node = std::pair<std::uint64_t, unsigned>;
+  std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+  std::vector<unsigned> symbols;
+
+  for (unsigned symbol = 0u; symbol < frequencies.size(); ++symbol)
+  {
+    if (frequencies[symbol] > 0u)
+    {
+      queue.emplace(frequencies[symbol], static_cast<unsigned>(symbols.size()));
+      symbols.push_back(symbol);
+    }
+  }
+
+  std::vector<unsigned> parents(symbols.size(), 0u);
+  while (queue.size() > 1u)
+  {
+    const auto first = queue.top();
+    queue.pop();
+    const auto second = queue.top();
+    queue.pop();
+
+    const auto node        = static_cast<unsigned>(parents.size());
+    parents[first.second]  = node;
+    parents[second.second] = node;
+    parents.push_back(node);
+    queue.emplace(first.first + second.first, node);
+  }
+
+  // The root is the last node: each node is one level below its parent.
+  std::vector<unsigned> nodes(parents.size(), 0u);
+  for (auto node = static_cast<int>(parents.size()) - 2; node >= 0; --node)
+  {
+    nodes[node] = nodes[parents[node]] + 1u;
+  }
+
+  std::vector<unsigned> depths(frequencies.size(), 0u);
+  for (unsigned leaf = 0u; leaf < symbols.size(); ++leaf)
+  {
+    depths[symbols[leaf]] = std::max(nodes[leaf], 1u);
+  }
+
+  return depths;
+}
+} // namespace
+
+HuffmanCoder::HuffmanCoder(const std::vector<std::uint64_t> &frequencies)
+{
+  if (frequencies.size() > MAX_ALPHABET_SIZE)
+  {
+    throw error("Failed to create Huffman code",
+                "Alphabet has " + std::to_string(frequencies.size()) + " symbols");
+  }
+
+  const auto used = std::count_if(frequencies.begin(), frequencies.end(), [](const auto f) {
+    return f > 0u;
+  });
+  if (used == 0 || used > (1 << MAX_CODE_LENGTH))
+  {
+    throw error("Failed to create Huffman code",
+                "Invalid number of used symbols " + std::to_string(used));
+  }
+
+  // Flatten the distribution until the codes are short enough: at
+  // worst all the frequencies become `1`, which is a balanced tree.
+  auto scaled = frequencies;
+  auto depths = computeDepths(scaled);
+  while (*std::max_element(depths.begin(), depths.end()) > MAX_CODE_LENGTH)
+  {
+    for (auto &frequency : scaled)
+    {
+      frequency = (frequency + 1u) / 2u;
+    }
+
+    depths = computeDepths(scaled);
+  }
+
+  m_lengths.assign(depths.begin(), depths.end());
+  build();
+}
+
+auto HuffmanCoder::fromLengths(const std::vector<unsigned char> &lengths) -> HuffmanCoder
+{
+  if (lengths.size() > MAX_ALPHABET_SIZE)
+  {
+    throw error("Failed to create Huffman code",
+                "Alphabet has " + std::to_string(lengths.size()) + " symbols");
+  }
+
+  HuffmanCoder out;
+  out.m_lengths = lengths;
+  out.build();
+
+  return out;
+}
+
+void HuffmanCoder::save(BitWriter &out) const noexcept
+{
+  out.push(m_lengths.size() - 1u, SIZE_BITS);
+  for (const auto length : m_lengths)
+  {
+    out.push(length, LENGTH_BITS);
+  }
+}
+
+auto HuffmanCoder::load(BitReader &in) -> HuffmanCoder
+{
+  std::vector<unsigned char> lengths(in.read(SIZE_BITS) + 1u);
+  for (auto &length : lengths)
+  {
+    length = static_cast<unsigned char>(in.read(LENGTH_BITS));
+  }
+
+  return fromLengths(lengths);
+}
+
+void HuffmanCoder::build()
+{
+  std::array<unsigned, MAX_CODE_LENGTH + 1u> counts{};
+  for (const auto length : m_lengths)
+  {
+    if (length > MAX_CODE_LENGTH)
+    {
+      throw error("Failed to create Huffman code",
+                  "Code length " + std::to_string(length) + " is too long");
+    }
+
+    ++counts[length];
+  }
+  counts[0] = 0u;
+
+  // The codes should fit in the code space, which might not be
+  // entirely used: this happens when there's a single symbol.
+  auto used = 0u;
+  auto code = 0u;
+  for (unsigned length = 1u; length <= MAX_CODE_LENGTH; ++length)
+  {
+    used += counts[length] << (MAX_CODE_LENGTH - length);
+
+    m_firstCode[length] = code;
+    m_offset[length]    = (length > 1u ? m_offset[length - 1u] + counts[length - 1u] : 0u);
+    m_limit[length]     = (code + counts[length]) << (MAX_CODE_LENGTH - length);
+
+    code = (code + counts[length]) << 1u;
+  }
+
+  if (used == 0u || used > (1u << MAX_CODE_LENGTH))
+  {
+    throw error("Failed to create Huffman code", "Lengths don't describe a prefix code");
+  }
+
+  // Codes of the same length are attributed in the order of the
+  // symbols.
+  m_codes.assign(m_lengths.size(), 0u);
+  m_sorted.assign(m_offset[MAX_CODE_LENGTH] + counts[MAX_CODE_LENGTH], 0u);
+  auto next = m_offset;
+  for (unsigned symbol = 0u; symbol < m_lengths.size(); ++symbol)
+  {
+    const auto length = m_lengths[symbol];
+    if (length == 0u)
+    {
+      continue;
+    }
+
+    const auto rank = next[length]++;
+    m_sorted[rank]  = static_cast<std::uint16_t>(symbol);
+    m_codes[symbol] = static_cast<std::uint16_t>(m_firstCode[length] + rank - m_offset[length]);
+  }
+
+  // Each short code fills all the entries starting with it.
+  m_lookup.assign(1u << LOOKUP_BITS, Entry{0u, 0u});
+  for (unsigned symbol = 0u; symbol < m_lengths.size(); ++symbol)
+  {
+    const auto length = m_lengths[symbol];
+    if (length == 0u || length > LOOKUP_BITS)
+    {
+      continue;
+    }
+
+    const auto first = m_codes[symbol] << (LOOKUP_BITS - length);
+    const auto count = 1u << (LOOKUP_BITS - length);
+    std::fill_n(m_lookup.begin() + first,
+                count,
+                Entry{static_cast<std::uint16_t>(symbol), static_cast<std::uint16_t>(length)});
+  }
+}
+
+auto HuffmanCoder::decodeLong(BitReader &in, const unsigned bits) const noexcept -> unsigned
+{
+  for (auto length = LOOKUP_BITS + 1u; length <= MAX_CODE_LENGTH; ++length)
+  {
+    if (bits < m_limit[length])
+    {
+      const auto code = bits >> (MAX_CODE_LENGTH - length);
+      in.read(length);
+
+      return m_sorted[m_offset[length] + code - m_firstCode[length]];
+    }
+  }
+
+  in.read(MAX_CODE_LENGTH);
+  return size();
+}
+
+} // namespace utils
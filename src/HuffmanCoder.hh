@@ -0,0 +1,112 @@
+#pragma once
+
+#include "BitReader.hh"
+#include "BitWriter.hh"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace utils {
+
+/// @brief - A canonical Huffman code over the symbols `[0; size)`. Codes are
+/// limited to `MAX_CODE_LENGTH` bits and are entirely described by the length
+/// of the code of each symbol, which is all that `save` writes. Decoding looks
+/// up the next `LOOKUP_BITS` bits in a table giving the symbol and the length
+/// of its code in one go: only the longer codes are searched from the first
+/// code of each length.
+class HuffmanCoder
+{
+  public:
+  /// @brief - The maximum length of a code in bits.
+  static constexpr auto MAX_CODE_LENGTH = 15u;
+
+  /// @brief - The number of bits decoded with a single lookup.
+  static constexpr auto LOOKUP_BITS = 11u;
+
+  /// @brief - The maximum number of symbols in the alphabet.
+  static constexpr auto MAX_ALPHABET_SIZE = 65536u;
+
+  /// @brief - Build the code giving the shortest output for a message where
+  /// each symbol appears with the input frequency. Symbols with a frequency
+  /// of `0` don't have a code. An error is raised in case no symbol has a
+  /// positive frequency or if the alphabet is too large.
+  /// @param frequencies - the frequency of each symbol.
+  explicit HuffmanCoder(const std::vector<std::uint64_t> &frequencies);
+
+  /// @brief - Build the code from the length of the code of each symbol. An
+  /// error is raised in case the lengths don't describe a valid code.
+  /// @param lengths - the length of the code of each symbol, `0` for symbols
+  /// without a code.
+  /// @return - the created code.
+  static auto fromLengths(const std::vector<unsigned char> &lengths) -> HuffmanCoder;
+
+  /// @brief - The number of symbols in the alphabet.
+  auto size() const noexcept -> unsigned;
+
+  /// @brief - The length of the code of a symbol, `0` if it doesn't have one.
+  auto length(const unsigned symbol) const noexcept -> unsigned;
+
+  /// @brief - Write the code of a symbol. The symbol should have a code.
+  /// @param out - the writer to write the code to.
+  /// @param symbol - the symbol to encode.
+  void encode(BitWriter &out, const unsigned symbol) const noexcept;
+
+  /// @brief - Read the next code and return the matching symbol. In case the
+  /// bits don't match any code, `MAX_CODE_LENGTH` bits are consumed and `size()`
+  /// is returned.
+  /// @param in - the reader to read the code from.
+  /// @return - the decoded symbol.
+  auto decode(BitReader &in) const noexcept -> unsigned;
+
+  /// @brief - Write the description of the code, so that it can be created
+  /// again with `load`.
+  /// @param out - the writer to write the description to.
+  void save(BitWriter &out) const noexcept;
+
+  /// @brief - Read the description of a code written by `save`. An error is
+  /// raised in case it doesn't describe a valid code.
+  /// @param in - the reader to read the description from.
+  /// @return - the created code.
+  static auto load(BitReader &in) -> HuffmanCoder;
+
+  private:
+  HuffmanCoder() = default;
+
+  /// @brief - Compute the codes and the decoding tables from the lengths of
+  /// the codes.
+  void build();
+
+  /// @brief - Decode a code longer than `LOOKUP_BITS`.
+  /// @param in - the reader to read the code from.
+  /// @param bits - the next `MAX_CODE_LENGTH` bits of the reader.
+  auto decodeLong(BitReader &in, const unsigned bits) const noexcept -> unsigned;
+
+  private:
+  /// @brief - An entry of the decoding table. A length of `0` indicates that
+  /// the code is longer than `LOOKUP_BITS`.
+  struct Entry
+  {
+    std::uint16_t symbol;
+    std::uint16_t length;
+  };
+
+  std::vector<unsigned char> m_lengths{};
+  std::vector<std::uint16_t> m_codes{};
+
+  /// @brief - The symbol matching each value of the next `LOOKUP_BITS` bits.
+  std::vector<Entry> m_lookup{};
+
+  /// @brief - For each length, the first code of this length, the end of the
+  /// codes of this length aligned on `MAX_CODE_LENGTH` bits and the index of
+  /// the first symbol of this length in `m_sorted`.
+  std::array<unsigned, MAX_CODE_LENGTH + 1u> m_firstCode{};
+  std::array<unsigned, MAX_CODE_LENGTH + 1u> m_limit{};
+  std::array<unsigned, MAX_CODE_LENGTH + 1u> m_offset{};
+
+  /// @brief - The symbols with a code, sorted by length and then by value.
+  std::vector<std::uint16_t> m_sorted{};
+};
+
+} // namespace utils
+
+#include "HuffmanCoder.hxx"
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "HuffmanCoder.hh"
+
+namespace utils {
+
+inline auto HuffmanCoder::size() const noexcept -> unsigned
+{
+  return static_cast<unsigned>(m_lengths.size());
+}
+
+inline auto HuffmanCoder::length(const unsigned symbol) const noexcept -> unsigned
+{
+  return m_lengths[symbol];
+}
+
+inline void HuffmanCoder::encode(BitWriter &out, const unsigned symbol) const noexcept
+{
+  out.push(m_codes[symbol], m_lengths[symbol]);
+}
+
+inline auto HuffmanCoder::decode(BitReader &in) const noexcept -> unsigned
+{
+  const auto bits   = static_cast<unsigned>(in.peek(MAX_CODE_LENGTH));
+  const auto &entry = m_lookup[bits >> (MAX_CODE_LENGTH - LOOKUP_BITS)];
+
+  if (entry.length == 0u)
+  {
+    return decodeLong(in, bits);
+  }
+
+  in.read(entry.length);
+  return entry.symbol;
+}
+
+} // namespace utils
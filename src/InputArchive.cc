@@ -0,0 +1,196 @@
+#include "InputArchive.hh"
+
+namespace utils {
+namespace {
+/// @brief - Read the length of a record, written with a fixed width.
+bool readRecordLength(InputArchive &in, std::uint32_t &length)
+{
+  if (!in.read(&length, sizeof(length)))
+  {
+    return false;
+  }
+
+  if (in.encoding() == IntegerEncoding::Portable)
+  {
+    length = fromLittleEndian(length);
+  }
+
+  return true;
+}
+} // namespace
+
+InputArchive::InputArchive(std::span<const unsigned char> data, const IntegerEncoding encoding)
+  : m_encoding(encoding)
+  , m_cursor(data.data())
+  , m_end(data.data() + data.size())
+  , m_begin(data.data())
+{}
+
+InputArchive::InputArchive(std::span<const std::byte> data, const IntegerEncoding encoding)
+  : InputArchive(std::span(reinterpret_cast<const unsigned char *>(data.data()), data.size()),
+                 encoding)
+{}
+
+InputArchive::InputArchive(std::istream &in, const IntegerEncoding encoding)
+  : m_encoding(encoding)
+  , m_in(&in)
+  , m_block(BLOCK_SIZE)
+{
+  m_begin  = m_block.data();
+  m_cursor = m_begin;
+  m_end    = m_begin;
+}
+
+void InputArchive::fail() noexcept
+{
+  m_failed = true;
+  m_end    = m_cursor;
+}
+
+bool InputArchive::beginRecord(std::uint32_t &version)
+{
+  std::uint32_t length{0u};
+  if (!readRecordLength(*this, length))
+  {
+    return false;
+  }
+
+  if (!mayHold(length))
+  {
+    fail();
+    return false;
+  }
+
+  const auto end = position() + length;
+  if (!deserialize(*this, version) || position() > end)
+  {
+    fail();
+    return false;
+  }
+
+  m_records.push_back(end);
+  return true;
+}
+
+bool InputArchive::endRecord()
+{
+  const auto end = m_records.back();
+  m_records.pop_back();
+
+  if (m_failed)
+  {
+    return false;
+  }
+
+  // Reading past the end of the record means that the data is corrupted.
+  const auto current = position();
+  if (current > end)
+  {
+    fail();
+    return false;
+  }
+
+  return skip(end - current);
+}
+
+bool InputArchive::skipRecord()
+{
+  std::uint32_t length{0u};
+  return readRecordLength(*this, length) && skip(length);
+}
+
+bool InputArchive::underflow(unsigned char *data, std::size_t size)
+{
+  if (m_failed)
+  {
+    return false;
+  }
+
+  while (m_in != nullptr && size > 0u)
+  {
+    // Take what is available and read the rest from the stream. Large
+    // reads go straight to the output.
+    const auto available = std::min(size, static_cast<std::size_t>(m_end - m_cursor));
+    std::memcpy(data, m_cursor, available);
+    m_cursor += available;
+    data += available;
+    size -= available;
+
+    if (size >= BLOCK_SIZE)
+    {
+      m_in->read(reinterpret_cast<char *>(data), size);
+      const auto read = static_cast<std::size_t>(m_in->gcount());
+      m_consumed += read;
+      data += read;
+      size -= read;
+      break;
+    }
+
+    if (size > 0u && !refill())
+    {
+      break;
+    }
+  }
+
+  if (size > 0u)
+  {
+    fail();
+    return false;
+  }
+
+  return true;
+}
+
+bool InputArchive::discard(std::uint64_t size)
+{
+  if (m_failed || m_in == nullptr)
+  {
+    fail();
+    return false;
+  }
+
+  // Drop the bytes available and skip the rest in the stream.
+  size -= static_cast<std::uint64_t>(m_end - m_cursor);
+  m_cursor = m_end;
+
+  while (size > 0u && m_in->good())
+  {
+    const auto chunk = std::min<std::uint64_t>(size, std::numeric_limits<std::streamsize>::max());
+    m_in->ignore(static_cast<std::streamsize>(chunk));
+
+    const auto skipped = static_cast<std::uint64_t>(m_in->gcount());
+    m_consumed += skipped;
+    size -= skipped;
+  }
+
+  if (size > 0u)
+  {
+    fail();
+    return false;
+  }
+
+  return true;
+}
+
+bool InputArchive::refill()
+{
+  if (m_in == nullptr || m_failed || !m_in->good())
+  {
+    return false;
+  }
+
+  const auto remaining = static_cast<std::size_t>(m_end - m_cursor);
+  m_consumed += static_cast<std::uint64_t>(m_cursor - m_begin);
+  std::memmove(m_block.data(), m_cursor, remaining);
+
+  m_in->read(reinterpret_cast<char *>(m_block.data() + remaining), BLOCK_SIZE - remaining);
+  const auto read = static_cast<std::size_t>(m_in->gcount());
+
+  m_begin  = m_block.data();
+  m_cursor = m_begin;
+  m_end    = m_begin + remaining + read;
+
+  return read > 0u;
+}
+
+} // namespace utils
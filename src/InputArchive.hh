@@ -0,0 +1,212 @@
+#pragma once
+
+#include "Reflection.hh"
+#include "SerializationUtils.hh"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace utils {
+
+/// @brief - Reads binary data written by an `OutputArchive` from a contiguous
+/// buffer. All reads are checked against the end of the data: reading past it
+/// fails the archive, after which nothing is read anymore. Lengths read from
+/// the data are checked as well, so that a corrupted length can't trigger a
+/// huge allocation. The archive can also read a stream by blocks. Values are
+/// read by the `deserialize` overloads below, which return `false` in case of
+/// failure. When reading memory, for example a `MappedFile`, strings can be
+/// read as views on the data and fields can be skipped to be decoded later
+/// with `Lazy`, so that only the parts of the data actually used are copied.
+class InputArchive
+{
+  public:
+  /// @brief - Create an archive reading the input bytes.
+  /// @param data - the bytes to read. They should outlive the archive.
+  /// @param encoding - how integers and lengths were written.
+  explicit InputArchive(std::span<const unsigned char> data,
+                        const IntegerEncoding encoding = IntegerEncoding::Fixed);
+
+  /// @brief - Create an archive reading the input bytes.
+  /// @param data - the bytes to read. They should outlive the archive.
+  /// @param encoding - how integers and lengths were written.
+  explicit InputArchive(std::span<const std::byte> data,
+                        const IntegerEncoding encoding = IntegerEncoding::Fixed);
+
+  /// @brief - Create an archive reading the input stream by blocks.
+  /// @param in - the stream to read from.
+  /// @param encoding - how integers and lengths were written.
+  explicit InputArchive(std::istream &in,
+                        const IntegerEncoding encoding = IntegerEncoding::Fixed);
+
+  InputArchive(const InputArchive &) = delete;
+  InputArchive &operator=(const InputArchive &) = delete;
+
+  /// @brief - How integers and lengths are read by this archive.
+  auto encoding() const noexcept -> IntegerEncoding;
+
+  /// @brief - Whether all the reads succeeded so far.
+  /// @return - `true` if no error occurred.
+  bool good() const noexcept;
+
+  /// @brief - The number of bytes read from the archive so far.
+  auto position() const noexcept -> std::uint64_t;
+
+  /// @brief - Read raw bytes. In case not enough bytes are available the
+  /// archive fails.
+  /// @param data - the buffer receiving the bytes.
+  /// @param size - the number of bytes to read.
+  /// @return - `true` if the bytes could be read.
+  bool read(void *data, const std::size_t size);
+
+  /// @brief - Read an integer written as a LEB128 varint.
+  /// @param value - the value read.
+  /// @return - `true` if the value could be read.
+  bool readVarint(std::uint64_t &value);
+
+  /// @brief - Skip bytes. In case not enough bytes are available the archive
+  /// fails. Skipping is immediate when reading memory.
+  /// @param size - the number of bytes to skip.
+  /// @return - `true` if the bytes could be skipped.
+  bool skip(const std::uint64_t size);
+
+  /// @brief - Whether the archive reads memory, in which case `view` and
+  /// `remaining` can be used.
+  bool inMemory() const noexcept;
+
+  /// @brief - Read the next bytes without copying them. Only possible when
+  /// reading memory: for streams the archive fails.
+  /// @param size - the number of bytes to read.
+  /// @return - a view on the bytes, valid as long as the data read by the
+  /// archive. Empty in case of failure.
+  auto view(const std::size_t size) -> std::span<const unsigned char>;
+
+  /// @brief - The bytes which were not read yet, when reading memory.
+  auto remaining() const noexcept -> std::span<const unsigned char>;
+
+  /// @brief - Whether the input number of bytes might still be read. This is
+  /// only known when reading from memory: for streams `true` is returned.
+  /// @param size - the number of bytes.
+  /// @return - `false` if the data is known to be shorter.
+  bool mayHold(const std::uint64_t size) const noexcept;
+
+  /// @brief - Fail the archive, for example when the data is invalid.
+  void fail() noexcept;
+
+  /// @brief - Open a record written by `OutputArchive::beginRecord`. The values
+  /// of the record are then read until `atRecordEnd` returns `true`, and the
+  /// record is closed with `endRecord`.
+  /// @param version - the version of the record.
+  /// @return - `true` if the record could be opened.
+  bool beginRecord(std::uint32_t &version);
+
+  /// @brief - Whether all the bytes of the last record opened were read. Values
+  /// missing from the record, for example because it was written by an older
+  /// version, should be given a default value.
+  bool atRecordEnd() const noexcept;
+
+  /// @brief - Close the last record opened, skipping the bytes which were not
+  /// read, for example because it was written by a newer version. This takes
+  /// constant time when reading memory.
+  /// @return - `false` if more bytes than the length of the record were read.
+  bool endRecord();
+
+  /// @brief - Skip a whole record without decoding it.
+  /// @return - `true` if the record could be skipped.
+  bool skipRecord();
+
+  private:
+  /// @brief - The size in bytes of the blocks read from a stream.
+  static constexpr auto BLOCK_SIZE = 65536u;
+
+  /// @brief - Used by `read` when not enough bytes are available in the buffer.
+  bool underflow(unsigned char *data, std::size_t size);
+
+  /// @brief - Used by `skip` when not enough bytes are available in the buffer.
+  bool discard(std::uint64_t size);
+
+  /// @brief - Read the next block of the stream, keeping the bytes which were not
+  /// read yet.
+  /// @return - `false` in case no more bytes are available.
+  bool refill();
+
+  private:
+  IntegerEncoding m_encoding;
+
+  std::istream *m_in{nullptr};
+  std::vector<unsigned char> m_block{};
+
+  /// @brief - The part of the data available for reading.
+  const unsigned char *m_cursor{nullptr};
+  const unsigned char *m_end{nullptr};
+
+  /// @brief - The number of bytes read before the current block.
+  std::uint64_t m_consumed{0u};
+  const unsigned char *m_begin{nullptr};
+  bool m_failed{false};
+
+  /// @brief - The position of the end of the records currently open.
+  std::vector<std::uint64_t> m_records{};
+};
+
+template<typename T,
+         std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value, bool> = true>
+bool deserialize(InputArchive &in, T &value);
+
+bool deserialize(InputArchive &in, std::string &str);
+
+/// @brief - Read a string as a view on the data of an archive reading memory.
+bool deserialize(InputArchive &in, std::string_view &str);
+
+template<typename T>
+bool deserialize(InputArchive &in, std::optional<T> &value);
+
+template<typename T>
+bool deserialize(InputArchive &in, std::vector<T> &values);
+
+template<typename T, std::size_t N>
+bool deserialize(InputArchive &in, std::array<T, N> &values);
+
+template<typename T, std::size_t N>
+bool deserialize(InputArchive &in, T (&values)[N]);
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool deserialize(InputArchive &in, std::map<Key, Value, Compare, Allocator> &values);
+
+/// @brief - An invalid index of alternative fails the archive.
+template<typename... Types>
+bool deserialize(InputArchive &in, std::variant<Types...> &value);
+
+template<typename T, std::enable_if_t<details::IsReflected<T>::value, bool> = true>
+bool deserialize(InputArchive &in, T &value);
+
+/// @brief - The values missing from the record are left to their default value
+/// and the values which are not known are skipped.
+template<typename T>
+bool deserialize(InputArchive &in, Framed<T> value);
+
+template<typename T>
+bool deserialize(InputArchive &in, Varint<T> value);
+
+template<typename T>
+bool deserialize(InputArchive &in, Compact<T> value);
+
+/// @brief - Skip a value of type `T` without decoding it. This takes constant
+/// time for arithmetic types, strings, packed structures and vectors or arrays
+/// of arithmetic types and framed values, and optionals, vectors, maps and
+/// structures made of such values are skipped recursively. Other values are decoded and discarded.
+/// @param in - the archive to read from.
+/// @return - `true` if the value could be skipped.
+template<typename T>
+bool skipValue(InputArchive &in);
+
+} // namespace utils
+
+#include "InputArchive.hxx"
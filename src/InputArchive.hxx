@@ -0,0 +1,586 @@
+#pragma once
+
+#include "InputArchive.hh"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace utils {
+
+inline auto InputArchive::encoding() const noexcept -> IntegerEncoding
+{
+  return m_encoding;
+}
+
+inline bool InputArchive::good() const noexcept
+{
+  return !m_failed;
+}
+
+inline auto InputArchive::position() const noexcept -> std::uint64_t
+{
+  return m_consumed + static_cast<std::uint64_t>(m_cursor - m_begin);
+}
+
+inline bool InputArchive::read(void *data, const std::size_t size)
+{
+  if (static_cast<std::size_t>(m_end - m_cursor) < size)
+  {
+    return underflow(static_cast<unsigned char *>(data), size);
+  }
+
+  std::memcpy(data, m_cursor, size);
+  m_cursor += size;
+
+  return true;
+}
+
+inline bool InputArchive::readVarint(std::uint64_t &value)
+{
+  // Make sure that a whole varint is available when reading a stream.
+  if (m_in != nullptr && m_end - m_cursor < static_cast<std::ptrdiff_t>(MAX_VARINT_BYTES))
+  {
+    refill();
+  }
+
+  if (!decodeVarint(m_cursor, m_end, value))
+  {
+    fail();
+    return false;
+  }
+
+  return true;
+}
+
+inline bool InputArchive::skip(const std::uint64_t size)
+{
+  if (static_cast<std::uint64_t>(m_end - m_cursor) < size)
+  {
+    return discard(size);
+  }
+
+  m_cursor += size;
+  return true;
+}
+
+inline bool InputArchive::inMemory() const noexcept
+{
+  return m_in == nullptr;
+}
+
+inline auto InputArchive::view(const std::size_t size) -> std::span<const unsigned char>
+{
+  if (m_in != nullptr || static_cast<std::size_t>(m_end - m_cursor) < size)
+  {
+    fail();
+    return {};
+  }
+
+  const auto out = std::span<const unsigned char>(m_cursor, size);
+  m_cursor += size;
+
+  return out;
+}
+
+inline auto InputArchive::remaining() const noexcept -> std::span<const unsigned char>
+{
+  return {m_cursor, m_end};
+}
+
+inline bool InputArchive::atRecordEnd() const noexcept
+{
+  return m_failed || m_records.empty() || position() >= m_records.back();
+}
+
+inline bool InputArchive::mayHold(const std::uint64_t size) const noexcept
+{
+  return m_in != nullptr || size <= static_cast<std::uint64_t>(m_end - m_cursor);
+}
+
+namespace details {
+/// @brief - Whether values of type `T` can be read in bulk by the archive.
+template<typename T>
+inline bool isBulkReadable(const InputArchive &in)
+{
+  return isBulkSerializable<T>(in.encoding());
+}
+
+template<typename T>
+inline bool deserializeElements(InputArchive &in, T *values, const std::size_t count)
+{
+  if (isBulkReadable<T>(in))
+  {
+    return count == 0u || in.read(values, count * sizeof(T));
+  }
+
+  for (std::size_t id = 0u; id < count; ++id)
+  {
+    if (!deserialize(in, values[id]))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/// @brief - Skip values of the input type, see `skipValue`.
+template<typename T>
+struct Skipper
+{
+  static bool skip(InputArchive &in)
+  {
+    if constexpr (std::is_arithmetic<T>::value || std::is_enum<T>::value)
+    {
+      if (in.encoding() == IntegerEncoding::Varint && isVarintCandidate<T>())
+      {
+        std::uint64_t raw{0u};
+        return in.readVarint(raw);
+      }
+
+      return in.skip(sizeof(T));
+    }
+    else if constexpr (IsReflected<T>::value)
+    {
+      // Skipping only depends on the size of the value, not on its byte order.
+      if (hasFixedSize<T>(in.encoding()))
+      {
+        return in.skip(sizeof(T));
+      }
+
+      return std::apply(
+        [&in](const auto... members) {
+          return (Skipper<FieldType<T, decltype(members)>>::skip(in) && ...);
+        },
+        Fields<T>::list);
+    }
+    else
+    {
+      T value{};
+      return deserialize(in, value);
+    }
+  }
+};
+
+template<>
+struct Skipper<std::string>
+{
+  static bool skip(InputArchive &in)
+  {
+    std::uint64_t size{0u};
+    return deserialize(in, size) && in.skip(size);
+  }
+};
+
+template<typename T>
+struct Skipper<std::optional<T>>
+{
+  static bool skip(InputArchive &in)
+  {
+    bool hasValue{false};
+    return deserialize(in, hasValue) && (!hasValue || Skipper<T>::skip(in));
+  }
+};
+
+/// @brief - Skip the input number of values of the input type.
+template<typename T>
+inline bool skipElements(InputArchive &in, const std::uint64_t count)
+{
+  if (hasFixedSize<T>(in.encoding()))
+  {
+    if (count > std::numeric_limits<std::uint64_t>::max() / sizeof(T))
+    {
+      in.fail();
+      return false;
+    }
+
+    return in.skip(count * sizeof(T));
+  }
+
+  for (std::uint64_t id = 0u; id < count; ++id)
+  {
+    if (!Skipper<T>::skip(in))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template<typename T>
+struct Skipper<std::vector<T>>
+{
+  static bool skip(InputArchive &in)
+  {
+    std::uint64_t size{0u};
+    return deserialize(in, size) && skipElements<T>(in, size);
+  }
+};
+
+template<typename T, std::size_t N>
+struct Skipper<std::array<T, N>>
+{
+  static bool skip(InputArchive &in)
+  {
+    return skipElements<T>(in, N);
+  }
+};
+
+template<typename T>
+struct Skipper<Framed<T>>
+{
+  static bool skip(InputArchive &in)
+  {
+    return in.skipRecord();
+  }
+};
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+struct Skipper<std::map<Key, Value, Compare, Allocator>>
+{
+  static bool skip(InputArchive &in)
+  {
+    std::uint64_t size{0u};
+    if (!deserialize(in, size))
+    {
+      return false;
+    }
+
+    for (std::uint64_t id = 0u; id < size; ++id)
+    {
+      if (!Skipper<Key>::skip(in) || !Skipper<Value>::skip(in))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+};
+
+/// @brief - Read the alternative of the variant at the input index.
+template<typename Variant, std::size_t... Indices>
+inline bool deserializeAlternative(InputArchive &in,
+                                   Variant &value,
+                                   const std::uint64_t index,
+                                   std::index_sequence<Indices...>)
+{
+  const auto read = [&in, &value](auto alternative) {
+    std::variant_alternative_t<decltype(alternative)::value, Variant> raw{};
+    if (!deserialize(in, raw))
+    {
+      return false;
+    }
+
+    value.template emplace<decltype(alternative)::value>(std::move(raw));
+    return true;
+  };
+
+  return ((index == Indices && read(std::integral_constant<std::size_t, Indices>{})) || ...);
+}
+
+/// @brief - Read the elements of a string or a vector. The container grows as
+/// the elements are read, so that a corrupted count fails at the end of the
+/// data instead of allocating memory for all the elements upfront. Each of
+/// the elements is assumed to take at least a byte.
+template<typename Container>
+inline bool deserializeSequence(InputArchive &in, Container &values, const std::uint64_t count)
+{
+  using Element = typename Container::value_type;
+
+  values.clear();
+
+  constexpr auto isString  = std::is_same<Container, std::string>::value;
+  constexpr auto isBitList = std::is_same<Container, std::vector<bool>>::value;
+  constexpr auto isRaw     = isRawType<Element>();
+  if constexpr (isString || (!isBitList && isRaw))
+  {
+    if (isString || isBulkReadable<Element>(in))
+    {
+      if (count > std::numeric_limits<std::uint64_t>::max() / sizeof(Element)
+          || !in.mayHold(count * sizeof(Element)))
+      {
+        in.fail();
+        return false;
+      }
+
+      // Read by chunks of about 64 KiB.
+      const auto chunk = std::max<std::uint64_t>(1u, 65536u / sizeof(Element));
+      while (values.size() < count)
+      {
+        const auto offset = values.size();
+        const auto size   = std::min<std::uint64_t>(count - offset, chunk);
+        values.resize(offset + size);
+
+        if (!in.read(values.data() + offset, size * sizeof(Element)))
+        {
+          return false;
+        }
+      }
+
+      return true;
+    }
+  }
+
+  if (!in.mayHold(count))
+  {
+    in.fail();
+    return false;
+  }
+
+  for (std::uint64_t id = 0u; id < count; ++id)
+  {
+    Element element{};
+    if (!deserialize(in, element))
+    {
+      return false;
+    }
+
+    values.push_back(std::move(element));
+  }
+
+  return true;
+}
+} // namespace details
+
+template<typename T,
+         std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value, bool>>
+inline bool deserialize(InputArchive &in, T &value)
+{
+  if constexpr (std::is_enum<T>::value)
+  {
+    std::underlying_type_t<T> raw{};
+    deserialize(in, raw);
+    value = static_cast<T>(raw);
+  }
+  else
+  {
+    if constexpr (details::isVarintCandidate<T>())
+    {
+      if (in.encoding() == IntegerEncoding::Varint)
+      {
+        return deserialize(in, varint(value));
+      }
+    }
+
+    if (in.read(&value, sizeof(T)) && in.encoding() == IntegerEncoding::Portable)
+    {
+      value = fromLittleEndian(value);
+    }
+  }
+
+  return in.good();
+}
+
+inline bool deserialize(InputArchive &in, std::string &str)
+{
+  std::uint64_t size{0u};
+  return deserialize(in, size) && details::deserializeSequence(in, str, size);
+}
+
+inline bool deserialize(InputArchive &in, std::string_view &str)
+{
+  std::uint64_t size{0u};
+  if (!deserialize(in, size))
+  {
+    return false;
+  }
+
+  if (!in.mayHold(size))
+  {
+    in.fail();
+    return false;
+  }
+
+  const auto bytes = in.view(size);
+  str = std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+
+  return in.good();
+}
+
+template<typename T>
+inline bool deserialize(InputArchive &in, std::optional<T> &value)
+{
+  bool hasValue{false};
+  if (!deserialize(in, hasValue))
+  {
+    return false;
+  }
+
+  if (hasValue)
+  {
+    T raw{};
+    deserialize(in, raw);
+    value = std::move(raw);
+  }
+  else
+  {
+    value.reset();
+  }
+
+  return in.good();
+}
+
+template<typename T>
+inline bool deserialize(InputArchive &in, std::vector<T> &values)
+{
+  std::uint64_t size{0u};
+  return deserialize(in, size) && details::deserializeSequence(in, values, size);
+}
+
+template<typename T, std::size_t N>
+inline bool deserialize(InputArchive &in, std::array<T, N> &values)
+{
+  return details::deserializeElements(in, values.data(), N);
+}
+
+template<typename T, std::size_t N>
+inline bool deserialize(InputArchive &in, T (&values)[N])
+{
+  return details::deserializeElements(in, values, N);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+inline bool deserialize(InputArchive &in, std::map<Key, Value, Compare, Allocator> &values)
+{
+  std::uint64_t size{0u};
+  if (!deserialize(in, size))
+  {
+    return false;
+  }
+
+  // Each entry is assumed to take at least a byte.
+  if (!in.mayHold(size))
+  {
+    in.fail();
+    return false;
+  }
+
+  values.clear();
+  for (std::uint64_t id = 0u; id < size; ++id)
+  {
+    Key key{};
+    Value value{};
+    if (!deserialize(in, key) || !deserialize(in, value))
+    {
+      return false;
+    }
+
+    values.emplace_hint(values.end(), std::move(key), std::move(value));
+  }
+
+  return true;
+}
+
+template<typename... Types>
+inline bool deserialize(InputArchive &in, std::variant<Types...> &value)
+{
+  std::uint64_t index{0u};
+  if (!deserialize(in, index))
+  {
+    return false;
+  }
+
+  if (index >= sizeof...(Types))
+  {
+    in.fail();
+    return false;
+  }
+
+  return details::deserializeAlternative(in, value, index, std::index_sequence_for<Types...>{});
+}
+
+template<typename T, std::enable_if_t<details::IsReflected<T>::value, bool>>
+inline bool deserialize(InputArchive &in, T &value)
+{
+  if (details::isBulkReadable<T>(in))
+  {
+    return in.read(&value, sizeof(T));
+  }
+
+  forEachField(value, [&in](auto &field) { deserialize(in, field); });
+
+  return in.good();
+}
+
+template<typename T>
+inline bool deserialize(InputArchive &in, Framed<T> value)
+{
+  std::uint32_t version{0u};
+  if (!in.beginRecord(version))
+  {
+    return false;
+  }
+
+  if constexpr (details::IsReflected<T>::value)
+  {
+    // Fields missing from the record keep the value they have by default.
+    T raw{};
+    forEachField(raw, [&in](auto &field) {
+      if (!in.atRecordEnd())
+      {
+        deserialize(in, field);
+      }
+    });
+
+    value.value = std::move(raw);
+  }
+  else if (!in.atRecordEnd())
+  {
+    deserialize(in, value.value);
+  }
+
+  return in.endRecord();
+}
+
+template<typename T>
+inline bool deserialize(InputArchive &in, Varint<T> value)
+{
+  std::uint64_t raw{0u};
+  if (!in.readVarint(raw))
+  {
+    return false;
+  }
+
+  // Values which don't fit in the output type are considered invalid.
+  if constexpr (std::is_signed<T>::value)
+  {
+    const auto decoded = zigzagDecode(raw);
+    if (decoded < std::numeric_limits<T>::min() || decoded > std::numeric_limits<T>::max())
+    {
+      in.fail();
+      return false;
+    }
+
+    value.value = static_cast<T>(decoded);
+  }
+  else
+  {
+    if (raw > std::numeric_limits<T>::max())
+    {
+      in.fail();
+      return false;
+    }
+
+    value.value = static_cast<T>(raw);
+  }
+
+  return true;
+}
+
+template<typename T>
+inline bool deserialize(InputArchive &in, Compact<T> value)
+{
+  std::uint64_t size{0u};
+  return in.readVarint(size) && details::deserializeSequence(in, value.value, size);
+}
+
+template<typename T>
+inline bool skipValue(InputArchive &in)
+{
+  return details::Skipper<T>::skip(in);
+}
+
+} // namespace utils
@@ -0,0 +1,126 @@
+#include "LatencyHistogram.hh"
+#include <algorithm>
+#include <bit>
+
+namespace utils {
+
+void LatencyHistogram::record(const std::chrono::nanoseconds value) noexcept
+{
+  const auto ns = static_cast<std::uint64_t>(std::max(value.count(), std::int64_t{0}));
+
+  m_buckets[bucketOf(ns)].fetch_add(1u, std::memory_order_relaxed);
+  m_count.fetch_add(1u, std::memory_order_relaxed);
+
+  auto max = m_max.load(std::memory_order_relaxed);
+  while (ns > max && !m_max.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+  {
+    // Retry with the updated maximum.
+  }
+}
+
+auto LatencyHistogram::count() const noexcept -> std::uint64_t
+{
+  return m_count.load(std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::max() const noexcept -> std::chrono::nanoseconds
+{
+  return std::chrono::nanoseconds(m_max.load(std::memory_order_relaxed));
+}
+
+auto LatencyHistogram::percentile(const double fraction) const noexcept -> std::chrono::nanoseconds
+{
+  // The buckets are read one by one while they might be updated so
+  // the total is recomputed rather than taken from `m_count`.
+  std::array<std::uint64_t, BUCKETS_COUNT> buckets{};
+  std::uint64_t total = 0u;
+  for (auto id = 0u; id < BUCKETS_COUNT; ++id)
+  {
+    buckets[id] = m_buckets[id].load(std::memory_order_relaxed);
+    total += buckets[id];
+  }
+
+  if (total == 0u)
+  {
+    return std::chrono::nanoseconds(0);
+  }
+
+  const auto rank = static_cast<std::uint64_t>(std::clamp(fraction, 0.0, 1.0)
+                                               * static_cast<double>(total - 1u));
+
+  std::uint64_t seen = 0u;
+  for (auto id = 0u; id < BUCKETS_COUNT; ++id)
+  {
+    seen += buckets[id];
+    if (seen > rank)
+    {
+      const auto bound = std::min(upperBoundOf(id), m_max.load(std::memory_order_relaxed));
+      return std::chrono::nanoseconds(bound);
+    }
+  }
+
+  return max();
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &rhs) noexcept
+{
+  for (auto id = 0u; id < BUCKETS_COUNT; ++id)
+  {
+    m_buckets[id].fetch_add(rhs.m_buckets[id].load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+  }
+
+  m_count.fetch_add(rhs.count(), std::memory_order_relaxed);
+
+  const auto rhsMax = rhs.m_max.load(std::memory_order_relaxed);
+  auto max          = m_max.load(std::memory_order_relaxed);
+  while (rhsMax > max && !m_max.compare_exchange_weak(max, rhsMax, std::memory_order_relaxed))
+  {
+    // Retry with the updated maximum.
+  }
+}
+
+void LatencyHistogram::reset() noexcept
+{
+  for (auto &bucket : m_buckets)
+  {
+    bucket.store(0u, std::memory_order_relaxed);
+  }
+
+  m_count.store(0u, std::memory_order_relaxed);
+  m_max.store(0u, std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::bucketOf(const std::uint64_t value) noexcept -> unsigned
+{
+  // Small values each have their own bucket.
+  if (value < SUB_BUCKETS)
+  {
+    return static_cast<unsigned>(value);
+  }
+
+  // Otherwise the position of the most significant bit selects the
+  // power of two and the next bits the sub-bucket.
+  const auto exponent = static_cast<unsigned>(std::bit_width(value)) - 1u;
+  const auto sub      = static_cast<unsigned>(value >> (exponent - SUB_BUCKETS_BITS))
+                   & (SUB_BUCKETS - 1u);
+
+  return (exponent - SUB_BUCKETS_BITS + 1u) * SUB_BUCKETS + sub;
+}
+
+auto LatencyHistogram::upperBoundOf(const unsigned bucket) noexcept -> std::uint64_t
+{
+  if (bucket < SUB_BUCKETS)
+  {
+    return bucket;
+  }
+
+  const auto exponent = bucket / SUB_BUCKETS + SUB_BUCKETS_BITS - 1u;
+  const auto sub      = static_cast<std::uint64_t>(bucket % SUB_BUCKETS);
+  const auto shift    = exponent - SUB_BUCKETS_BITS;
+
+  // The lowest value of the bucket is `(SUB_BUCKETS + sub) << shift`.
+  return ((SUB_BUCKETS + sub + 1u) << shift) - 1u;
+}
+
+} // namespace utils
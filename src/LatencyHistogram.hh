@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace utils {
+
+/// @brief - A histogram of durations which can be updated concurrently without
+/// locking. Buckets grow exponentially, each power of two being split in a few
+/// linear sub-buckets, so that percentiles are known with a bounded relative
+/// error (12.5%) over the whole range of durations.
+class LatencyHistogram
+{
+  public:
+  LatencyHistogram() = default;
+
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+  /// @brief - Register a new duration in the histogram.
+  /// @param value - the duration to register.
+  void record(const std::chrono::nanoseconds value) noexcept;
+
+  /// @brief - The number of durations registered.
+  /// @return - the number of samples.
+  auto count() const noexcept -> std::uint64_t;
+
+  /// @brief - The longest duration registered.
+  /// @return - the maximum of the samples.
+  auto max() const noexcept -> std::chrono::nanoseconds;
+
+  /// @brief - Estimate the duration below which the input fraction of samples
+  /// falls. The returned value is the upper bound of the matching bucket.
+  /// @param fraction - the fraction of samples, in `[0; 1]`.
+  /// @return - the percentile or `0` in case the histogram is empty.
+  auto percentile(const double fraction) const noexcept -> std::chrono::nanoseconds;
+
+  /// @brief - Add the samples of the input histogram to this one. Used to gather
+  /// histograms filled by different threads.
+  /// @param rhs - the histogram to merge.
+  void merge(const LatencyHistogram &rhs) noexcept;
+
+  /// @brief - Remove all the samples of the histogram.
+  void reset() noexcept;
+
+  private:
+  /// @brief - Each power of two is split in `2^SUB_BUCKETS_BITS` buckets.
+  static constexpr auto SUB_BUCKETS_BITS = 3u;
+  static constexpr auto SUB_BUCKETS      = 1u << SUB_BUCKETS_BITS;
+  static constexpr auto BUCKETS_COUNT    = (64u - SUB_BUCKETS_BITS + 1u) * SUB_BUCKETS;
+
+  /// @brief - Compute the index of the bucket holding the input value.
+  static auto bucketOf(const std::uint64_t value) noexcept -> unsigned;
+
+  /// @brief - Compute the largest value held by the input bucket.
+  static auto upperBoundOf(const unsigned bucket) noexcept -> std::uint64_t;
+
+  private:
+  std::array<std::atomic_uint64_t, BUCKETS_COUNT> m_buckets{};
+  std::atomic_uint64_t m_count{0u};
+  std::atomic_uint64_t m_max{0u};
+};
+
+} // namespace utils
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "InputArchive.hh"
+#include <span>
+
+namespace utils {
+
+/// @brief - A value read from an archive reading memory which is only decoded
+/// when needed. Deserializing it skips the value, see `skipValue`, and keeps a
+/// view on its bytes: the data read by the archive should outlive it. This is
+/// meant for large files mapped in memory where only a few fields are used.
+template<typename T>
+class Lazy
+{
+  public:
+  Lazy() = default;
+
+  /// @brief - Create a lazy value from its encoded bytes.
+  /// @param bytes - the bytes of the value.
+  /// @param encoding - how integers and lengths were written.
+  Lazy(std::span<const unsigned char> bytes, const IntegerEncoding encoding) noexcept;
+
+  /// @brief - The encoded bytes of the value.
+  auto bytes() const noexcept -> std::span<const unsigned char>;
+
+  /// @brief - Decode the value.
+  /// @param value - the decoded value.
+  /// @return - `false` in case the value could not be decoded.
+  bool decode(T &value) const;
+
+  private:
+  std::span<const unsigned char> m_bytes{};
+  IntegerEncoding m_encoding{IntegerEncoding::Fixed};
+};
+
+/// @brief - Skip a value and keep a view on its bytes. Only possible when the
+/// archive reads memory: for streams the archive fails.
+template<typename T>
+bool deserialize(InputArchive &in, Lazy<T> &value);
+
+} // namespace utils
+
+#include "Lazy.hxx"
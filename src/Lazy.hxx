@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Lazy.hh"
+
+namespace utils {
+
+template<typename T>
+inline Lazy<T>::Lazy(std::span<const unsigned char> bytes, const IntegerEncoding encoding) noexcept
+  : m_bytes(bytes)
+  , m_encoding(encoding)
+{}
+
+template<typename T>
+inline auto Lazy<T>::bytes() const noexcept -> std::span<const unsigned char>
+{
+  return m_bytes;
+}
+
+template<typename T>
+inline bool Lazy<T>::decode(T &value) const
+{
+  InputArchive in(m_bytes, m_encoding);
+  return deserialize(in, value);
+}
+
+template<typename T>
+inline bool deserialize(InputArchive &in, Lazy<T> &value)
+{
+  if (!in.inMemory())
+  {
+    in.fail();
+    return false;
+  }
+
+  const auto before = in.remaining();
+  if (!skipValue<T>(in))
+  {
+    return false;
+  }
+
+  const auto size = before.size() - in.remaining().size();
+  value           = Lazy<T>(before.first(size), in.encoding());
+
+  return true;
+}
+
+} // namespace utils
@@ -0,0 +1,73 @@
+#include "MappedFile.hh"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils {
+
+MappedFile::MappedFile(const std::filesystem::path &path)
+  : CoreObject("mapping")
+{
+  setService("binary");
+
+  const auto fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    error("Failed to open \"" + path.string() + "\"", std::strerror(errno));
+  }
+
+  struct stat info;
+  if (::fstat(fd, &info) != 0)
+  {
+    const auto cause = std::string(std::strerror(errno));
+    ::close(fd);
+    error("Failed to get size of \"" + path.string() + "\"", cause);
+  }
+
+  // Empty files can't be mapped.
+  m_size = static_cast<std::size_t>(info.st_size);
+  if (m_size > 0u)
+  {
+    m_mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m_mapping == MAP_FAILED)
+    {
+      const auto cause = std::string(std::strerror(errno));
+      ::close(fd);
+      m_mapping = nullptr;
+      error("Failed to map \"" + path.string() + "\"", cause);
+    }
+  }
+
+  ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_mapping != nullptr)
+  {
+    ::munmap(m_mapping, m_size);
+  }
+}
+
+auto MappedFile::bytes() const noexcept -> std::span<const unsigned char>
+{
+  return {static_cast<const unsigned char *>(m_mapping), m_size};
+}
+
+auto MappedFile::size() const noexcept -> std::size_t
+{
+  return m_size;
+}
+
+void MappedFile::adviseSequential() noexcept
+{
+  if (m_mapping != nullptr)
+  {
+    ::madvise(m_mapping, m_size, MADV_SEQUENTIAL);
+  }
+}
+
+} // namespace utils
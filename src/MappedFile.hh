@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CoreObject.hh"
+#include <filesystem>
+#include <span>
+
+namespace utils {
+
+/// @brief - A file mapped read-only in memory. Opening a file is cheap whatever
+/// its size: its pages are only read from the disk when accessed. The mapping
+/// is released when the object is destroyed.
+class MappedFile : public CoreObject
+{
+  public:
+  /// @brief - Map the input file in memory. An exception is raised in case the
+  /// file can't be mapped.
+  /// @param path - the path to the file to map.
+  MappedFile(const std::filesystem::path &path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /// @brief - The content of the file.
+  /// @return - a view on the bytes of the file, valid as long as this object.
+  auto bytes() const noexcept -> std::span<const unsigned char>;
+
+  /// @brief - The size of the file in bytes.
+  auto size() const noexcept -> std::size_t;
+
+  /// @brief - Indicate that the file will be read sequentially, so that the
+  /// system reads pages ahead.
+  void adviseSequential() noexcept;
+
+  private:
+  void *m_mapping{nullptr};
+  std::size_t m_size{0u};
+};
+
+} // namespace utils
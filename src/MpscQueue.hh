@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace utils {
+
+/// @brief - A bounded lock-free queue allowing many threads to push elements
+/// and a single thread to pop them. Each slot carries a sequence number which
+/// tells whether it is ready to be written by a producer or read by the
+/// consumer, as described by D. Vyukov for his bounded MPMC queue.
+template<typename T>
+class MpscQueue
+{
+  public:
+  /// @brief - Create a queue able to hold at least `capacity` elements. The
+  /// value is rounded up to the next power of two.
+  /// @param capacity - the minimum number of elements the queue can hold.
+  MpscQueue(const std::size_t capacity);
+
+  ~MpscQueue() = default;
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  /// @brief - Attempt to push an element in the queue. Can be called by any
+  /// number of threads concurrently.
+  /// @param item - the element to push. It is only moved from in case the
+  /// operation succeeds.
+  /// @return - `false` if the queue is full.
+  bool tryPush(T &item) noexcept;
+
+  /// @brief - Attempt to pop the oldest element of the queue. Should only be
+  /// called by the consumer thread.
+  /// @param out - output argument receiving the element.
+  /// @return - `false` if the queue is empty.
+  bool tryPop(T &out) noexcept;
+
+  /// @brief - Return an approximation of the number of elements in the queue.
+  /// @return - the approximate size of the queue.
+  auto size() const noexcept -> std::size_t;
+
+  /// @brief - Whether the queue seems empty. Same remark as for `size`.
+  /// @return - `true` if the queue seems empty.
+  bool empty() const noexcept;
+
+  /// @brief - The maximum number of elements the queue can hold.
+  /// @return - the capacity of the queue.
+  auto capacity() const noexcept -> std::size_t;
+
+  private:
+  struct Cell
+  {
+    std::atomic<std::size_t> sequence{0u};
+    T data{};
+  };
+
+  private:
+  std::size_t m_mask;
+  std::unique_ptr<Cell[]> m_cells;
+
+  /// @brief - The position where the next element will be pushed. Contended
+  /// by all producers so it lives on its own cache line.
+  alignas(64) std::atomic<std::size_t> m_enqueuePos{0u};
+
+  /// @brief - The position of the next element to pop. Only modified by the
+  /// consumer.
+  alignas(64) std::atomic<std::size_t> m_dequeuePos{0u};
+};
+
+} // namespace utils
+
+#include "MpscQueue.hxx"
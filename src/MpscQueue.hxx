@@ -0,0 +1,99 @@
+#pragma once
+
+#include "MpscQueue.hh"
+
+namespace utils {
+
+template<typename T>
+inline MpscQueue<T>::MpscQueue(const std::size_t capacity)
+  : m_mask(0u)
+  , m_cells()
+{
+  std::size_t cap = 2u;
+  while (cap < capacity)
+  {
+    cap <<= 1;
+  }
+
+  m_mask  = cap - 1u;
+  m_cells = std::make_unique<Cell[]>(cap);
+  for (std::size_t id = 0u; id < cap; ++id)
+  {
+    m_cells[id].sequence.store(id, std::memory_order_relaxed);
+  }
+}
+
+template<typename T>
+inline bool MpscQueue<T>::tryPush(T &item) noexcept
+{
+  auto pos = m_enqueuePos.load(std::memory_order_relaxed);
+
+  while (true)
+  {
+    auto &cell      = m_cells[pos & m_mask];
+    const auto seq  = cell.sequence.load(std::memory_order_acquire);
+    const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+    if (diff == 0)
+    {
+      // The cell is free: try to reserve it.
+      if (m_enqueuePos.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed))
+      {
+        cell.data = std::move(item);
+        cell.sequence.store(pos + 1u, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (diff < 0)
+    {
+      // The cell still holds an element which was not consumed yet.
+      return false;
+    }
+    else
+    {
+      // Another producer reserved this cell: try again.
+      pos = m_enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template<typename T>
+inline bool MpscQueue<T>::tryPop(T &out) noexcept
+{
+  const auto pos = m_dequeuePos.load(std::memory_order_relaxed);
+  auto &cell     = m_cells[pos & m_mask];
+  const auto seq = cell.sequence.load(std::memory_order_acquire);
+
+  if (seq != pos + 1u)
+  {
+    return false;
+  }
+
+  out = std::move(cell.data);
+  cell.sequence.store(pos + m_mask + 1u, std::memory_order_release);
+  m_dequeuePos.store(pos + 1u, std::memory_order_relaxed);
+
+  return true;
+}
+
+template<typename T>
+inline auto MpscQueue<T>::size() const noexcept -> std::size_t
+{
+  const auto enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+  const auto dequeued = m_dequeuePos.load(std::memory_order_relaxed);
+  return enqueued > dequeued ? enqueued - dequeued : 0u;
+}
+
+template<typename T>
+inline bool MpscQueue<T>::empty() const noexcept
+{
+  return size() == 0u;
+}
+
+template<typename T>
+inline auto MpscQueue<T>::capacity() const noexcept -> std::size_t
+{
+  return m_mask + 1u;
+}
+
+} // namespace utils
@@ -0,0 +1,186 @@
+#include "OutputArchive.hh"
+#include <algorithm>
+#include <limits>
+
+namespace utils {
+/// @brief - The initial size of the buffer owned by an archive.
+constexpr auto INITIAL_BUFFER_SIZE = 256u;
+
+OutputArchive::OutputArchive(const IntegerEncoding encoding)
+  : m_sink(Sink::Buffer)
+  , m_encoding(encoding)
+  , m_buffer(INITIAL_BUFFER_SIZE)
+{
+  m_begin  = m_buffer.data();
+  m_cursor = m_begin;
+  m_end    = m_begin + m_buffer.size();
+}
+
+OutputArchive::OutputArchive(std::span<unsigned char> out, const IntegerEncoding encoding)
+  : m_sink(Sink::Span)
+  , m_encoding(encoding)
+  , m_begin(out.data())
+  , m_cursor(out.data())
+  , m_end(out.data() + out.size())
+{}
+
+OutputArchive::OutputArchive(std::ostream &out, const IntegerEncoding encoding)
+  : m_sink(Sink::Stream)
+  , m_encoding(encoding)
+  , m_buffer(BLOCK_SIZE)
+  , m_out(&out)
+{
+  m_begin  = m_buffer.data();
+  m_cursor = m_begin;
+  m_end    = m_begin + m_buffer.size();
+}
+
+OutputArchive::~OutputArchive()
+{
+  flush();
+}
+
+auto OutputArchive::release() -> std::vector<unsigned char>
+{
+  if (m_sink != Sink::Buffer)
+  {
+    return {};
+  }
+
+  m_buffer.resize(static_cast<std::size_t>(m_cursor - m_begin));
+  auto out = std::move(m_buffer);
+
+  m_buffer.assign(INITIAL_BUFFER_SIZE, 0u);
+  m_begin  = m_buffer.data();
+  m_cursor = m_begin;
+  m_end    = m_begin + m_buffer.size();
+
+  return out;
+}
+
+void OutputArchive::flush()
+{
+  if (m_sink != Sink::Stream)
+  {
+    return;
+  }
+
+  // The length of the open records is not known yet.
+  auto *pending = m_cursor;
+  if (!m_records.empty())
+  {
+    pending = m_begin + (m_records.front() - m_flushed);
+  }
+
+  if (pending == m_begin)
+  {
+    return;
+  }
+
+  if (!m_failed)
+  {
+    m_out->write(reinterpret_cast<const char *>(m_begin), pending - m_begin);
+    m_failed = !m_out->good();
+  }
+
+  const auto kept = static_cast<std::size_t>(m_cursor - pending);
+  m_flushed += static_cast<std::uint64_t>(pending - m_begin);
+  std::memmove(m_begin, pending, kept);
+  m_cursor = m_begin + kept;
+}
+
+void OutputArchive::beginRecord(const std::uint32_t version)
+{
+  m_records.push_back(size());
+
+  const std::uint32_t length{0u};
+  write(&length, sizeof(length));
+  serialize(*this, version);
+}
+
+void OutputArchive::endRecord()
+{
+  const auto offset = m_records.back();
+  m_records.pop_back();
+
+  if (m_failed)
+  {
+    return;
+  }
+
+  const auto length = size() - offset - sizeof(std::uint32_t);
+  if (length > std::numeric_limits<std::uint32_t>::max())
+  {
+    m_failed = true;
+    m_end    = m_cursor;
+    return;
+  }
+
+  auto raw = static_cast<std::uint32_t>(length);
+  if (m_encoding == IntegerEncoding::Portable)
+  {
+    raw = toLittleEndian(raw);
+  }
+
+  std::memcpy(m_begin + (offset - m_flushed), &raw, sizeof(raw));
+}
+
+void OutputArchive::overflow(const unsigned char *data, std::size_t size)
+{
+  if (m_failed)
+  {
+    return;
+  }
+
+  switch (m_sink)
+  {
+    case Sink::Buffer:
+      grow(size);
+      break;
+    case Sink::Stream:
+      flush();
+
+      // Large writes go straight to the stream, unless they belong to a
+      // record whose length is not known yet.
+      if (size >= BLOCK_SIZE && m_records.empty() && !m_failed)
+      {
+        m_out->write(reinterpret_cast<const char *>(data), size);
+        m_failed = !m_out->good();
+        m_flushed += size;
+        return;
+      }
+
+      if (static_cast<std::size_t>(m_end - m_cursor) < size)
+      {
+        grow(size);
+      }
+      break;
+    case Sink::Span:
+    default:
+      m_failed = true;
+      break;
+  }
+
+  // Nothing is written anymore once the archive failed.
+  if (m_failed)
+  {
+    m_end = m_cursor;
+    return;
+  }
+
+  std::memcpy(m_cursor, data, size);
+  m_cursor += size;
+}
+
+void OutputArchive::grow(const std::size_t size)
+{
+  // Grow the buffer geometrically.
+  const auto used = static_cast<std::size_t>(m_cursor - m_begin);
+  m_buffer.resize(std::max(2u * m_buffer.size(), used + size));
+
+  m_begin  = m_buffer.data();
+  m_cursor = m_begin + used;
+  m_end    = m_begin + m_buffer.size();
+}
+
+} // namespace utils
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "Reflection.hh"
+#include "SerializationUtils.hh"
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace utils {
+
+/// @brief - Writes binary data to a contiguous buffer with plain memory copies,
+/// which is much cheaper than going through a stream for each field. The buffer
+/// is either owned by the archive and grows as needed, or provided by the user
+/// in which case writing past its end fails the archive. The archive can also
+/// act as a buffer in front of a stream, in which case it is written to the
+/// stream when full. Values are written by the `serialize` overloads below.
+class OutputArchive
+{
+  public:
+  /// @brief - Create an archive writing to a buffer which grows as needed.
+  /// @param encoding - how integers and lengths are written.
+  explicit OutputArchive(const IntegerEncoding encoding = IntegerEncoding::Fixed);
+
+  /// @brief - Create an archive writing to the input buffer. Writing past the
+  /// end of the buffer fails the archive.
+  /// @param out - the buffer to write to.
+  /// @param encoding - how integers and lengths are written.
+  explicit OutputArchive(std::span<unsigned char> out,
+                         const IntegerEncoding encoding = IntegerEncoding::Fixed);
+
+  /// @brief - Create an archive writing to the input stream by blocks. The data
+  /// pending in the archive is written when the archive is destroyed.
+  /// @param out - the stream to write to.
+  /// @param encoding - how integers and lengths are written.
+  explicit OutputArchive(std::ostream &out,
+                         const IntegerEncoding encoding = IntegerEncoding::Fixed);
+
+  ~OutputArchive();
+
+  OutputArchive(const OutputArchive &) = delete;
+  OutputArchive &operator=(const OutputArchive &) = delete;
+
+  /// @brief - How integers and lengths are written by this archive.
+  auto encoding() const noexcept -> IntegerEncoding;
+
+  /// @brief - Whether all the data was written so far. Once an error occurred
+  /// nothing is written anymore.
+  /// @return - `true` if no error occurred.
+  bool good() const noexcept;
+
+  /// @brief - The number of bytes written to the archive so far.
+  auto size() const noexcept -> std::uint64_t;
+
+  /// @brief - Write raw bytes.
+  /// @param data - the bytes to write.
+  /// @param size - the number of bytes to write.
+  void write(const void *data, const std::size_t size);
+
+  /// @brief - Write an integer as a LEB128 varint.
+  /// @param value - the value to write.
+  void writeVarint(const std::uint64_t value);
+
+  /// @brief - The bytes written to the archive and not yet written to the
+  /// stream, if any.
+  /// @return - a view on the bytes, valid until the next write.
+  auto data() const noexcept -> std::span<const unsigned char>;
+
+  /// @brief - Move the bytes out of an archive owning its buffer, which is
+  /// then empty.
+  /// @return - the bytes written to the archive.
+  auto release() -> std::vector<unsigned char>;
+
+  /// @brief - Write the pending bytes to the stream, if any. The bytes of the
+  /// records still open are kept until they are closed.
+  void flush();
+
+  /// @brief - Open a record: a 32-bit length followed by the version of the
+  /// record, then by the values written until the record is closed. Records
+  /// let readers skip the data they don't know of, see `InputArchive`. They
+  /// can be nested and should be closed before the archive is destroyed.
+  /// @param version - the version of the record.
+  void beginRecord(const std::uint32_t version);
+
+  /// @brief - Close the last record opened and write its length. Records of
+  /// more than 4 GiB fail the archive.
+  void endRecord();
+
+  private:
+  /// @brief - Where the bytes are written.
+  enum class Sink
+  {
+    Buffer,
+    Span,
+    Stream
+  };
+
+  /// @brief - The size in bytes of the blocks written to a stream.
+  static constexpr auto BLOCK_SIZE = 65536u;
+
+  /// @brief - Used by `write` when the bytes don't fit in the buffer.
+  void overflow(const unsigned char *data, std::size_t size);
+
+  /// @brief - Grow the owned buffer so that it can hold the input number of
+  /// additional bytes.
+  void grow(const std::size_t size);
+
+  private:
+  Sink m_sink;
+  IntegerEncoding m_encoding;
+
+  /// @brief - The buffer owned by the archive, used for the `Buffer` and the
+  /// `Stream` sinks.
+  std::vector<unsigned char> m_buffer{};
+  std::ostream *m_out{nullptr};
+
+  /// @brief - The part of the buffer where bytes are written.
+  unsigned char *m_begin{nullptr};
+  unsigned char *m_cursor{nullptr};
+  unsigned char *m_end{nullptr};
+
+  /// @brief - The number of bytes written to the stream.
+  std::uint64_t m_flushed{0u};
+  bool m_failed{false};
+
+  /// @brief - The position of the length of the records currently open.
+  std::vector<std::uint64_t> m_records{};
+};
+
+/// @brief - Integers are written according to the encoding of the archive,
+/// other arithmetic types as they are in memory and enumerations as their
+/// underlying type.
+template<typename T,
+         std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value, bool> = true>
+auto serialize(OutputArchive &out, const T &value) -> OutputArchive &;
+
+auto serialize(OutputArchive &out, const std::string &str) -> OutputArchive &;
+
+template<typename T>
+auto serialize(OutputArchive &out, const std::optional<T> &value) -> OutputArchive &;
+
+/// @brief - Vectors and arrays of arithmetic types and of packed trivially
+/// copyable structures, see `Fields`, are copied in bulk, except when they
+/// hold integers written as varints.
+template<typename T>
+auto serialize(OutputArchive &out, const std::vector<T> &values) -> OutputArchive &;
+
+template<typename T, std::size_t N>
+auto serialize(OutputArchive &out, const std::array<T, N> &values) -> OutputArchive &;
+
+template<typename T, std::size_t N>
+auto serialize(OutputArchive &out, const T (&values)[N]) -> OutputArchive &;
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+auto serialize(OutputArchive &out, const std::map<Key, Value, Compare, Allocator> &values)
+  -> OutputArchive &;
+
+/// @brief - The index of the alternative is written as a 64-bit integer,
+/// followed by the alternative.
+template<typename... Types>
+auto serialize(OutputArchive &out, const std::variant<Types...> &value) -> OutputArchive &;
+
+/// @brief - Structures defining a list of fields, see `Fields`, are written
+/// field by field. When the fields are packed in memory and are all written
+/// as they are in memory, the structure is copied at once instead.
+template<typename T, std::enable_if_t<details::IsReflected<T>::value, bool> = true>
+auto serialize(OutputArchive &out, const T &value) -> OutputArchive &;
+
+/// @brief - The value is written as a record with the version of its type, see
+/// `Version`. Structures defining a list of fields are written field by field.
+template<typename T>
+auto serialize(OutputArchive &out, const Framed<T> &value) -> OutputArchive &;
+
+template<typename T>
+auto serialize(OutputArchive &out, const Varint<T> &value) -> OutputArchive &;
+
+template<typename T>
+auto serialize(OutputArchive &out, const Compact<T> &value) -> OutputArchive &;
+
+} // namespace utils
+
+#include "OutputArchive.hxx"
@@ -0,0 +1,261 @@
+#pragma once
+
+#include "OutputArchive.hh"
+#include <cstring>
+
+namespace utils {
+
+inline auto OutputArchive::encoding() const noexcept -> IntegerEncoding
+{
+  return m_encoding;
+}
+
+inline bool OutputArchive::good() const noexcept
+{
+  return !m_failed;
+}
+
+inline auto OutputArchive::size() const noexcept -> std::uint64_t
+{
+  return m_flushed + static_cast<std::uint64_t>(m_cursor - m_begin);
+}
+
+inline void OutputArchive::write(const void *data, const std::size_t size)
+{
+  if (static_cast<std::size_t>(m_end - m_cursor) < size)
+  {
+    overflow(static_cast<const unsigned char *>(data), size);
+    return;
+  }
+
+  std::memcpy(m_cursor, data, size);
+  m_cursor += size;
+}
+
+inline void OutputArchive::writeVarint(const std::uint64_t value)
+{
+  if (m_end - m_cursor >= static_cast<std::ptrdiff_t>(MAX_VARINT_BYTES))
+  {
+    m_cursor += encodeVarint(value, m_cursor);
+    return;
+  }
+
+  unsigned char buffer[MAX_VARINT_BYTES];
+  write(buffer, encodeVarint(value, buffer));
+}
+
+inline auto OutputArchive::data() const noexcept -> std::span<const unsigned char>
+{
+  return {m_begin, m_cursor};
+}
+
+namespace details {
+template<typename T>
+inline void serializeElements(OutputArchive &out, const T *values, const std::size_t count)
+{
+  if (isBulkSerializable<T>(out.encoding()))
+  {
+    if (count > 0u)
+    {
+      out.write(values, count * sizeof(T));
+    }
+
+    return;
+  }
+
+  for (std::size_t id = 0u; id < count; ++id)
+  {
+    serialize(out, values[id]);
+  }
+}
+} // namespace details
+
+template<typename T,
+         std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value, bool>>
+inline auto serialize(OutputArchive &out, const T &value) -> OutputArchive &
+{
+  if constexpr (std::is_enum<T>::value)
+  {
+    serialize(out, static_cast<std::underlying_type_t<T>>(value));
+  }
+  else
+  {
+    if constexpr (details::isVarintCandidate<T>())
+    {
+      if (out.encoding() == IntegerEncoding::Varint)
+      {
+        serialize(out, varint(value));
+        return out;
+      }
+    }
+
+    if (out.encoding() == IntegerEncoding::Portable)
+    {
+      const auto raw = toLittleEndian(value);
+      out.write(&raw, sizeof(T));
+    }
+    else
+    {
+      out.write(&value, sizeof(T));
+    }
+  }
+
+  return out;
+}
+
+inline auto serialize(OutputArchive &out, const std::string &str) -> OutputArchive &
+{
+  serialize(out, std::uint64_t{str.size()});
+  if (!str.empty())
+  {
+    out.write(str.data(), str.size());
+  }
+
+  return out;
+}
+
+template<typename T>
+inline auto serialize(OutputArchive &out, const std::optional<T> &value) -> OutputArchive &
+{
+  serialize(out, value.has_value());
+  if (value.has_value())
+  {
+    serialize(out, *value);
+  }
+
+  return out;
+}
+
+template<typename T>
+inline auto serialize(OutputArchive &out, const std::vector<T> &values) -> OutputArchive &
+{
+  serialize(out, std::uint64_t{values.size()});
+
+  if constexpr (std::is_same<T, bool>::value)
+  {
+    for (const bool value : values)
+    {
+      serialize(out, value);
+    }
+  }
+  else
+  {
+    details::serializeElements(out, values.data(), values.size());
+  }
+
+  return out;
+}
+
+template<typename T, std::size_t N>
+inline auto serialize(OutputArchive &out, const std::array<T, N> &values) -> OutputArchive &
+{
+  details::serializeElements(out, values.data(), N);
+  return out;
+}
+
+template<typename T, std::size_t N>
+inline auto serialize(OutputArchive &out, const T (&values)[N]) -> OutputArchive &
+{
+  details::serializeElements(out, values, N);
+  return out;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+inline auto serialize(OutputArchive &out, const std::map<Key, Value, Compare, Allocator> &values)
+  -> OutputArchive &
+{
+  serialize(out, std::uint64_t{values.size()});
+  for (const auto &[key, value] : values)
+  {
+    serialize(out, key);
+    serialize(out, value);
+  }
+
+  return out;
+}
+
+template<typename... Types>
+inline auto serialize(OutputArchive &out, const std::variant<Types...> &value) -> OutputArchive &
+{
+  serialize(out, std::uint64_t{value.index()});
+  std::visit([&out](const auto &alternative) { serialize(out, alternative); }, value);
+
+  return out;
+}
+
+template<typename T, std::enable_if_t<details::IsReflected<T>::value, bool>>
+inline auto serialize(OutputArchive &out, const T &value) -> OutputArchive &
+{
+  if (details::isBulkSerializable<T>(out.encoding()))
+  {
+    out.write(&value, sizeof(T));
+    return out;
+  }
+
+  forEachField(value, [&out](const auto &field) { serialize(out, field); });
+
+  return out;
+}
+
+template<typename T>
+inline auto serialize(OutputArchive &out, const Framed<T> &value) -> OutputArchive &
+{
+  out.beginRecord(Version<std::remove_const_t<T>>::value);
+
+  if constexpr (details::IsReflected<std::remove_const_t<T>>::value)
+  {
+    forEachField(value.value, [&out](const auto &field) { serialize(out, field); });
+  }
+  else
+  {
+    serialize(out, value.value);
+  }
+
+  out.endRecord();
+
+  return out;
+}
+
+template<typename T>
+inline auto serialize(OutputArchive &out, const Varint<T> &value) -> OutputArchive &
+{
+  if constexpr (std::is_signed<T>::value)
+  {
+    out.writeVarint(zigzagEncode(value.value));
+  }
+  else
+  {
+    out.writeVarint(value.value);
+  }
+
+  return out;
+}
+
+template<typename T>
+inline auto serialize(OutputArchive &out, const Compact<T> &value) -> OutputArchive &
+{
+  out.writeVarint(value.value.size());
+
+  if constexpr (std::is_same<std::remove_const_t<T>, std::string>::value)
+  {
+    if (!value.value.empty())
+    {
+      out.write(value.value.data(), value.value.size());
+    }
+  }
+  else if constexpr (std::is_same<std::remove_const_t<T>, std::vector<bool>>::value)
+  {
+    for (const bool element : value.value)
+    {
+      serialize(out, element);
+    }
+  }
+  else
+  {
+    details::serializeElements(out, value.value.data(), value.value.size());
+  }
+
+  return out;
+}
+
+} // namespace utils
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ThreadPool.hh"
+#include <cstddef>
+#include <functional>
+#include <iterator>
+
+namespace utils {
+
+/// @brief - Defines how the iterations of a `parallelFor` are distributed to the
+/// threads of the pool:
+///  - static: the range is split in as many chunks of equal size as there are
+///    threads in the pool.
+///  - dynamic: each thread repeatedly grabs a chunk of `grain` iterations until
+///    the range is exhausted. Suited for iterations with uneven costs.
+///  - guided: similar to dynamic but the size of the chunks decreases as the range
+///    is consumed, starting big to limit the overhead and finishing with chunks of
+///    `grain` iterations to balance the load.
+enum class Partitioning { Static, Dynamic, Guided };
+
+/// @brief - Execute `body(i)` for each index `i` in `[begin; end[` using the
+/// threads of the pool. The calling thread takes part to the computation and
+/// returns once all iterations are done. Exceptions raised by the body are
+/// rethrown in the calling thread.
+/// @param pool - the pool to use to run the iterations.
+/// @param begin - the first index of the range.
+/// @param end - the end of the range (excluded).
+/// @param body - the callable executed for each index.
+/// @param partitioning - how the iterations are distributed to the threads.
+/// @param grain - the minimum number of iterations processed by a task.
+template<typename Index, typename Body>
+void parallelFor(ThreadPool &pool,
+                 const Index begin,
+                 const Index end,
+                 Body &&body,
+                 const Partitioning partitioning = Partitioning::Static,
+                 const Index grain               = Index{1});
+
+/// @brief - Compute `combine(... combine(identity, reduce(identity, begin)) ...)`
+/// over the range `[begin; end[` using the threads of the pool. Each task reduces
+/// a chunk of the range with `reduce` starting from `identity` and the partial
+/// results are then combined in order with `combine`, which should therefore be
+/// associative.
+/// @param pool - the pool to use to run the computation.
+/// @param begin - the first index of the range.
+/// @param end - the end of the range (excluded).
+/// @param identity - the neutral element of `combine`.
+/// @param reduce - a callable accumulating the index `i` into `acc`, with the
+/// signature `T(T acc, Index i)`.
+/// @param combine - a callable combining two partial results.
+/// @param grain - the minimum number of iterations processed by a task.
+/// @return - the reduced value.
+template<typename Index, typename T, typename Reduce, typename Combine>
+auto parallelReduce(ThreadPool &pool,
+                    const Index begin,
+                    const Index end,
+                    T identity,
+                    Reduce &&reduce,
+                    Combine &&combine,
+                    const Index grain = Index{1}) -> T;
+
+/// @brief - Parallel version of `std::transform`: writes `op(*it)` for each
+/// element of `[first; last[` to the range starting at `out`. The chunks of the
+/// ranges are processed concurrently, so both iterators should be random access:
+/// inserters and stream iterators are not supported, and the output range should
+/// already hold as many elements as the input one.
+/// @param pool - the pool to use to run the computation.
+/// @param first - the beginning of the input range.
+/// @param last - the end of the input range.
+/// @param out - the beginning of the output range.
+/// @param op - the operation to apply to each element.
+/// @return - an iterator past the last element written.
+template<typename InputIt, typename OutputIt, typename UnaryOp>
+auto parallelTransform(ThreadPool &pool, InputIt first, InputIt last, OutputIt out, UnaryOp &&op)
+  -> OutputIt;
+
+/// @brief - Sort the range `[first; last[` with a parallel merge sort. Both
+/// halves of the range are sorted concurrently and then merged, recursively,
+/// until the ranges are small enough to be sorted sequentially.
+/// @param pool - the pool to use to run the computation.
+/// @param first - the beginning of the range to sort.
+/// @param last - the end of the range to sort.
+/// @param comp - the comparison function.
+template<typename RandomIt, typename Compare = std::less<>>
+void parallelSort(ThreadPool &pool, RandomIt first, RandomIt last, Compare comp = Compare{});
+
+} // namespace utils
+
+#include "ParallelAlgorithms.hxx"
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "ParallelAlgorithms.hh"
+#include "TaskGroup.hh"
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+namespace utils {
+namespace details {
+
+/// @brief - The number of chunks per thread used to split a range when the
+/// cost of each iteration is unknown. Having a few chunks per thread helps
+/// balancing the load without creating too many tasks.
+constexpr auto CHUNKS_PER_THREAD = 4u;
+
+/// @brief - The size under which a range is sorted sequentially.
+constexpr std::size_t MINIMUM_SORT_SIZE = 2048u;
+
+/// @brief - Execute `func(chunk)` for each chunk in `[first; last[`. The range
+/// of chunks is recursively split in halves: the upper half is handed to the
+/// group while the calling thread keeps on splitting the lower half, and the
+/// last remaining chunk is processed in place.
+template<typename Func>
+void spawnChunks(TaskGroup &group, const std::size_t first, std::size_t last, const Func &func)
+{
+  while (last - first > 1u)
+  {
+    const auto mid = first + (last - first) / 2u;
+    group.run([&group, mid, last, &func]() { spawnChunks(group, mid, last, func); });
+    last = mid;
+  }
+
+  if (first < last)
+  {
+    func(first);
+  }
+}
+
+/// @brief - Split the range `[begin; end[` in `count` chunks of similar size
+/// and execute `func(chunk, from, to)` for each of them using the pool.
+template<typename Index, typename Func>
+void forEachChunk(ThreadPool &pool,
+                  const Index begin,
+                  const Index end,
+                  const std::size_t count,
+                  const Func &func)
+{
+  const auto size = static_cast<std::size_t>(end - begin);
+  const auto at   = [&](const std::size_t chunk) {
+    return static_cast<Index>(begin + static_cast<Index>(size * chunk / count));
+  };
+
+  // The tasks reference the callable so it must outlive them.
+  const auto process = [&](const std::size_t chunk) { func(chunk, at(chunk), at(chunk + 1u)); };
+
+  TaskGroup group(pool);
+  spawnChunks(group, 0u, count, process);
+  group.wait();
+}
+
+/// @brief - The number of chunks to use to split a range of `size` elements
+/// in chunks of at least `grain` elements, with at most `perThread` chunks for
+/// each thread of the pool.
+inline auto chunksCount(const ThreadPool &pool,
+                        const std::size_t size,
+                        const std::size_t grain,
+                        const std::size_t perThread) -> std::size_t
+{
+  const auto threads = std::max<std::size_t>(pool.size(), 1u);
+  const auto byGrain = std::max<std::size_t>(size / std::max<std::size_t>(grain, 1u), 1u);
+  return std::min(byGrain, threads * perThread);
+}
+
+template<typename RandomIt, typename Compare>
+void mergeSort(ThreadPool &pool,
+               RandomIt first,
+               RandomIt last,
+               const Compare &comp,
+               const std::size_t cutoff)
+{
+  const auto size = static_cast<std::size_t>(last - first);
+  if (size <= cutoff)
+  {
+    std::sort(first, last, comp);
+    return;
+  }
+
+  const auto mid = first + size / 2u;
+
+  TaskGroup group(pool);
+  group.run([&pool, mid, last, &comp, cutoff]() { mergeSort(pool, mid, last, comp, cutoff); });
+  mergeSort(pool, first, mid, comp, cutoff);
+  group.wait();
+
+  std::inplace_merge(first, mid, last, comp);
+}
+
+} // namespace details
+
+template<typename Index, typename Body>
+inline void parallelFor(ThreadPool &pool,
+                        const Index begin,
+                        const Index end,
+                        Body &&body,
+                        const Partitioning partitioning,
+                        const Index grain)
+{
+  if (end <= begin)
+  {
+    return;
+  }
+
+  const auto size  = static_cast<std::size_t>(end - begin);
+  const auto chunk = static_cast<std::size_t>(std::max(grain, Index{1}));
+
+  if (size <= chunk)
+  {
+    for (auto id = begin; id < end; ++id)
+    {
+      body(id);
+    }
+    return;
+  }
+
+  if (partitioning == Partitioning::Static)
+  {
+    const auto count = details::chunksCount(pool, size, chunk, 1u);
+    const auto process = [&](std::size_t, const Index from, const Index to) {
+      for (auto id = from; id < to; ++id)
+      {
+        body(id);
+      }
+    };
+
+    details::forEachChunk(pool, begin, end, count, process);
+    return;
+  }
+
+  // Dynamic and guided partitioning: each task grabs chunks from a
+  // shared counter until the range is exhausted.
+  const auto threads = std::max<std::size_t>(pool.size(), 1u);
+  const auto count   = std::min(threads + 1u, (size + chunk - 1u) / chunk);
+  std::atomic<std::size_t> next{0u};
+
+  const auto nextChunkSize = [&](const std::size_t current) -> std::size_t {
+    const auto remaining = size - current;
+    if (partitioning == Partitioning::Guided)
+    {
+      return std::min(remaining, std::max(chunk, remaining / (2u * threads)));
+    }
+
+    return std::min(remaining, chunk);
+  };
+
+  const auto process = [&](std::size_t, std::size_t, std::size_t) {
+    auto current = next.load(std::memory_order_relaxed);
+    while (current < size)
+    {
+      const auto length = nextChunkSize(current);
+      if (!next.compare_exchange_weak(current, current + length, std::memory_order_relaxed))
+      {
+        continue;
+      }
+
+      const auto from = static_cast<Index>(begin + static_cast<Index>(current));
+      const auto to   = static_cast<Index>(from + static_cast<Index>(length));
+      for (auto id = from; id < to; ++id)
+      {
+        body(id);
+      }
+
+      current = next.load(std::memory_order_relaxed);
+    }
+  };
+
+  details::forEachChunk(pool, std::size_t{0u}, count, count, process);
+}
+
+template<typename Index, typename T, typename Reduce, typename Combine>
+inline auto parallelReduce(ThreadPool &pool,
+                           const Index begin,
+                           const Index end,
+                           T identity,
+                           Reduce &&reduce,
+                           Combine &&combine,
+                           const Index grain) -> T
+{
+  if (end <= begin)
+  {
+    return identity;
+  }
+
+  const auto size  = static_cast<std::size_t>(end - begin);
+  const auto count = details::chunksCount(pool,
+                                          size,
+                                          static_cast<std::size_t>(grain),
+                                          details::CHUNKS_PER_THREAD);
+
+  std::vector<T> partials(count, identity);
+  const auto process = [&](const std::size_t chunk, const Index from, const Index to) {
+    T acc = identity;
+    for (auto id = from; id < to; ++id)
+    {
+      acc = reduce(std::move(acc), id);
+    }
+
+    partials[chunk] = std::move(acc);
+  };
+
+  details::forEachChunk(pool, begin, end, count, process);
+
+  // Combine in order so that the result does not depend on the
+  // scheduling of the tasks.
+  T out = std::move(identity);
+  for (auto &partial : partials)
+  {
+    out = combine(std::move(out), std::move(partial));
+  }
+
+  return out;
+}
+
+template<typename InputIt, typename OutputIt, typename UnaryOp>
+inline auto parallelTransform(ThreadPool &pool,
+                              InputIt first,
+                              InputIt last,
+                              OutputIt out,
+                              UnaryOp &&op) -> OutputIt
+{
+  static_assert(std::is_base_of<std::random_access_iterator_tag,
+                                typename std::iterator_traits<InputIt>::iterator_category>::value,
+                "Input iterator must be random access");
+  static_assert(std::is_base_of<std::random_access_iterator_tag,
+                                typename std::iterator_traits<OutputIt>::iterator_category>::value,
+                "Output iterator must be random access");
+
+  const auto size = static_cast<std::size_t>(std::distance(first, last));
+  if (size == 0u)
+  {
+    return out;
+  }
+
+  const auto count = details::chunksCount(pool, size, 1u, details::CHUNKS_PER_THREAD);
+  const auto process = [&](std::size_t, const std::size_t from, const std::size_t to) {
+    std::transform(std::next(first, from), std::next(first, to), std::next(out, from), op);
+  };
+
+  details::forEachChunk(pool, std::size_t{0u}, size, count, process);
+
+  return std::next(out, size);
+}
+
+template<typename RandomIt, typename Compare>
+inline void parallelSort(ThreadPool &pool, RandomIt first, RandomIt last, Compare comp)
+{
+  const auto size    = static_cast<std::size_t>(last - first);
+  const auto threads = std::max<std::size_t>(pool.size(), 1u);
+  const auto cutoff  = std::max(details::MINIMUM_SORT_SIZE,
+                               size / (threads * details::CHUNKS_PER_THREAD));
+
+  details::mergeSort(pool, first, last, comp, cutoff);
+}
+
+} // namespace utils
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <chrono>
+
+namespace utils {
+
+/// @brief - Defines the number of threads of an elastic pool. The pool starts
+/// with `minThreads` threads and creates new ones, up to `maxThreads`, when jobs
+/// keep on waiting in the queues while all the threads are busy. Threads idle
+/// for longer than `idleTimeout` are terminated as long as there are more than
+/// `minThreads` of them. A pool with the same minimum and maximum has a fixed
+/// size.
+struct PoolSizing
+{
+  unsigned minThreads{1u};
+  unsigned maxThreads{1u};
+  std::chrono::milliseconds idleTimeout{1000};
+};
+
+} // namespace utils
@@ -0,0 +1,128 @@
+#include "RansCoder.hh"
+#include "CoreException.hh"
+#include <algorithm>
+#include <numeric>
+
+namespace utils {
+namespace {
+/// @brief - The number of bits used to save the size of the alphabet and the
+/// frequency of a symbol.
+constexpr auto SIZE_BITS      = 16u;
+constexpr auto FREQUENCY_BITS = RansCoder::PROBABILITY_BITS + 1u;
+
+constexpr auto TOTAL = 1u << RansCoder::PROBABILITY_BITS;
+
+auto error(const std::string &message, const std::string &cause) -> CoreException
+{
+  return CoreException(message, "rans", "binary", cause);
+}
+} // namespace
+
+RansCoder::RansCoder(const std::vector<std::uint64_t> &frequencies)
+{
+  if (frequencies.size() > MAX_ALPHABET_SIZE)
+  {
+    throw error("Failed to create rANS coder",
+                "Alphabet has " + std::to_string(frequencies.size()) + " symbols");
+  }
+
+  const auto used = std::count_if(frequencies.begin(), frequencies.end(), [](const auto f) {
+    return f > 0u;
+  });
+  if (used == 0 || used > TOTAL)
+  {
+    throw error("Failed to create rANS coder",
+                "Invalid number of used symbols " + std::to_string(used));
+  }
+
+  // Scale the frequencies so that they sum to `TOTAL`, making sure that
+  // no used symbol ends up with a frequency of `0`.
+  const auto sum = std::accumulate(frequencies.begin(), frequencies.end(), 0.0);
+  m_frequencies.assign(frequencies.size(), 0u);
+
+  auto total = 0;
+  for (unsigned symbol = 0u; symbol < frequencies.size(); ++symbol)
+  {
+    if (frequencies[symbol] > 0u)
+    {
+      const auto scaled     = static_cast<double>(frequencies[symbol]) * TOTAL / sum;
+      m_frequencies[symbol] = static_cast<std::uint16_t>(std::max(1.0, scaled + 0.5));
+      total += m_frequencies[symbol];
+    }
+  }
+
+  // Fix the rounding errors on the most frequent symbols, where they
+  // have the least impact.
+  std::vector<unsigned> order(frequencies.size());
+  std::iota(order.begin(), order.end(), 0u);
+  std::sort(order.begin(), order.end(), [this](const unsigned lhs, const unsigned rhs) {
+    return m_frequencies[lhs] > m_frequencies[rhs];
+  });
+
+  if (total < static_cast<int>(TOTAL))
+  {
+    m_frequencies[order.front()] += static_cast<std::uint16_t>(TOTAL - total);
+  }
+
+  while (total > static_cast<int>(TOTAL))
+  {
+    for (auto it = order.begin(); it != order.end() && total > static_cast<int>(TOTAL); ++it)
+    {
+      if (m_frequencies[*it] > 1u)
+      {
+        --m_frequencies[*it];
+        --total;
+      }
+    }
+  }
+
+  build();
+}
+
+void RansCoder::save(BitWriter &out) const noexcept
+{
+  out.push(m_frequencies.size() - 1u, SIZE_BITS);
+  for (const auto frequency : m_frequencies)
+  {
+    out.push(frequency, FREQUENCY_BITS);
+  }
+}
+
+auto RansCoder::load(BitReader &in) -> RansCoder
+{
+  RansCoder out;
+
+  out.m_frequencies.resize(in.read(SIZE_BITS) + 1u);
+  for (auto &frequency : out.m_frequencies)
+  {
+    frequency = static_cast<std::uint16_t>(in.read(FREQUENCY_BITS));
+  }
+
+  const auto total = std::accumulate(out.m_frequencies.begin(), out.m_frequencies.end(), 0u);
+  if (total != TOTAL)
+  {
+    throw error("Failed to load rANS coder",
+                "Frequencies sum to " + std::to_string(total) + " instead of "
+                  + std::to_string(TOTAL));
+  }
+
+  out.build();
+
+  return out;
+}
+
+void RansCoder::build()
+{
+  m_cumulative.assign(m_frequencies.size(), 0u);
+  m_slots.assign(TOTAL, 0u);
+
+  auto start = 0u;
+  for (unsigned symbol = 0u; symbol < m_frequencies.size(); ++symbol)
+  {
+    m_cumulative[symbol] = static_cast<std::uint16_t>(start);
+    std::fill_n(m_slots.begin() + start, m_frequencies[symbol], static_cast<std::uint16_t>(symbol));
+    start += m_frequencies[symbol];
+  }
+}
+
+} // namespace utils
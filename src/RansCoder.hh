@@ -0,0 +1,87 @@
+#pragma once
+
+#include "BitReader.hh"
+#include "BitWriter.hh"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace utils {
+
+/// @brief - A range asymmetric numeral systems (rANS) coder over the symbols
+/// `[0; size)`. The probability of each symbol is quantized to a multiple of
+/// `2^-PROBABILITY_BITS`. The coder holds its state in 32 bits and exchanges
+/// whole bytes with the stream. Decoding uses a table giving the symbol for
+/// each of the `2^PROBABILITY_BITS` slots. Symbols are encoded in reverse order
+/// so that they're decoded in order, hence the encoder works on whole blocks
+/// of symbols.
+class RansCoder
+{
+  public:
+  /// @brief - The precision of the probabilities of the symbols.
+  static constexpr auto PROBABILITY_BITS = 12u;
+
+  /// @brief - The maximum number of symbols in the alphabet.
+  static constexpr auto MAX_ALPHABET_SIZE = 65536u;
+
+  /// @brief - Build the coder for a message where each symbol appears with the
+  /// input frequency. Symbols with a frequency of `0` can't be encoded. An error
+  /// is raised in case no symbol has a positive frequency or in case there are
+  /// more than `2^PROBABILITY_BITS` of them.
+  /// @param frequencies - the frequency of each symbol.
+  explicit RansCoder(const std::vector<std::uint64_t> &frequencies);
+
+  /// @brief - The number of symbols in the alphabet.
+  auto size() const noexcept -> unsigned;
+
+  /// @brief - The quantized frequency of a symbol: its probability is this value
+  /// divided by `2^PROBABILITY_BITS`.
+  auto frequency(const unsigned symbol) const noexcept -> unsigned;
+
+  /// @brief - Encode a block of symbols. All of them should have a positive
+  /// frequency.
+  /// @param symbols - the symbols to encode.
+  /// @param out - the writer to write the encoded symbols to.
+  template<typename Symbol>
+  void encode(std::span<const Symbol> symbols, BitWriter &out) const;
+
+  /// @brief - Decode a block of symbols written by `encode`. The number of
+  /// symbols to decode is given by the size of the output.
+  /// @param in - the reader to read the encoded symbols from.
+  /// @param symbols - the decoded symbols.
+  template<typename Symbol>
+  void decode(BitReader &in, std::span<Symbol> symbols) const noexcept;
+
+  /// @brief - Write the quantized frequencies, so that the coder can be created
+  /// again with `load`.
+  /// @param out - the writer to write the frequencies to.
+  void save(BitWriter &out) const noexcept;
+
+  /// @brief - Read the frequencies written by `save`. An error is raised in case
+  /// they are not valid.
+  /// @param in - the reader to read the frequencies from.
+  /// @return - the created coder.
+  static auto load(BitReader &in) -> RansCoder;
+
+  private:
+  RansCoder() = default;
+
+  /// @brief - Compute the cumulative frequencies and the decoding table from
+  /// the quantized frequencies.
+  void build();
+
+  /// @brief - The lower bound of the state of the coder: it is kept in the
+  /// range `[LOWER_BOUND; 256 * LOWER_BOUND)`.
+  static constexpr std::uint32_t LOWER_BOUND = 1u << 23u;
+
+  private:
+  std::vector<std::uint16_t> m_frequencies{};
+  std::vector<std::uint16_t> m_cumulative{};
+
+  /// @brief - The symbol matching each slot.
+  std::vector<std::uint16_t> m_slots{};
+};
+
+} // namespace utils
+
+#include "RansCoder.hxx"
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "RansCoder.hh"
+
+namespace utils {
+
+inline auto RansCoder::size() const noexcept -> unsigned
+{
+  return static_cast<unsigned>(m_frequencies.size());
+}
+
+inline auto RansCoder::frequency(const unsigned symbol) const noexcept -> unsigned
+{
+  return m_frequencies[symbol];
+}
+
+template<typename Symbol>
+inline void RansCoder::encode(std::span<const Symbol> symbols, BitWriter &out) const
+{
+  // The bytes are produced from the last symbol to the first one and
+  // written in the reverse order, after the final state.
+  std::vector<unsigned char> bytes;
+  bytes.reserve(symbols.size() / 2u + 4u);
+
+  std::uint32_t state = LOWER_BOUND;
+  for (auto it = symbols.rbegin(); it != symbols.rend(); ++it)
+  {
+    const auto symbol    = static_cast<unsigned>(*it);
+    const auto frequency = std::uint32_t{m_frequencies[symbol]};
+
+    const auto max = ((LOWER_BOUND >> PROBABILITY_BITS) << 8u) * frequency;
+    while (state >= max)
+    {
+      bytes.push_back(static_cast<unsigned char>(state & 0xFFu));
+      state >>= 8u;
+    }
+
+    state = ((state / frequency) << PROBABILITY_BITS) + state % frequency
+            + m_cumulative[symbol];
+  }
+
+  out.push(state, 32u);
+  for (auto it = bytes.rbegin(); it != bytes.rend(); ++it)
+  {
+    out.push(*it, 8u);
+  }
+}
+
+template<typename Symbol>
+inline void RansCoder::decode(BitReader &in, std::span<Symbol> symbols) const noexcept
+{
+  constexpr auto MASK = (1u << PROBABILITY_BITS) - 1u;
+
+  auto state = static_cast<std::uint32_t>(in.read(32u));
+  for (auto &out : symbols)
+  {
+    const auto slot   = state & MASK;
+    const auto symbol = m_slots[slot];
+
+    state = m_frequencies[symbol] * (state >> PROBABILITY_BITS) + slot - m_cumulative[symbol];
+    while (state < LOWER_BOUND)
+    {
+      state = (state << 8u) | static_cast<std::uint32_t>(in.read(8u));
+    }
+
+    out = static_cast<Symbol>(symbol);
+  }
+}
+
+} // namespace utils
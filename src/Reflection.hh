@@ -0,0 +1,130 @@
+#pragma once
+
+#include "SerializationUtils.hh"
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+namespace utils {
+
+/// @brief - The list of the fields of a type, used to serialize it with the
+/// archives without writing a `serialize` and a `deserialize` function. The
+/// list is a tuple of pointers to the data members to serialize, in the order
+/// in which they're written. It is taken from a static `fields` member of the
+/// type if it has one, as in:
+///
+///   struct Point
+///   {
+///     float x;
+///     float y;
+///     static constexpr auto fields = std::make_tuple(&Point::x, &Point::y);
+///   };
+///
+/// Types which can't be modified can specialize this trait instead and define
+/// a static `list` member.
+template<typename T, typename = void>
+struct Fields
+{};
+
+template<typename T>
+struct Fields<T, std::void_t<decltype(T::fields)>>
+{
+  static constexpr auto list = T::fields;
+};
+
+/// @brief - The version of the layout of a type, written in front of its value
+/// when it is framed, see `Framed`. It is taken from a static `version` member
+/// of the type if it has one, and is 0 otherwise.
+template<typename T, typename = void>
+struct Version
+{
+  static constexpr std::uint32_t value = 0u;
+};
+
+template<typename T>
+struct Version<T, std::void_t<decltype(T::version)>>
+{
+  static constexpr std::uint32_t value = T::version;
+};
+
+/// @brief - Wrapper writing a value as a record when passed to `serialize` or
+/// `deserialize` with an archive, see `framed`. A record holds the length of
+/// the value and the version of its type, so that readers can skip the fields
+/// they don't know of without decoding them. For structures defining a list of
+/// fields, fields can be appended to the list: old readers skip them and new
+/// readers reading old records leave them to their default value.
+template<typename T>
+struct Framed
+{
+  T &value;
+};
+
+/// @brief - Write a value as a record for a single call to `serialize` or
+/// `deserialize`, as in `serialize(out, framed(header))`.
+/// @param value - the value to write or read.
+/// @return - the wrapper around the value.
+template<typename T>
+auto framed(T &value) noexcept -> Framed<T>;
+
+namespace details {
+/// @brief - Whether a list of fields is defined for the type.
+template<typename T, typename = void>
+struct IsReflected : std::false_type
+{};
+
+template<typename T>
+struct IsReflected<T, std::void_t<decltype(Fields<T>::list)>> : std::true_type
+{};
+
+template<typename T>
+struct IsStdArray : std::false_type
+{};
+
+template<typename T, std::size_t N>
+struct IsStdArray<std::array<T, N>> : std::true_type
+{};
+
+/// @brief - The type of the field pointed to by a pointer to data member.
+template<typename T, typename Member>
+using FieldType = std::remove_cvref_t<decltype(std::declval<T &>().*std::declval<Member>())>;
+
+/// @brief - Whether the bytes of a value of type `T` in memory are the bytes
+/// written by an archive using the fixed encoding, assuming that the fields
+/// of the type are packed in the order of the list of fields.
+template<typename T>
+constexpr bool isRawType();
+
+/// @brief - Whether some of the bytes of a value of type `T` are written
+/// differently by archives using the varint encoding.
+template<typename T>
+constexpr bool hasVarintFields();
+
+/// @brief - Whether the fields of the type are laid out in memory in the order
+/// of the list of fields without any padding. Checked once for each type.
+template<typename T>
+bool hasPackedLayout();
+
+/// @brief - Whether values of type `T` always take `sizeof(T)` bytes once
+/// encoded, whatever their byte order, so that they can be skipped at once.
+/// @param encoding - the encoding of the archive.
+template<typename T>
+bool hasFixedSize(const IntegerEncoding encoding);
+
+/// @brief - Whether values of type `T`, or arrays of them, can be written and
+/// read by copying their bytes as they are in memory.
+/// @param encoding - the encoding of the archive.
+template<typename T>
+bool isBulkSerializable(const IntegerEncoding encoding);
+} // namespace details
+
+/// @brief - Call the input function on each field of the object, in the order
+/// of the list of fields of its type.
+/// @param object - the object to visit.
+/// @param func - the function called with a reference to each field.
+template<typename T, typename Func>
+void forEachField(T &object, Func &&func);
+
+} // namespace utils
+
+#include "Reflection.hxx"
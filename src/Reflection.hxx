@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Reflection.hh"
+
+namespace utils {
+
+template<typename T>
+inline auto framed(T &value) noexcept -> Framed<T>
+{
+  return Framed<T>{value};
+}
+
+template<typename T, typename Func>
+inline void forEachField(T &object, Func &&func)
+{
+  std::apply([&object, &func](const auto... members) { (func(object.*members), ...); },
+             Fields<std::remove_const_t<T>>::list);
+}
+
+namespace details {
+
+template<typename T>
+constexpr bool isRawType()
+{
+  if constexpr (std::is_arithmetic<T>::value || std::is_enum<T>::value)
+  {
+    return true;
+  }
+  else if constexpr (IsStdArray<T>::value)
+  {
+    return isRawType<typename T::value_type>();
+  }
+  else if constexpr (IsReflected<T>::value)
+  {
+    // All the bytes of the type should belong to a field.
+    const auto raw = [](const auto... members) {
+      const auto size = (sizeof(FieldType<T, decltype(members)>) + ... + 0u);
+      return (isRawType<FieldType<T, decltype(members)>>() && ...) && size == sizeof(T);
+    };
+
+    return std::is_trivially_copyable<T>::value && std::apply(raw, Fields<T>::list);
+  }
+  else
+  {
+    return false;
+  }
+}
+
+template<typename T>
+constexpr bool hasVarintFields()
+{
+  if constexpr (IsStdArray<T>::value)
+  {
+    return hasVarintFields<typename T::value_type>();
+  }
+  else if constexpr (IsReflected<T>::value)
+  {
+    return std::apply(
+      [](const auto... members) {
+        return (hasVarintFields<FieldType<T, decltype(members)>>() || ...);
+      },
+      Fields<T>::list);
+  }
+  else
+  {
+    return isVarintCandidate<T>();
+  }
+}
+
+template<typename T>
+inline bool hasPackedLayout()
+{
+  if constexpr (IsStdArray<T>::value)
+  {
+    return hasPackedLayout<typename T::value_type>();
+  }
+  else if constexpr (IsReflected<T>::value)
+  {
+    // The offsets of the fields can't be computed at compile time.
+    static const bool packed = [] {
+      const T object{};
+      const auto *base = reinterpret_cast<const unsigned char *>(&object);
+
+      auto offset = std::size_t{0u};
+      auto out    = true;
+      forEachField(object, [&](const auto &field) {
+        using Field = std::remove_cvref_t<decltype(field)>;
+
+        const auto *address = reinterpret_cast<const unsigned char *>(&field);
+        out    = out && address == base + offset && hasPackedLayout<Field>();
+        offset += sizeof(field);
+      });
+
+      return out;
+    }();
+
+    return packed;
+  }
+  else
+  {
+    return true;
+  }
+}
+
+template<typename T>
+inline bool hasFixedSize(const IntegerEncoding encoding)
+{
+  if constexpr (isRawType<T>())
+  {
+    if (hasVarintFields<T>() && encoding == IntegerEncoding::Varint)
+    {
+      return false;
+    }
+
+    return hasPackedLayout<T>();
+  }
+  else
+  {
+    return false;
+  }
+}
+
+template<typename T>
+inline bool isBulkSerializable(const IntegerEncoding encoding)
+{
+  // Values are swapped one by one on big endian hosts.
+  if constexpr (std::endian::native != std::endian::little)
+  {
+    if (encoding == IntegerEncoding::Portable)
+    {
+      return false;
+    }
+  }
+
+  return hasFixedSize<T>(encoding);
+}
+
+} // namespace details
+
+} // namespace utils
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace utils {
+
+/// @brief - A double-ended queue storing its elements in a contiguous circular
+/// buffer. The capacity is a power of two and doubles when the buffer is full,
+/// so that pushing and popping at both ends don't allocate once the buffer is
+/// large enough. This class is not thread-safe.
+/// Elements are default constructed in the buffer: popping an element moves it
+/// out and leaves a moved-from value in the slot.
+template<typename T>
+class RingBuffer
+{
+  public:
+  /// @brief - Create a buffer able to hold at least `capacity` elements without
+  /// growing.
+  /// @param capacity - the initial capacity of the buffer.
+  RingBuffer(const std::size_t capacity = 0u);
+
+  ~RingBuffer() = default;
+
+  RingBuffer(const RingBuffer &) = delete;
+  RingBuffer &operator=(const RingBuffer &) = delete;
+
+  RingBuffer(RingBuffer &&rhs) noexcept = default;
+  RingBuffer &operator=(RingBuffer &&rhs) noexcept = default;
+
+  /// @brief - Make sure that the buffer can hold at least `capacity` elements
+  /// without growing.
+  /// @param capacity - the minimum capacity of the buffer.
+  void reserve(const std::size_t capacity);
+
+  /// @brief - Insert an element at the end of the buffer.
+  /// @param item - the element to insert.
+  void pushBack(T &&item);
+
+  /// @brief - Remove the last element of the buffer. Undefined behavior in case
+  /// the buffer is empty.
+  /// @return - the removed element.
+  auto popBack() -> T;
+
+  /// @brief - Remove the first element of the buffer. Undefined behavior in case
+  /// the buffer is empty.
+  /// @return - the removed element.
+  auto popFront() -> T;
+
+  /// @brief - Access the element at the input position, starting from the front
+  /// of the buffer.
+  /// @param id - the position of the element.
+  /// @return - the element at this position.
+  auto operator[](const std::size_t id) noexcept -> T &;
+  auto operator[](const std::size_t id) const noexcept -> const T &;
+
+  /// @brief - Remove all the elements of the buffer. The capacity is kept.
+  void clear();
+
+  auto size() const noexcept -> std::size_t;
+
+  bool empty() const noexcept;
+
+  auto capacity() const noexcept -> std::size_t;
+
+  private:
+  /// @brief - Reallocate the buffer with at least the input capacity and move
+  /// the elements to the new storage.
+  /// @param capacity - the minimum capacity of the new buffer.
+  void grow(const std::size_t capacity);
+
+  private:
+  std::unique_ptr<T[]> m_items;
+  std::size_t m_mask;
+
+  /// @brief - The position of the first element in the buffer.
+  std::size_t m_head;
+  std::size_t m_size;
+};
+
+} // namespace utils
+
+#include "RingBuffer.hxx"
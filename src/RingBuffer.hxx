@@ -0,0 +1,122 @@
+#pragma once
+
+#include "RingBuffer.hh"
+#include <utility>
+
+namespace utils {
+
+template<typename T>
+inline RingBuffer<T>::RingBuffer(const std::size_t capacity)
+  : m_items()
+  , m_mask(0u)
+  , m_head(0u)
+  , m_size(0u)
+{
+  if (capacity > 0u)
+  {
+    grow(capacity);
+  }
+}
+
+template<typename T>
+inline void RingBuffer<T>::reserve(const std::size_t capacity)
+{
+  if (capacity > this->capacity())
+  {
+    grow(capacity);
+  }
+}
+
+template<typename T>
+inline void RingBuffer<T>::pushBack(T &&item)
+{
+  if (m_size == capacity())
+  {
+    grow(m_size + 1u);
+  }
+
+  m_items[(m_head + m_size) & m_mask] = std::move(item);
+  ++m_size;
+}
+
+template<typename T>
+inline auto RingBuffer<T>::popBack() -> T
+{
+  --m_size;
+  return std::move(m_items[(m_head + m_size) & m_mask]);
+}
+
+template<typename T>
+inline auto RingBuffer<T>::popFront() -> T
+{
+  T out  = std::move(m_items[m_head]);
+  m_head = (m_head + 1u) & m_mask;
+  --m_size;
+
+  return out;
+}
+
+template<typename T>
+inline auto RingBuffer<T>::operator[](const std::size_t id) noexcept -> T &
+{
+  return m_items[(m_head + id) & m_mask];
+}
+
+template<typename T>
+inline auto RingBuffer<T>::operator[](const std::size_t id) const noexcept -> const T &
+{
+  return m_items[(m_head + id) & m_mask];
+}
+
+template<typename T>
+inline void RingBuffer<T>::clear()
+{
+  // Release the resources held by the elements.
+  for (std::size_t id = 0u; id < m_size; ++id)
+  {
+    (*this)[id] = T{};
+  }
+
+  m_head = 0u;
+  m_size = 0u;
+}
+
+template<typename T>
+inline auto RingBuffer<T>::size() const noexcept -> std::size_t
+{
+  return m_size;
+}
+
+template<typename T>
+inline bool RingBuffer<T>::empty() const noexcept
+{
+  return m_size == 0u;
+}
+
+template<typename T>
+inline auto RingBuffer<T>::capacity() const noexcept -> std::size_t
+{
+  return m_items == nullptr ? 0u : m_mask + 1u;
+}
+
+template<typename T>
+inline void RingBuffer<T>::grow(const std::size_t capacity)
+{
+  std::size_t cap = 2u;
+  while (cap < capacity)
+  {
+    cap <<= 1;
+  }
+
+  auto items = std::make_unique<T[]>(cap);
+  for (std::size_t id = 0u; id < m_size; ++id)
+  {
+    items[id] = std::move((*this)[id]);
+  }
+
+  m_items = std::move(items);
+  m_mask  = cap - 1u;
+  m_head  = 0u;
+}
+
+} // namespace utils
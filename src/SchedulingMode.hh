@@ -0,0 +1,20 @@
+#pragma once
+
+namespace utils {
+
+/// @brief - Defines how the threads of a pool fetch the jobs to process. In the
+/// shared queue mode all the threads pull jobs from the same queues protected by
+/// a mutex. In the work stealing mode each thread owns a local queue and steals
+/// jobs from its peers when it runs out of work.
+enum class SchedulingMode { SharedQueue, WorkStealing };
+
+/// @brief - Defines the order in which the jobs of a given priority are fetched
+/// from the queues of a pool:
+///  - lifo: the most recently enqueued job is processed first. Favors the cache
+///    but the oldest jobs might wait for a long time under load.
+///  - fifo: jobs are processed in the order of their submission.
+///  - deadline: the job with the earliest deadline is processed first. Jobs
+///    without any deadline come after the others in the order of submission.
+enum class JobOrdering { Lifo, Fifo, Deadline };
+
+} // namespace utils
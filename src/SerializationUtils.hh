@@ -1,9 +1,12 @@
 
 #pragma once
 
+#include <bit>
+#include <cstdint>
 #include <istream>
 #include <optional>
 #include <ostream>
+#include <string>
 #include <type_traits>
 
 namespace utils {
@@ -14,6 +17,8 @@ namespace utils {
 template<typename T, std::enable_if_t<std::is_enum<T>::value, bool> = true>
 auto serialize(std::ostream &out, const T &e) -> std::ostream &;
 
+/// @brief - Values are written as they are in memory: only trivially copyable
+/// types are accepted. See `portable` to share the data between platforms.
 template<typename T, std::enable_if_t<!std::is_enum<T>::value, bool> = true>
 auto serialize(std::ostream &out, const T &e) -> std::ostream &;
 
@@ -39,6 +44,139 @@ bool deserialize(std::istream &in, std::optional<T> &value);
 template<typename T, std::enable_if_t<!std::is_enum<T>::value, bool> = true>
 bool deserialize(std::istream &in, std::optional<T> &value);
 
+/// @brief - How the integers and the lengths of strings and containers are
+/// written by an archive: either with their size in memory or as varints. The
+/// portable encoding writes them with a fixed width as well, but always in
+/// little endian, so that the data doesn't depend on the host. This costs
+/// nothing on little endian hosts.
+enum class IntegerEncoding
+{
+  Fixed,
+  Varint,
+  Portable
+};
+
+/// @brief - The maximum number of bytes of a 64-bit integer encoded as a varint.
+constexpr auto MAX_VARINT_BYTES = 10u;
+
+/// @brief - Map signed integers to unsigned ones so that values close to `0`
+/// get small codes: `0, -1, 1, -2, ...` become `0, 1, 2, 3, ...`.
+/// @param value - the value to encode.
+/// @return - the encoded value.
+constexpr auto zigzagEncode(const std::int64_t value) noexcept -> std::uint64_t;
+
+/// @brief - Reverse operation of `zigzagEncode`.
+/// @param value - the value to decode.
+/// @return - the decoded value.
+constexpr auto zigzagDecode(const std::uint64_t value) noexcept -> std::int64_t;
+
+/// @brief - Convert an arithmetic value from the byte order of the host to
+/// little endian. Nothing is done on little endian hosts.
+/// @param value - the value to convert.
+/// @return - the converted value.
+template<typename T>
+constexpr auto toLittleEndian(const T value) noexcept -> T;
+
+/// @brief - Reverse operation of `toLittleEndian`.
+/// @param value - the value to convert.
+/// @return - the converted value.
+template<typename T>
+constexpr auto fromLittleEndian(const T value) noexcept -> T;
+
+/// @brief - Encode the input value as a LEB128 varint: 7 bits per byte starting
+/// with the least significant ones, the most significant bit of each byte being
+/// set when more bytes follow.
+/// @param value - the value to encode.
+/// @param out - the buffer receiving the bytes, at least `MAX_VARINT_BYTES` long.
+/// @return - the number of bytes written.
+auto encodeVarint(std::uint64_t value, unsigned char *out) noexcept -> unsigned;
+
+/// @brief - Decode a LEB128 varint from the input buffer.
+/// @param data - the bytes to decode, moved after the varint in case of success.
+/// @param end - the end of the buffer.
+/// @param value - the decoded value.
+/// @return - `false` in case the buffer is over before the end of the varint or
+/// in case the varint doesn't fit in 64 bits.
+bool decodeVarint(const unsigned char *&data,
+                  const unsigned char *end,
+                  std::uint64_t &value) noexcept;
+
+/// @brief - Wrapper selecting the varint encoding for an integer when passed to
+/// `serialize` or `deserialize`, see `varint`. Unsigned integers are written as
+/// LEB128 varints and signed integers are first zigzag encoded.
+template<typename T>
+struct Varint
+{
+  static_assert(std::is_integral<T>::value && !std::is_same<std::remove_const_t<T>, bool>::value,
+                "Only integers can be encoded as varints");
+
+  T &value;
+};
+
+/// @brief - Wrapper selecting a varint for the length of a string or a vector
+/// when passed to `serialize` or `deserialize`, see `compact`. The elements of
+/// vectors are serialized as usual.
+template<typename T>
+struct Compact
+{
+  T &value;
+};
+
+/// @brief - Wrapper writing a value in a format independent of the host when
+/// passed to `serialize` or `deserialize` with a stream, see `portable`. Values
+/// are written with a fixed width in little endian, and the length of strings
+/// as a 64-bit integer. Types without a portable layout are rejected.
+template<typename T>
+struct Portable
+{
+  static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value
+                  || std::is_same<std::remove_const_t<T>, std::string>::value,
+                "Only arithmetic types, enumerations and strings can be written portably");
+  static_assert(!std::is_floating_point<T>::value || sizeof(T) <= sizeof(double),
+                "Extended floating point types have no portable layout");
+
+  T &value;
+};
+
+/// @brief - Select the varint encoding for a single call to `serialize` or
+/// `deserialize`, as in `serialize(out, varint(count))`.
+/// @param value - the integer to encode or decode.
+/// @return - the wrapper.
+template<typename T>
+auto varint(T &value) noexcept -> Varint<T>;
+
+/// @brief - Select a varint length prefix for a single call to `serialize` or
+/// `deserialize`, as in `deserialize(in, compact(name))`.
+/// @param value - the string or vector to encode or decode.
+/// @return - the wrapper.
+template<typename T>
+auto compact(T &value) noexcept -> Compact<T>;
+
+/// @brief - Select the portable format for a single call to `serialize` or
+/// `deserialize`, as in `serialize(out, portable(timestamp))`.
+/// @param value - the value to encode or decode.
+/// @return - the wrapper.
+template<typename T>
+auto portable(T &value) noexcept -> Portable<T>;
+
+template<typename T>
+auto serialize(std::ostream &out, const Varint<T> &value) -> std::ostream &;
+
+template<typename T>
+bool deserialize(std::istream &in, Varint<T> value);
+
+template<typename T>
+auto serialize(std::ostream &out, const Compact<T> &value) -> std::ostream &;
+
+template<typename T>
+bool deserialize(std::istream &in, Compact<T> value);
+
+template<typename T>
+auto serialize(std::ostream &out, const Portable<T> &value) -> std::ostream &;
+
+template<typename T>
+bool deserialize(std::istream &in, Portable<T> value);
+
 } // namespace utils
 
 #include "SerializationUtils.hxx"
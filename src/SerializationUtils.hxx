@@ -2,10 +2,14 @@
 #pragma once
 
 #include "SerializationUtils.hh"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
 
 namespace utils {
 
-template<typename T, std::enable_if_t<std::is_enum<T>::value, bool> = true>
+template<typename T, std::enable_if_t<std::is_enum<T>::value, bool>>
 inline auto serialize(std::ostream &out, const T &e) -> std::ostream &
 {
   const auto eAsChar = reinterpret_cast<const char *>(&e);
@@ -15,9 +19,12 @@ inline auto serialize(std::ostream &out, const T &e) -> std::ostream &
   return out;
 }
 
-template<typename T, std::enable_if_t<!std::is_enum<T>::value, bool> = true>
+template<typename T, std::enable_if_t<!std::is_enum<T>::value, bool>>
 inline auto serialize(std::ostream &out, const T &value) -> std::ostream &
 {
+  static_assert(std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value,
+                "Only values without indirections can be written as they are in memory");
+
   const auto valueAsChar = reinterpret_cast<const char *>(&value);
   const auto size        = sizeof(T);
   out.write(valueAsChar, size);
@@ -25,7 +32,7 @@ inline auto serialize(std::ostream &out, const T &value) -> std::ostream &
   return out;
 }
 
-template<typename T, std::enable_if_t<std::is_enum<T>::value, bool> = true>
+template<typename T, std::enable_if_t<std::is_enum<T>::value, bool>>
 inline bool deserialize(std::istream &in, T &e)
 {
   const auto eAsChar = reinterpret_cast<char *>(&e);
@@ -35,9 +42,12 @@ inline bool deserialize(std::istream &in, T &e)
   return in.good();
 }
 
-template<typename T, std::enable_if_t<!std::is_enum<T>::value, bool> = true>
+template<typename T, std::enable_if_t<!std::is_enum<T>::value, bool>>
 inline bool deserialize(std::istream &in, T &value)
 {
+  static_assert(std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value,
+                "Only values without indirections can be read as they are in memory");
+
   const auto valueAsChar = reinterpret_cast<char *>(&value);
   const auto size        = sizeof(T);
   in.read(valueAsChar, size);
@@ -67,7 +77,7 @@ inline bool deserialize(std::istream &in, std::string &str)
   return in.good();
 }
 
-template<typename T, std::enable_if_t<std::is_enum<T>::value, bool> = true>
+template<typename T, std::enable_if_t<std::is_enum<T>::value, bool>>
 inline auto serialize(std::ostream &out, const std::optional<T> &value) -> std::ostream &
 {
   const auto hasValue = value.has_value();
@@ -80,7 +90,7 @@ inline auto serialize(std::ostream &out, const std::optional<T> &value) -> std::
   return out;
 }
 
-template<typename T, std::enable_if_t<!std::is_enum<T>::value, bool> = true>
+template<typename T, std::enable_if_t<!std::is_enum<T>::value, bool>>
 inline auto serialize(std::ostream &out, const std::optional<T> &value) -> std::ostream &
 {
   const auto hasValue = value.has_value();
@@ -93,7 +103,7 @@ inline auto serialize(std::ostream &out, const std::optional<T> &value) -> std::
   return out;
 }
 
-template<typename T, std::enable_if_t<std::is_enum<T>::value, bool> = true>
+template<typename T, std::enable_if_t<std::is_enum<T>::value, bool>>
 inline bool deserialize(std::istream &in, std::optional<T> &value)
 {
   bool hasValue{false};
@@ -112,7 +122,7 @@ inline bool deserialize(std::istream &in, std::optional<T> &value)
   return in.good();
 }
 
-template<typename T, std::enable_if_t<!std::is_enum<T>::value, bool> = true>
+template<typename T, std::enable_if_t<!std::is_enum<T>::value, bool>>
 inline bool deserialize(std::istream &in, std::optional<T> &value)
 {
   bool hasValue{false};
@@ -131,4 +141,313 @@ inline bool deserialize(std::istream &in, std::optional<T> &value)
   return in.good();
 }
 
+constexpr auto zigzagEncode(const std::int64_t value) noexcept -> std::uint64_t
+{
+  return (static_cast<std::uint64_t>(value) << 1u) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+constexpr auto zigzagDecode(const std::uint64_t value) noexcept -> std::int64_t
+{
+  return static_cast<std::int64_t>((value >> 1u) ^ (~(value & 1u) + 1u));
+}
+
+template<typename T>
+constexpr auto toLittleEndian(const T value) noexcept -> T
+{
+  static_assert(std::is_arithmetic<T>::value, "Only arithmetic values can be converted");
+
+  if constexpr (std::endian::native == std::endian::little || sizeof(T) == 1u)
+  {
+    return value;
+  }
+  else
+  {
+    auto bytes = std::bit_cast<std::array<unsigned char, sizeof(T)>>(value);
+    std::reverse(bytes.begin(), bytes.end());
+    return std::bit_cast<T>(bytes);
+  }
+}
+
+template<typename T>
+constexpr auto fromLittleEndian(const T value) noexcept -> T
+{
+  // Swapping the bytes is its own inverse.
+  return toLittleEndian(value);
+}
+
+inline auto encodeVarint(std::uint64_t value, unsigned char *out) noexcept -> unsigned
+{
+  auto count = 0u;
+  while (value >= 0x80u)
+  {
+    out[count] = static_cast<unsigned char>(value | 0x80u);
+    value >>= 7u;
+    ++count;
+  }
+
+  out[count] = static_cast<unsigned char>(value);
+  return count + 1u;
+}
+
+inline bool decodeVarint(const unsigned char *&data,
+                         const unsigned char *end,
+                         std::uint64_t &value) noexcept
+{
+  std::uint64_t out{0u};
+  auto shift = 0u;
+
+  for (auto it = data; it != end; ++it)
+  {
+    // The last byte of a 64-bit value only holds a single bit.
+    const std::uint64_t byte = *it;
+    if (shift == 63u && byte > 1u)
+    {
+      return false;
+    }
+
+    out |= (byte & 0x7Fu) << shift;
+    if ((byte & 0x80u) == 0u)
+    {
+      data  = it + 1;
+      value = out;
+      return true;
+    }
+
+    shift += 7u;
+  }
+
+  return false;
+}
+
+namespace details {
+/// @brief - Whether values of type `T` are written as varints by archives
+/// using the varint encoding.
+template<typename T>
+constexpr bool isVarintCandidate()
+{
+  return (std::is_integral<T>::value && !std::is_same<T, bool>::value) || std::is_enum<T>::value;
+}
+
+/// @brief - Read a string of the input size by chunks, so that a corrupted size
+/// fails at the end of the stream instead of allocating memory for the whole
+/// string upfront.
+inline bool readString(std::istream &in, std::string &str, const std::uint64_t size)
+{
+  constexpr auto CHUNK_SIZE = std::uint64_t{65536u};
+
+  str.clear();
+  while (str.size() < size && in.good())
+  {
+    const auto offset = str.size();
+    const auto chunk  = std::min(size - offset, CHUNK_SIZE);
+    str.resize(offset + chunk);
+    in.read(str.data() + offset, static_cast<std::streamsize>(chunk));
+  }
+
+  return in.good();
+}
+} // namespace details
+
+template<typename T>
+inline auto varint(T &value) noexcept -> Varint<T>
+{
+  return Varint<T>{value};
+}
+
+template<typename T>
+inline auto compact(T &value) noexcept -> Compact<T>
+{
+  return Compact<T>{value};
+}
+
+template<typename T>
+inline auto portable(T &value) noexcept -> Portable<T>
+{
+  return Portable<T>{value};
+}
+
+template<typename T>
+inline auto serialize(std::ostream &out, const Varint<T> &value) -> std::ostream &
+{
+  unsigned char buffer[MAX_VARINT_BYTES];
+
+  std::uint64_t raw;
+  if constexpr (std::is_signed<T>::value)
+  {
+    raw = zigzagEncode(value.value);
+  }
+  else
+  {
+    raw = value.value;
+  }
+
+  const auto size = encodeVarint(raw, buffer);
+  out.write(reinterpret_cast<const char *>(buffer), size);
+
+  return out;
+}
+
+template<typename T>
+inline bool deserialize(std::istream &in, Varint<T> value)
+{
+  // The bytes are read one by one as the length of the varint is not
+  // known in advance.
+  unsigned char buffer[MAX_VARINT_BYTES];
+  auto size = 0u;
+  do
+  {
+    const auto byte = in.get();
+    if (byte == std::istream::traits_type::eof())
+    {
+      return false;
+    }
+
+    buffer[size] = static_cast<unsigned char>(byte);
+    ++size;
+  } while ((buffer[size - 1u] & 0x80u) != 0u && size < MAX_VARINT_BYTES);
+
+  const unsigned char *data = buffer;
+  std::uint64_t raw{0u};
+  if (!decodeVarint(data, buffer + size, raw))
+  {
+    in.setstate(std::ios::failbit);
+    return false;
+  }
+
+  // Values which don't fit in the output type are considered invalid.
+  if constexpr (std::is_signed<T>::value)
+  {
+    const auto decoded = zigzagDecode(raw);
+    if (decoded < std::numeric_limits<T>::min() || decoded > std::numeric_limits<T>::max())
+    {
+      in.setstate(std::ios::failbit);
+      return false;
+    }
+
+    value.value = static_cast<T>(decoded);
+  }
+  else
+  {
+    if (raw > std::numeric_limits<T>::max())
+    {
+      in.setstate(std::ios::failbit);
+      return false;
+    }
+
+    value.value = static_cast<T>(raw);
+  }
+
+  return in.good();
+}
+
+template<typename T>
+inline auto serialize(std::ostream &out, const Compact<T> &value) -> std::ostream &
+{
+  std::uint64_t size{value.value.size()};
+  serialize(out, varint(size));
+
+  if constexpr (std::is_same<std::remove_const_t<T>, std::string>::value)
+  {
+    out.write(value.value.data(), value.value.size());
+  }
+  else
+  {
+    for (const auto &element : value.value)
+    {
+      serialize(out, element);
+    }
+  }
+
+  return out;
+}
+
+template<typename T>
+inline bool deserialize(std::istream &in, Compact<T> value)
+{
+  std::uint64_t size{0u};
+  if (!deserialize(in, varint(size)))
+  {
+    return false;
+  }
+
+  if constexpr (std::is_same<T, std::string>::value)
+  {
+    return details::readString(in, value.value, size);
+  }
+  else
+  {
+    // Elements are appended as they are read so that a corrupted size fails
+    // at the end of the stream instead of allocating memory upfront.
+    value.value.clear();
+    for (std::uint64_t id = 0u; id < size && in.good(); ++id)
+    {
+      typename T::value_type element{};
+      if (!deserialize(in, element))
+      {
+        return false;
+      }
+
+      value.value.push_back(std::move(element));
+    }
+
+    return in.good();
+  }
+}
+
+template<typename T>
+inline auto serialize(std::ostream &out, const Portable<T> &value) -> std::ostream &
+{
+  using Value = std::remove_const_t<T>;
+
+  if constexpr (std::is_enum<Value>::value)
+  {
+    const auto raw = toLittleEndian(static_cast<std::underlying_type_t<Value>>(value.value));
+    out.write(reinterpret_cast<const char *>(&raw), sizeof(raw));
+  }
+  else if constexpr (std::is_same<Value, std::string>::value)
+  {
+    const auto size = toLittleEndian(std::uint64_t{value.value.size()});
+    out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    out.write(value.value.data(), value.value.size());
+  }
+  else
+  {
+    const auto raw = toLittleEndian(value.value);
+    out.write(reinterpret_cast<const char *>(&raw), sizeof(raw));
+  }
+
+  return out;
+}
+
+template<typename T>
+inline bool deserialize(std::istream &in, Portable<T> value)
+{
+  if constexpr (std::is_enum<T>::value)
+  {
+    std::underlying_type_t<T> raw{};
+    in.read(reinterpret_cast<char *>(&raw), sizeof(raw));
+    value.value = static_cast<T>(fromLittleEndian(raw));
+  }
+  else if constexpr (std::is_same<T, std::string>::value)
+  {
+    std::uint64_t size{0u};
+    in.read(reinterpret_cast<char *>(&size), sizeof(size));
+    size = fromLittleEndian(size);
+    if (!in.good())
+    {
+      return false;
+    }
+
+    details::readString(in, value.value, size);
+  }
+  else
+  {
+    T raw{};
+    in.read(reinterpret_cast<char *>(&raw), sizeof(raw));
+    value.value = fromLittleEndian(raw);
+  }
+
+  return in.good();
+}
+
 } // namespace utils
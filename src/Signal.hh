@@ -1,22 +1,47 @@
 
 #pragma once
 
-#include <functional>
-#include <map>
+#include "Delegate.hh"
+#include "Dispatcher.hh"
+#include <array>
+#include <atomic>
+#include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
 
 namespace utils {
 
+/// @brief - A signal notifying a list of slots when emitted. The slots are kept
+/// in an immutable list which is copied and swapped atomically each time a slot
+/// is connected or disconnected: emitting the signal takes no lock and iterates
+/// a contiguous list, so that concurrent emissions don't wait for each other and
+/// slots can connect or disconnect slots of the signal. An emission registers in
+/// a counter of the epoch in which it starts, and a replaced list is released
+/// once the signal moved two epochs past its replacement, which only happens
+/// when no emission started before is still running. This favors signals which
+/// are much more often emitted than modified.
+/// An emission calls the slots which were connected when it started, in the
+/// order of connection: a slot disconnected while an emission is in progress,
+/// possibly in another thread, might still be called by it.
+/// Slots are called directly by the emitting thread unless they are connected
+/// with a dispatcher, in which case the emission only queues their call.
 template<typename... Args>
 class Signal
 {
   public:
   /// @brief - Convenience using to refer to a receiver function of a signal.
-  using Receiver = std::function<void(Args...)>;
+  using Receiver = Delegate<Args...>;
 
   Signal() = default;
 
+  ~Signal();
+
+  Signal(const Signal &) = delete;
+  Signal &operator=(const Signal &) = delete;
+
   /// @brief - Registers the method `func` of the instance `inst` as listener
   /// of this signal.
   /// @param inst - the instance of the class of type `T` to connect.
@@ -35,6 +60,15 @@ class Signal
   template<typename T>
   auto connect_member(T *inst, void (T::*func)(Args...) const) -> int;
 
+  /// @brief - Registers the method `Method` of the instance `inst` as listener of
+  /// this signal. As the method is known at compile time, its call is inlined
+  /// in the slot which avoids an indirection compared to the other overloads.
+  /// @param inst - the instance to connect.
+  /// @return - an identifier of the connected slot, which can be used to disconnect
+  /// the object.
+  template<auto Method, typename T>
+  auto connect_member(T *inst) -> int;
+
   /// @brief - Connects the free function `slot` to this signal so that it is
   /// notified whenever this signal is fired.
   /// @param slot - the function to connect.
@@ -42,6 +76,25 @@ class Signal
   /// this signal if needed.
   auto connect(const Receiver &slot) const -> int;
 
+  /// @brief - Connects the function `slot` to this signal so that it is called
+  /// through the dispatcher whenever this signal is fired, such as a thread pool
+  /// or an event queue. The emission then doesn't wait for the slot: arguments
+  /// are copied and the slot is called later by the dispatcher. Exceptions raised
+  /// by the slot are caught and logged. Once disconnected, a slot is not called
+  /// anymore even if some of its calls are still queued. Note that dispatchers
+  /// using several threads might run calls to the slot concurrently.
+  /// Slots only interested in the latest state can allow their calls to be
+  /// coalesced: an emission happening while a call to the slot is queued updates
+  /// the arguments of this call instead of queuing another one.
+  /// @param slot - the function to connect.
+  /// @param dispatcher - the dispatcher calling the slot. It should outlive the
+  /// connection.
+  /// @param coalesce - whether queued calls to the slot can be coalesced.
+  /// @return - an identifier which can be used to disconnect the function from
+  /// this signal if needed.
+  auto connect(const Receiver &slot, Dispatcher &dispatcher, const bool coalesce = false) const
+    -> int;
+
   /// @brief - Disconnects the slot reppresented by the identifier `id`. If
   /// no such signal exists nothing happens.
   void disconnect(int id) const;
@@ -50,31 +103,147 @@ class Signal
   void disconnectAll() const;
 
   /// @brief - Emits the signal to all the listeners forwarding the arguments `p`.
+  /// Arguments are not copied unless the listeners take them by value.
   /// @param p - a list of arguments to forward to listeners.
-  void emit(Args... p);
+  void emit(SlotArgument<Args>... p);
 
   /// @brief - Emits the signal to all the listeners forwarding the arguments `p`
   /// and does so with a safety net, i.e. a way to capture exceptions.
   /// @param name - the name of the signal, used to provide nice error messages.
   /// @param p - a list of arguments to forward to listeners.
   /// @return - `true` if the execution went well and `false` otherwise.
-  bool safeEmit(const std::string &name, Args... p);
+  bool safeEmit(const std::string &name, SlotArgument<Args>... p);
 
   /// @brief - A convenience define to indicate that a signal identifier is
   /// not valid.
   static constexpr int NO_ID = -1;
 
   private:
-  using ReceiversMap = std::unordered_map<int, Receiver>;
+  /// @brief - The copy of the arguments of an emission for queued slots.
+  using Arguments = std::tuple<std::decay_t<Args>...>;
+
+  /// @brief - The state of a slot connected with a dispatcher. It is shared by
+  /// the calls queued for the slot.
+  struct QueuedSlot
+  {
+    Receiver receiver{};
+    Dispatcher *dispatcher{nullptr};
+    bool coalesce{false};
+
+    /// @brief - Cleared when the slot is disconnected.
+    std::atomic_bool connected{true};
+
+    /// @brief - Protects the arguments of the pending call when coalescing.
+    std::mutex locker{};
+    std::optional<Arguments> pending{};
+  };
+
+  struct Slot
+  {
+    int id;
+    Receiver receiver;
+
+    /// @brief - Defined for slots connected with a dispatcher.
+    std::shared_ptr<QueuedSlot> queued{};
+  };
+
+  using Slots = std::vector<Slot>;
+
+  /// @brief - A list of slots replaced while emissions might still iterate it,
+  /// along with the epoch of the signal at the time.
+  struct Retired
+  {
+    unsigned epoch;
+    std::unique_ptr<const Slots> slots;
+  };
+
+  /// @brief - Registers an emission in the counter of the current epoch for its
+  /// lifetime, so that the list of slots it iterates is not released.
+  class Emission
+  {
+    public:
+    explicit Emission(const Signal &signal) noexcept;
+
+    Emission(const Emission &) = delete;
+    Emission &operator=(const Emission &) = delete;
+
+    ~Emission();
+
+    /// @brief - The slots to call, or null if there are none.
+    auto slots() const noexcept -> const Slots *;
+
+    private:
+    std::atomic_uint *m_emissions{nullptr};
+    const Slots *m_slots{nullptr};
+  };
+
+  /// @brief - Register a new slot and return its identifier.
+  auto add(Receiver receiver, std::shared_ptr<QueuedSlot> queued) const -> int;
+
+  /// @brief - The call queued for a slot whose calls are coalesced. It delivers
+  /// the pending arguments of the slot. In case it is dropped by the dispatcher
+  /// without running, it clears them so that later emissions queue a new call.
+  class CoalescedCall
+  {
+    public:
+    explicit CoalescedCall(std::shared_ptr<QueuedSlot> slot) noexcept;
+
+    CoalescedCall(CoalescedCall &&rhs) noexcept;
+
+    CoalescedCall(const CoalescedCall &) = delete;
+    CoalescedCall &operator=(const CoalescedCall &) = delete;
+    CoalescedCall &operator=(CoalescedCall &&) = delete;
+
+    ~CoalescedCall();
+
+    void operator()();
+
+    private:
+    std::shared_ptr<QueuedSlot> m_slot;
+  };
+
+  /// @brief - Queue a call to the slot with the input arguments.
+  static void enqueue(const std::shared_ptr<QueuedSlot> &slot, SlotArgument<Args>... args);
+
+  /// @brief - Call the slot with the input arguments unless it was disconnected.
+  static void deliver(QueuedSlot &slot, Arguments &arguments);
+
+  /// @brief - Replace the list of slots with a modified copy. Assumes that the
+  /// locker protecting the modifications of the signal is acquired.
+  /// @param modify - the callable modifying the copy of the slots.
+  template<typename Modifier>
+  void update(Modifier &&modify) const;
+
+  /// @brief - Publish a new list of slots and retire the current one. Assumes
+  /// that the locker protecting the modifications of the signal is acquired.
+  /// @param next - the new list, or null if there are no slots.
+  void replace(std::unique_ptr<const Slots> next) const;
+
+  /// @brief - Advance the epoch as far as the running emissions allow it and
+  /// release the retired lists which can't be iterated anymore. Never waits
+  /// for emissions, so that slots can modify the signal they're called by.
+  void reclaim() const;
 
   ///@brief - Describes the id to assign to the next listener to register on
   /// this signal.
   mutable int m_listenerId{0};
 
-  /// @brief - Describes all the slot to call whenever this signal is emitted.
-  mutable ReceiversMap m_slots{};
+  /// @brief - Describes all the slot to call whenever this signal is emitted. A
+  /// null value means that there are no slots. Owned by the signal.
+  mutable std::atomic<const Slots *> m_slots{nullptr};
+
+  /// @brief - The epoch of the signal, advanced by the modifications.
+  mutable std::atomic_uint m_epoch{0u};
+
+  /// @brief - The number of emissions in progress which started in an even and
+  /// in an odd epoch.
+  mutable std::array<std::atomic_uint, 2u> m_emissions{};
+
+  /// @brief - The lists replaced by modifications which might still be iterated.
+  mutable std::vector<Retired> m_retired{};
 
-  /// @brief - Protects concurrent access to this signal.
+  /// @brief - Protects concurrent modifications of this signal. Emissions don't
+  /// need to acquire it.
   mutable std::mutex m_locker{};
 };
 
@@ -3,34 +3,58 @@
 
 #include "SafetyNet.hh"
 #include "Signal.hh"
+#include <algorithm>
+#include <utility>
 
 namespace utils {
 
+template<typename... Args>
+inline Signal<Args...>::~Signal()
+{
+  delete m_slots.load(std::memory_order_relaxed);
+}
+
 template<typename... Args>
 template<typename T>
 inline auto Signal<Args...>::connect_member(T *inst, void (T::*func)(Args...)) -> int
 {
-  return connect([=](Args... args) { (inst->*func)(args...); });
+  return connect([=](SlotArgument<Args>... args) { (inst->*func)(args...); });
 }
 
 template<typename... Args>
 template<typename T>
 inline auto Signal<Args...>::connect_member(T *inst, void (T::*func)(Args...) const) -> int
 {
-  return connect([=](Args... args) { (inst->*func)(args...); });
+  return connect([=](SlotArgument<Args>... args) { (inst->*func)(args...); });
+}
+
+template<typename... Args>
+template<auto Method, typename T>
+inline auto Signal<Args...>::connect_member(T *inst) -> int
+{
+  return connect(Receiver::template bind<Method>(inst));
 }
 
 template<typename... Args>
 inline auto Signal<Args...>::connect(const Receiver &slot) const -> int
 {
-  const std::lock_guard guard(m_locker);
+  return add(slot, nullptr);
+}
 
-  auto id = m_listenerId;
-  ++m_listenerId;
+template<typename... Args>
+inline auto Signal<Args...>::connect(const Receiver &slot,
+                                     Dispatcher &dispatcher,
+                                     const bool coalesce) const -> int
+{
+  auto queued        = std::make_shared<QueuedSlot>();
+  queued->receiver   = slot;
+  queued->dispatcher = &dispatcher;
+  queued->coalesce   = coalesce;
 
-  m_slots.insert(std::make_pair(id, slot));
+  // Emissions call this receiver which queues the call to the slot.
+  Receiver receiver([queued](SlotArgument<Args>... args) { enqueue(queued, args...); });
 
-  return id;
+  return add(std::move(receiver), std::move(queued));
 }
 
 template<typename... Args>
@@ -38,45 +62,84 @@ inline void Signal<Args...>::disconnect(int id) const
 {
   const std::lock_guard guard(m_locker);
 
-  if (id != NO_ID)
+  if (id == NO_ID)
+  {
+    return;
+  }
+
+  const auto *slots = m_slots.load(std::memory_order_relaxed);
+  if (slots == nullptr
+      || std::none_of(slots->begin(), slots->end(), [id](const Slot &s) { return s.id == id; }))
   {
-    m_slots.erase(id);
+    return;
   }
+
+  update([id](Slots &list) {
+    std::erase_if(list, [id](const Slot &s) {
+      if (s.id == id && s.queued != nullptr)
+      {
+        s.queued->connected.store(false, std::memory_order_release);
+      }
+      return s.id == id;
+    });
+  });
 }
 
 template<typename... Args>
 inline void Signal<Args...>::disconnectAll() const
 {
   const std::lock_guard guard(m_locker);
-  m_slots.clear();
+
+  const auto *slots = m_slots.load(std::memory_order_relaxed);
+  if (slots == nullptr)
+  {
+    return;
+  }
+
+  for (const auto &slot : *slots)
+  {
+    if (slot.queued != nullptr)
+    {
+      slot.queued->connected.store(false, std::memory_order_release);
+    }
+  }
+
+  replace(nullptr);
 }
 
 template<typename... Args>
-inline void Signal<Args...>::emit(Args... p)
+inline void Signal<Args...>::emit(SlotArgument<Args>... p)
 {
-  const std::lock_guard guard(m_locker);
+  // The list is kept alive by the emission even if the slots
+  // are modified in the meantime.
+  const Emission emission(*this);
+  const auto *slots = emission.slots();
+  if (slots == nullptr)
+  {
+    return;
+  }
 
-  // Note that we cannot disconnect the signal from within this
-  // call otherwise we would run into iterator invalidation
-  // issues.
-  for (const auto &receiver : m_slots)
+  for (const auto &slot : *slots)
   {
-    receiver.second(p...);
+    slot.receiver(p...);
   }
 }
 
 template<typename... Args>
-inline bool Signal<Args...>::safeEmit(const std::string &name, Args... p)
+inline bool Signal<Args...>::safeEmit(const std::string &name, SlotArgument<Args>... p)
 {
-  const std::lock_guard guard(m_locker);
+  const Emission emission(*this);
+  const auto *slots = emission.slots();
+  if (slots == nullptr)
+  {
+    return true;
+  }
+
   bool allGood{true};
 
-  // Note that we cannot disconnect the signal from within this
-  // call otherwise we would run into iterator invalidation
-  // issues.
-  for (const auto &receiver : m_slots)
+  for (const auto &slot : *slots)
   {
-    if (!launchProtected([&]() { receiver.second(p...); }, name, "signal", "utils"))
+    if (!launchProtected([&]() { slot.receiver(p...); }, name, "signal", "utils"))
     {
       allGood = false;
     }
@@ -85,4 +148,188 @@ inline bool Signal<Args...>::safeEmit(const std::string &name, Args... p)
   return allGood;
 }
 
+template<typename... Args>
+inline auto Signal<Args...>::add(Receiver receiver, std::shared_ptr<QueuedSlot> queued) const
+  -> int
+{
+  const std::lock_guard guard(m_locker);
+
+  auto id = m_listenerId;
+  ++m_listenerId;
+
+  update([&](Slots &slots) { slots.push_back(Slot{id, std::move(receiver), std::move(queued)}); });
+
+  return id;
+}
+
+template<typename... Args>
+inline void Signal<Args...>::enqueue(const std::shared_ptr<QueuedSlot> &slot,
+                                     SlotArgument<Args>... args)
+{
+  if (!slot->coalesce)
+  {
+    slot->dispatcher->dispatch(SmallTask([slot, arguments = Arguments(args...)]() mutable {
+      deliver(*slot, arguments);
+    }));
+    return;
+  }
+
+  {
+    const std::lock_guard guard(slot->locker);
+
+    // A call is already queued: it will use these arguments.
+    const auto queued = slot->pending.has_value();
+    slot->pending.emplace(args...);
+    if (queued)
+    {
+      return;
+    }
+  }
+
+  slot->dispatcher->dispatch(SmallTask(CoalescedCall(slot)));
+}
+
+template<typename... Args>
+inline Signal<Args...>::CoalescedCall::CoalescedCall(std::shared_ptr<QueuedSlot> slot) noexcept
+  : m_slot(std::move(slot))
+{}
+
+template<typename... Args>
+inline Signal<Args...>::CoalescedCall::CoalescedCall(CoalescedCall &&rhs) noexcept
+  : m_slot(std::move(rhs.m_slot))
+{}
+
+template<typename... Args>
+inline Signal<Args...>::CoalescedCall::~CoalescedCall()
+{
+  if (m_slot != nullptr)
+  {
+    const std::lock_guard guard(m_slot->locker);
+    m_slot->pending.reset();
+  }
+}
+
+template<typename... Args>
+inline void Signal<Args...>::CoalescedCall::operator()()
+{
+  const auto slot = std::exchange(m_slot, nullptr);
+
+  std::optional<Arguments> arguments;
+  {
+    const std::lock_guard guard(slot->locker);
+    arguments.swap(slot->pending);
+  }
+
+  deliver(*slot, *arguments);
+}
+
+template<typename... Args>
+inline void Signal<Args...>::deliver(QueuedSlot &slot, Arguments &arguments)
+{
+  if (!slot.connected.load(std::memory_order_acquire))
+  {
+    return;
+  }
+
+  launchProtected([&slot, &arguments]() { std::apply(slot.receiver, arguments); },
+                  "deliver",
+                  "signal",
+                  "utils");
+}
+
+template<typename... Args>
+template<typename Modifier>
+inline void Signal<Args...>::update(Modifier &&modify) const
+{
+  // Readers might still iterate over the current list: modify a copy.
+  const auto *current = m_slots.load(std::memory_order_relaxed);
+  auto next = (current != nullptr ? std::make_unique<Slots>(*current) : std::make_unique<Slots>());
+
+  modify(*next);
+
+  if (next->empty())
+  {
+    next.reset();
+  }
+
+  replace(std::move(next));
+}
+
+template<typename... Args>
+inline void Signal<Args...>::replace(std::unique_ptr<const Slots> next) const
+{
+  const auto *current = m_slots.load(std::memory_order_relaxed);
+  if (current != nullptr)
+  {
+    m_retired.reserve(m_retired.size() + 1u);
+  }
+
+  m_slots.store(next.release());
+
+  if (current != nullptr)
+  {
+    m_retired.push_back(
+      Retired{m_epoch.load(std::memory_order_relaxed), std::unique_ptr<const Slots>(current)});
+  }
+
+  reclaim();
+}
+
+template<typename... Args>
+inline void Signal<Args...>::reclaim() const
+{
+  // The epoch advances once the emissions started in the previous one are
+  // done: emissions which might iterate a list retired in an epoch are over
+  // once the signal is two epochs further.
+  for (auto step = 0u; step < 2u; ++step)
+  {
+    const auto epoch = m_epoch.load(std::memory_order_relaxed);
+    if (m_emissions[(epoch + 1u) % 2u].load() != 0u)
+    {
+      break;
+    }
+
+    m_epoch.store(epoch + 1u);
+  }
+
+  const auto epoch = m_epoch.load(std::memory_order_relaxed);
+  std::erase_if(m_retired, [epoch](const Retired &retired) { return epoch - retired.epoch >= 2u; });
+}
+
+template<typename... Args>
+inline Signal<Args...>::Emission::Emission(const Signal &signal) noexcept
+{
+  // Register in the counter of the current epoch. In case the epoch changed in
+  // the meantime, the modification might not have seen this emission.
+  auto epoch = signal.m_epoch.load();
+  while (true)
+  {
+    m_emissions = &signal.m_emissions[epoch % 2u];
+    m_emissions->fetch_add(1u);
+
+    const auto current = signal.m_epoch.load();
+    if (current == epoch)
+    {
+      break;
+    }
+
+    m_emissions->fetch_sub(1u);
+    epoch = current;
+  }
+
+  m_slots = signal.m_slots.load();
+}
+
+template<typename... Args>
+inline Signal<Args...>::Emission::~Emission()
+{
+  m_emissions->fetch_sub(1u);
+}
+
+template<typename... Args>
+inline auto Signal<Args...>::Emission::slots() const noexcept -> const Slots *
+{
+  return m_slots;
+}
+
 } // namespace utils
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+/// @brief - A move-only type-erased callable taking no argument and returning
+/// nothing. Compared to a `std::function` it stores small callables directly
+/// in the object so that creating a task does not allocate memory. Callables
+/// bigger than the inline storage are allocated on the heap.
+class SmallTask
+{
+  public:
+  /// @brief - The size in bytes available to store a callable without any
+  /// memory allocation.
+  static constexpr std::size_t INLINE_SIZE = 48u;
+
+  SmallTask() noexcept = default;
+
+  /// @brief - Create a new task wrapping the input callable.
+  /// @param func - the callable to wrap.
+  template<typename F,
+           std::enable_if_t<!std::is_same<std::decay_t<F>, SmallTask>::value, bool> = true>
+  SmallTask(F &&func);
+
+  SmallTask(SmallTask &&rhs) noexcept;
+  SmallTask &operator=(SmallTask &&rhs) noexcept;
+
+  SmallTask(const SmallTask &) = delete;
+  SmallTask &operator=(const SmallTask &) = delete;
+
+  ~SmallTask();
+
+  /// @brief - Whether this task wraps a callable.
+  /// @return - `true` if a callable is attached to this task.
+  explicit operator bool() const noexcept;
+
+  /// @brief - Invoke the wrapped callable. The task should not be empty.
+  void operator()();
+
+  /// @brief - Whether a callable of type `F` can be stored without allocating
+  /// memory.
+  template<typename F>
+  static constexpr bool fitsInline() noexcept;
+
+  private:
+  /// @brief - The operations allowing to manipulate the stored callable
+  /// without knowing its type.
+  struct Operations
+  {
+    void (*invoke)(void *storage);
+    void (*move)(void *to, void *from) noexcept;
+    void (*destroy)(void *storage) noexcept;
+  };
+
+  template<typename F>
+  static const Operations *inlineOperations() noexcept;
+
+  template<typename F>
+  static const Operations *heapOperations() noexcept;
+
+  void reset() noexcept;
+
+  private:
+  alignas(std::max_align_t) unsigned char m_storage[INLINE_SIZE]{};
+  const Operations *m_operations{nullptr};
+};
+
+} // namespace utils
+
+#include "SmallTask.hxx"
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "SmallTask.hh"
+#include <new>
+
+namespace utils {
+
+template<typename F>
+inline constexpr bool SmallTask::fitsInline() noexcept
+{
+  return sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t)
+         && std::is_nothrow_move_constructible<F>::value;
+}
+
+template<typename F, std::enable_if_t<!std::is_same<std::decay_t<F>, SmallTask>::value, bool>>
+inline SmallTask::SmallTask(F &&func)
+{
+  using Callable = std::decay_t<F>;
+
+  if constexpr (fitsInline<Callable>())
+  {
+    new (m_storage) Callable(std::forward<F>(func));
+    m_operations = inlineOperations<Callable>();
+  }
+  else
+  {
+    *reinterpret_cast<Callable **>(m_storage) = new Callable(std::forward<F>(func));
+    m_operations                              = heapOperations<Callable>();
+  }
+}
+
+inline SmallTask::SmallTask(SmallTask &&rhs) noexcept
+{
+  if (rhs.m_operations != nullptr)
+  {
+    rhs.m_operations->move(m_storage, rhs.m_storage);
+    m_operations = std::exchange(rhs.m_operations, nullptr);
+  }
+}
+
+inline SmallTask &SmallTask::operator=(SmallTask &&rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    reset();
+
+    if (rhs.m_operations != nullptr)
+    {
+      rhs.m_operations->move(m_storage, rhs.m_storage);
+      m_operations = std::exchange(rhs.m_operations, nullptr);
+    }
+  }
+
+  return *this;
+}
+
+inline SmallTask::~SmallTask()
+{
+  reset();
+}
+
+inline SmallTask::operator bool() const noexcept
+{
+  return m_operations != nullptr;
+}
+
+inline void SmallTask::operator()()
+{
+  m_operations->invoke(m_storage);
+}
+
+template<typename F>
+inline const SmallTask::Operations *SmallTask::inlineOperations() noexcept
+{
+  static constexpr Operations operations{
+    [](void *storage) { (*std::launder(reinterpret_cast<F *>(storage)))(); },
+    [](void *to, void *from) noexcept {
+      auto *src = std::launder(reinterpret_cast<F *>(from));
+      new (to) F(std::move(*src));
+      src->~F();
+    },
+    [](void *storage) noexcept { std::launder(reinterpret_cast<F *>(storage))->~F(); }};
+
+  return &operations;
+}
+
+template<typename F>
+inline const SmallTask::Operations *SmallTask::heapOperations() noexcept
+{
+  static constexpr Operations operations{
+    [](void *storage) { (**reinterpret_cast<F **>(storage))(); },
+    [](void *to, void *from) noexcept {
+      *reinterpret_cast<F **>(to) = std::exchange(*reinterpret_cast<F **>(from), nullptr);
+    },
+    [](void *storage) noexcept { delete *reinterpret_cast<F **>(storage); }};
+
+  return &operations;
+}
+
+inline void SmallTask::reset() noexcept
+{
+  if (m_operations != nullptr)
+  {
+    m_operations->destroy(m_storage);
+    m_operations = nullptr;
+  }
+}
+
+} // namespace utils
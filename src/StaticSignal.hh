@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <tuple>
+
+namespace utils {
+
+/// @brief - A signal whose slots are known at compile time. The slots are any
+/// callables, typically lambdas capturing the objects to notify, and are stored
+/// by value: emitting the signal calls each of them directly, which allows the
+/// compiler to inline the dispatch in hot paths. Unlike `Signal` the slots can't
+/// be connected or disconnected once the signal is created.
+/// The slots are called in the order they were provided, with the arguments of
+/// the emission passed as lvalues.
+template<typename... Slots>
+class StaticSignal
+{
+  public:
+  /// @brief - Create a signal calling the input slots.
+  /// @param slots - the slots to call whenever the signal is emitted.
+  constexpr explicit StaticSignal(Slots... slots);
+
+  /// @brief - Emits the signal to all the slots forwarding the arguments `args`.
+  /// @param args - a list of arguments to forward to the slots.
+  template<typename... Args>
+  void emit(Args &&...args) const;
+
+  /// @brief - Similar to `emit` but captures the exceptions raised by the slots.
+  /// @param name - the name of the signal, used to provide nice error messages.
+  /// @param args - a list of arguments to forward to the slots.
+  /// @return - `true` if the execution went well and `false` otherwise.
+  template<typename... Args>
+  bool safeEmit(const std::string &name, Args &&...args) const;
+
+  private:
+  std::tuple<Slots...> m_slots;
+};
+
+} // namespace utils
+
+#include "StaticSignal.hxx"
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "SafetyNet.hh"
+#include "StaticSignal.hh"
+#include <utility>
+
+namespace utils {
+
+template<typename... Slots>
+inline constexpr StaticSignal<Slots...>::StaticSignal(Slots... slots)
+  : m_slots(std::move(slots)...)
+{}
+
+template<typename... Slots>
+template<typename... Args>
+inline void StaticSignal<Slots...>::emit(Args &&...args) const
+{
+  std::apply([&args...](const auto &...slots) { (slots(args...), ...); }, m_slots);
+}
+
+template<typename... Slots>
+template<typename... Args>
+inline bool StaticSignal<Slots...>::safeEmit(const std::string &name, Args &&...args) const
+{
+  bool allGood{true};
+
+  std::apply(
+    [&](const auto &...slots) {
+      ((allGood = launchProtected([&]() { slots(args...); }, name, "signal", "utils") && allGood),
+       ...);
+    },
+    m_slots);
+
+  return allGood;
+}
+
+} // namespace utils
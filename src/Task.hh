@@ -0,0 +1,153 @@
+#pragma once
+
+#include "FrameAllocator.hh"
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <variant>
+
+namespace utils {
+
+template<typename T>
+class Task;
+
+namespace details {
+
+/// @brief - Base for the promises of the coroutines defined in this library: the
+/// frames of the coroutines are allocated through the `FrameAllocator`.
+struct PooledPromise
+{
+  static auto operator new(const std::size_t size) -> void *;
+  static void operator delete(void *frame, const std::size_t size) noexcept;
+};
+
+/// @brief - The part of the promise of a `Task` which doesn't depend on the type
+/// of its result. A task starts suspended and resumes the coroutine awaiting it
+/// when it completes.
+class TaskPromiseBase : public PooledPromise
+{
+  public:
+  /// @brief - Resumes the awaiting coroutine through symmetric transfer, so that
+  /// long chains of tasks completing synchronously don't grow the stack.
+  struct FinalAwaiter
+  {
+    bool await_ready() const noexcept;
+
+    template<typename Promise>
+    auto await_suspend(std::coroutine_handle<Promise> handle) noexcept -> std::coroutine_handle<>;
+
+    void await_resume() const noexcept;
+  };
+
+  auto initial_suspend() const noexcept -> std::suspend_always;
+  auto final_suspend() const noexcept -> FinalAwaiter;
+  void unhandled_exception() noexcept;
+
+  /// @brief - Define the coroutine to resume when the task completes.
+  /// @param continuation - the awaiting coroutine.
+  void setContinuation(std::coroutine_handle<> continuation) noexcept;
+
+  protected:
+  std::coroutine_handle<> m_continuation{std::noop_coroutine()};
+  std::exception_ptr m_exception{};
+};
+
+template<typename T>
+class TaskPromise : public TaskPromiseBase
+{
+  public:
+  auto get_return_object() noexcept -> Task<T>;
+
+  template<typename U>
+  void return_value(U &&value);
+
+  /// @brief - Extract the result of the task, rethrowing the exception it raised
+  /// if any.
+  /// @return - the value returned by the task.
+  auto result() -> T;
+
+  private:
+  std::optional<T> m_value{};
+};
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase
+{
+  public:
+  auto get_return_object() noexcept -> Task<void>;
+
+  void return_void() const noexcept;
+
+  void result();
+};
+
+} // namespace details
+
+/// @brief - A coroutine producing a value of type `T`. The coroutine does not
+/// start when it is created but when it is awaited with `co_await`, and resumes
+/// the awaiting coroutine once done. A task can only be awaited once and should
+/// be moved into the functions consuming it (`syncWait`, `whenAll`...).
+/// Combined with `ThreadPool::schedule`, tasks allow to write pipelines whose
+/// stages run on the threads of a pool without blocking any of them while they
+/// wait for each other.
+template<typename T = void>
+class Task
+{
+  public:
+  using promise_type = details::TaskPromise<T>;
+
+  /// @brief - Create an invalid task, not attached to any coroutine.
+  Task() = default;
+
+  explicit Task(std::coroutine_handle<promise_type> handle) noexcept;
+
+  ~Task();
+
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+
+  Task(Task &&rhs) noexcept;
+  Task &operator=(Task &&rhs) noexcept;
+
+  /// @brief - Whether this task is attached to a coroutine.
+  /// @return - `true` if the task is valid.
+  bool valid() const noexcept;
+
+  /// @brief - Whether the coroutine of the task ran to completion.
+  /// @return - `true` if the task is done.
+  bool done() const noexcept;
+
+  /// @brief - Start the task and suspend the awaiting coroutine until it is done.
+  /// The result of the task is then returned, or the exception it raised is
+  /// rethrown.
+  class Awaiter
+  {
+    public:
+    explicit Awaiter(std::coroutine_handle<promise_type> handle) noexcept;
+
+    bool await_ready() const noexcept;
+    auto await_suspend(std::coroutine_handle<> awaiting) noexcept -> std::coroutine_handle<>;
+    auto await_resume() -> T;
+
+    private:
+    std::coroutine_handle<promise_type> m_handle;
+  };
+
+  auto operator co_await() const noexcept -> Awaiter;
+
+  private:
+  std::coroutine_handle<promise_type> m_handle{};
+};
+
+/// @brief - Start the task and block the calling thread until it completes. This
+/// is the bridge between regular code and coroutines: it should not be called
+/// from a thread of the pool the task is scheduled on as it would block it.
+/// @param task - the task to run.
+/// @return - the result of the task. The exception it raised is rethrown.
+template<typename T>
+auto syncWait(Task<T> task) -> T;
+
+} // namespace utils
+
+#include "Task.hxx"
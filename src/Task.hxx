@@ -0,0 +1,314 @@
+#pragma once
+
+#include "Task.hh"
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+namespace utils {
+namespace details {
+
+inline auto PooledPromise::operator new(const std::size_t size) -> void *
+{
+  return FrameAllocator::allocate(size);
+}
+
+inline void PooledPromise::operator delete(void *frame, const std::size_t size) noexcept
+{
+  FrameAllocator::deallocate(frame, size);
+}
+
+inline bool TaskPromiseBase::FinalAwaiter::await_ready() const noexcept
+{
+  return false;
+}
+
+template<typename Promise>
+inline auto TaskPromiseBase::FinalAwaiter::await_suspend(
+  std::coroutine_handle<Promise> handle) noexcept -> std::coroutine_handle<>
+{
+  return handle.promise().m_continuation;
+}
+
+inline void TaskPromiseBase::FinalAwaiter::await_resume() const noexcept {}
+
+inline auto TaskPromiseBase::initial_suspend() const noexcept -> std::suspend_always
+{
+  return {};
+}
+
+inline auto TaskPromiseBase::final_suspend() const noexcept -> FinalAwaiter
+{
+  return {};
+}
+
+inline void TaskPromiseBase::unhandled_exception() noexcept
+{
+  m_exception = std::current_exception();
+}
+
+inline void TaskPromiseBase::setContinuation(std::coroutine_handle<> continuation) noexcept
+{
+  m_continuation = continuation;
+}
+
+template<typename T>
+inline auto TaskPromise<T>::get_return_object() noexcept -> Task<T>
+{
+  return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+template<typename T>
+template<typename U>
+inline void TaskPromise<T>::return_value(U &&value)
+{
+  m_value.emplace(std::forward<U>(value));
+}
+
+template<typename T>
+inline auto TaskPromise<T>::result() -> T
+{
+  if (m_exception)
+  {
+    std::rethrow_exception(m_exception);
+  }
+
+  return std::move(*m_value);
+}
+
+inline auto TaskPromise<void>::get_return_object() noexcept -> Task<void>
+{
+  return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+inline void TaskPromise<void>::return_void() const noexcept {}
+
+inline void TaskPromise<void>::result()
+{
+  if (m_exception)
+  {
+    std::rethrow_exception(m_exception);
+  }
+}
+
+/// @brief - Used by `syncWait` to block a thread until a coroutine completes.
+struct SyncWaitSignal
+{
+  std::mutex locker{};
+  std::condition_variable waiter{};
+  bool done{false};
+};
+
+/// @brief - A coroutine awaiting a task on behalf of a thread blocked in
+/// `syncWait`, and waking it up once the task is done.
+class SyncWaitTask
+{
+  public:
+  class promise_type : public PooledPromise
+  {
+    public:
+    struct FinalAwaiter
+    {
+      bool await_ready() const noexcept
+      {
+        return false;
+      }
+
+      void await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+      {
+        // The signal belongs to the blocked thread: it is not touched
+        // anymore once the lock is released.
+        auto &signal = *handle.promise().m_signal;
+        std::lock_guard guard(signal.locker);
+        signal.done = true;
+        signal.waiter.notify_one();
+      }
+
+      void await_resume() const noexcept {}
+    };
+
+    auto get_return_object() noexcept -> SyncWaitTask
+    {
+      return SyncWaitTask(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    auto initial_suspend() const noexcept -> std::suspend_always
+    {
+      return {};
+    }
+
+    auto final_suspend() const noexcept -> FinalAwaiter
+    {
+      return {};
+    }
+
+    void return_void() const noexcept {}
+
+    void unhandled_exception() const noexcept
+    {
+      // The body of the coroutine catches all exceptions.
+      std::terminate();
+    }
+
+    SyncWaitSignal *m_signal{nullptr};
+  };
+
+  explicit SyncWaitTask(std::coroutine_handle<promise_type> handle) noexcept
+    : m_handle(handle)
+  {}
+
+  ~SyncWaitTask()
+  {
+    m_handle.destroy();
+  }
+
+  SyncWaitTask(const SyncWaitTask &) = delete;
+  SyncWaitTask &operator=(const SyncWaitTask &) = delete;
+
+  /// @brief - Start the coroutine and block until it is done.
+  void run()
+  {
+    SyncWaitSignal signal;
+    m_handle.promise().m_signal = &signal;
+    m_handle.resume();
+
+    std::unique_lock lock(signal.locker);
+    signal.waiter.wait(lock, [&signal]() { return signal.done; });
+  }
+
+  private:
+  std::coroutine_handle<promise_type> m_handle;
+};
+
+/// @brief - Allows to store the result of any task, including `void` ones.
+template<typename T>
+using TaskValue = std::conditional_t<std::is_void<T>::value, std::monostate, T>;
+
+template<typename T>
+inline auto makeSyncWaitTask(Task<T> &task,
+                             std::optional<TaskValue<T>> &value,
+                             std::exception_ptr &exception) -> SyncWaitTask
+{
+  try
+  {
+    if constexpr (std::is_void<T>::value)
+    {
+      co_await task;
+      value.emplace();
+    }
+    else
+    {
+      value.emplace(co_await task);
+    }
+  }
+  catch (...)
+  {
+    exception = std::current_exception();
+  }
+}
+
+} // namespace details
+
+template<typename T>
+inline Task<T>::Task(std::coroutine_handle<promise_type> handle) noexcept
+  : m_handle(handle)
+{}
+
+template<typename T>
+inline Task<T>::~Task()
+{
+  if (m_handle)
+  {
+    m_handle.destroy();
+  }
+}
+
+template<typename T>
+inline Task<T>::Task(Task &&rhs) noexcept
+  : m_handle(std::exchange(rhs.m_handle, {}))
+{}
+
+template<typename T>
+inline Task<T> &Task<T>::operator=(Task &&rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    if (m_handle)
+    {
+      m_handle.destroy();
+    }
+
+    m_handle = std::exchange(rhs.m_handle, {});
+  }
+
+  return *this;
+}
+
+template<typename T>
+inline bool Task<T>::valid() const noexcept
+{
+  return static_cast<bool>(m_handle);
+}
+
+template<typename T>
+inline bool Task<T>::done() const noexcept
+{
+  return m_handle && m_handle.done();
+}
+
+template<typename T>
+inline Task<T>::Awaiter::Awaiter(std::coroutine_handle<promise_type> handle) noexcept
+  : m_handle(handle)
+{}
+
+template<typename T>
+inline bool Task<T>::Awaiter::await_ready() const noexcept
+{
+  return !m_handle || m_handle.done();
+}
+
+template<typename T>
+inline auto Task<T>::Awaiter::await_suspend(std::coroutine_handle<> awaiting) noexcept
+  -> std::coroutine_handle<>
+{
+  // Start the task right away in this thread instead of going back to
+  // the caller.
+  m_handle.promise().setContinuation(awaiting);
+  return m_handle;
+}
+
+template<typename T>
+inline auto Task<T>::Awaiter::await_resume() -> T
+{
+  return m_handle.promise().result();
+}
+
+template<typename T>
+inline auto Task<T>::operator co_await() const noexcept -> Awaiter
+{
+  return Awaiter(m_handle);
+}
+
+template<typename T>
+inline auto syncWait(Task<T> task) -> T
+{
+  std::optional<details::TaskValue<T>> value;
+  std::exception_ptr exception;
+
+  {
+    auto waiter = details::makeSyncWaitTask(task, value, exception);
+    waiter.run();
+  }
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+
+  if constexpr (!std::is_void<T>::value)
+  {
+    return std::move(*value);
+  }
+}
+
+} // namespace utils
@@ -0,0 +1,265 @@
+#include "TaskGraph.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+
+namespace utils {
+namespace {
+using Nanoseconds = std::chrono::nanoseconds;
+}
+
+TaskGraph::TaskGraph(ThreadPool &pool)
+  : CoreObject("graph")
+  , m_pool(pool)
+  , m_nodes()
+  , m_order()
+  , m_group(pool)
+  , m_running(false)
+  , m_batch(0u)
+  , m_cancelled(false)
+  , m_start()
+{
+  setService("pool");
+}
+
+TaskGraph::~TaskGraph()
+{
+  if (!m_running)
+  {
+    return;
+  }
+
+  // The jobs reference the graph so they have to be done before it is destroyed.
+  try
+  {
+    wait();
+  }
+  catch (const CoreException &e)
+  {
+    warn("Task graph failed while being destroyed", e.what());
+  }
+  catch (...)
+  {
+    warn("Task graph failed while being destroyed");
+  }
+}
+
+auto TaskGraph::addJob(AsynchronousJobShPtr job) -> unsigned
+{
+  if (job == nullptr)
+  {
+    error("Cannot add job to task graph", "Invalid null job");
+  }
+  if (m_running)
+  {
+    error("Cannot add job to task graph", "Graph is running");
+  }
+
+  auto node = std::make_unique<Node>();
+  node->job = std::move(job);
+  m_nodes.push_back(std::move(node));
+
+  return m_nodes.size() - 1u;
+}
+
+void TaskGraph::precede(const unsigned predecessor, const unsigned successor)
+{
+  if (predecessor >= m_nodes.size() || successor >= m_nodes.size())
+  {
+    error("Cannot add dependency to task graph",
+          "Invalid job " + std::to_string(std::max(predecessor, successor)) + " (graph has "
+            + std::to_string(m_nodes.size()) + " job(s))");
+  }
+  if (m_running)
+  {
+    error("Cannot add dependency to task graph", "Graph is running");
+  }
+
+  m_nodes[predecessor]->successors.push_back(successor);
+  m_nodes[successor]->predecessors.push_back(predecessor);
+}
+
+void TaskGraph::run()
+{
+  if (m_running)
+  {
+    error("Cannot run task graph", "Graph is already running");
+  }
+
+  m_order = topologicalOrder();
+  if (m_order.size() != m_nodes.size())
+  {
+    error("Cannot run task graph", "Graph contains a cycle");
+  }
+
+  for (auto &node : m_nodes)
+  {
+    node->remaining.store(node->predecessors.size(), std::memory_order_relaxed);
+    node->start = TimeStamp{};
+    node->end   = TimeStamp{};
+  }
+
+  m_batch = m_pool.batchIndex();
+  m_cancelled.store(false, std::memory_order_relaxed);
+  m_start   = std::chrono::steady_clock::now();
+  m_running = true;
+
+  for (auto id = 0u; id < m_nodes.size(); ++id)
+  {
+    if (m_nodes[id]->predecessors.empty())
+    {
+      schedule(id);
+    }
+  }
+}
+
+bool TaskGraph::wait()
+{
+  if (!m_running)
+  {
+    return !m_cancelled.load(std::memory_order_relaxed);
+  }
+
+  try
+  {
+    m_group.wait();
+  }
+  catch (...)
+  {
+    m_running = false;
+
+    // Jobs discarded by the pool are reported as failures by the group
+    // while they only mean that the graph was cancelled.
+    if (!m_group.cancelled())
+    {
+      throw;
+    }
+
+    m_cancelled.store(true, std::memory_order_relaxed);
+  }
+
+  m_running = false;
+
+  return !m_cancelled.load(std::memory_order_relaxed);
+}
+
+auto TaskGraph::criticalPath() const -> CriticalPathReport
+{
+  if (m_running)
+  {
+    error("Cannot compute critical path", "Graph is running");
+  }
+
+  CriticalPathReport out;
+
+  // For each job, the longest accumulated compute time of a chain of
+  // jobs ending with it and the job preceding it in this chain.
+  std::vector<Nanoseconds> lengths(m_nodes.size(), Nanoseconds(0));
+  std::vector<int> previous(m_nodes.size(), -1);
+  auto last = -1;
+
+  for (const auto id : m_order)
+  {
+    const auto &node    = *m_nodes[id];
+    const auto duration = std::chrono::duration_cast<Nanoseconds>(node.end - node.start);
+
+    for (const auto predecessor : node.predecessors)
+    {
+      if (previous[id] < 0 || lengths[predecessor] > lengths[previous[id]])
+      {
+        previous[id] = static_cast<int>(predecessor);
+      }
+    }
+
+    lengths[id] = duration + (previous[id] < 0 ? Nanoseconds(0) : lengths[previous[id]]);
+    out.work += duration;
+
+    if (node.end != TimeStamp{})
+    {
+      const auto elapsed = std::chrono::duration_cast<Nanoseconds>(node.end - m_start);
+      out.wallTime       = std::max(out.wallTime, elapsed);
+    }
+
+    if (last < 0 || lengths[id] > lengths[last])
+    {
+      last = static_cast<int>(id);
+    }
+  }
+
+  if (last < 0)
+  {
+    return out;
+  }
+
+  out.length = lengths[last];
+  for (auto id = last; id >= 0; id = previous[id])
+  {
+    out.path.push_back(static_cast<unsigned>(id));
+  }
+  std::reverse(out.path.begin(), out.path.end());
+
+  return out;
+}
+
+auto TaskGraph::topologicalOrder() const -> std::vector<unsigned>
+{
+  std::vector<unsigned> out;
+  out.reserve(m_nodes.size());
+
+  std::vector<std::size_t> remaining(m_nodes.size());
+  for (auto id = 0u; id < m_nodes.size(); ++id)
+  {
+    remaining[id] = m_nodes[id]->predecessors.size();
+    if (remaining[id] == 0u)
+    {
+      out.push_back(id);
+    }
+  }
+
+  // The output doubles as the queue of jobs to process.
+  for (auto current = 0u; current < out.size(); ++current)
+  {
+    for (const auto successor : m_nodes[out[current]]->successors)
+    {
+      --remaining[successor];
+      if (remaining[successor] == 0u)
+      {
+        out.push_back(successor);
+      }
+    }
+  }
+
+  return out;
+}
+
+void TaskGraph::schedule(const unsigned id)
+{
+  m_group.run([this, id]() { execute(id); }, m_nodes[id]->job->getPriority());
+}
+
+void TaskGraph::execute(const unsigned id)
+{
+  if (m_pool.batchIndex() != m_batch)
+  {
+    m_cancelled.store(true, std::memory_order_relaxed);
+  }
+  if (m_cancelled.load(std::memory_order_relaxed))
+  {
+    return;
+  }
+
+  auto &node = *m_nodes[id];
+
+  node.start = std::chrono::steady_clock::now();
+  node.job->compute(m_pool.cancellationToken(m_batch, node.job->getDeadline()));
+  node.end = std::chrono::steady_clock::now();
+
+  for (const auto successor : node.successors)
+  {
+    if (m_nodes[successor]->remaining.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+    {
+      schedule(successor);
+    }
+  }
+}
+
+} // namespace utils
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "AsynchronousJob.hh"
+#include "CoreObject.hh"
+#include "TaskGroup.hh"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace utils {
+
+class ThreadPool;
+
+/// @brief - Timings of the last execution of a task graph. The critical path
+/// is the chain of dependent jobs with the longest accumulated compute time:
+/// no amount of threads can make the graph complete faster than that.
+struct CriticalPathReport
+{
+  /// @brief - The identifiers of the jobs on the critical path, from the first
+  /// one to be executed to the last.
+  std::vector<unsigned> path{};
+
+  /// @brief - The accumulated compute time of the jobs on the critical path.
+  std::chrono::nanoseconds length{0};
+
+  /// @brief - The accumulated compute time of all the jobs of the graph.
+  std::chrono::nanoseconds work{0};
+
+  /// @brief - The time elapsed between the start of the execution and the
+  /// completion of the last job.
+  std::chrono::nanoseconds wallTime{0};
+};
+
+/// @brief - Allows to execute a set of jobs with dependencies on a pool. Each
+/// job is submitted to the pool as soon as the last of its predecessors has
+/// completed, without waiting for the rest of the graph. The graph can be run
+/// several times, but not concurrently.
+class TaskGraph : public CoreObject
+{
+  public:
+  /// @brief - Create a new empty graph executing its jobs on the input pool.
+  /// @param pool - the pool executing the jobs.
+  TaskGraph(ThreadPool &pool);
+
+  /// @brief - Wait for the current execution to complete if any.
+  ~TaskGraph() override;
+
+  TaskGraph(const TaskGraph &) = delete;
+  TaskGraph &operator=(const TaskGraph &) = delete;
+
+  /// @brief - Register a new job in the graph. The job is submitted to the pool
+  /// with its own priority.
+  /// @param job - the job to register.
+  /// @return - the identifier of the job in the graph.
+  auto addJob(AsynchronousJobShPtr job) -> unsigned;
+
+  /// @brief - Declare that the `successor` job can only start once the
+  /// `predecessor` job is done.
+  /// @param predecessor - the job to execute first.
+  /// @param successor - the job depending on `predecessor`.
+  void precede(const unsigned predecessor, const unsigned successor);
+
+  /// @brief - Start the execution of the graph: all the jobs without any
+  /// predecessor are submitted to the pool right away. Raises an error in case
+  /// the graph contains a cycle or is already running.
+  void run();
+
+  /// @brief - Wait for the execution started by `run` to complete, helping the
+  /// pool in the meantime. Exceptions raised by the jobs are rethrown here.
+  /// The execution is interrupted if the jobs of the pool are cancelled (see
+  /// `ThreadPool::cancelJobs`): the jobs not yet started are then skipped.
+  /// @return - `true` if all the jobs were executed, `false` if the execution
+  /// was cancelled.
+  bool wait();
+
+  /// @brief - Compute the critical path of the last completed execution.
+  /// @return - the timings of the last execution.
+  auto criticalPath() const -> CriticalPathReport;
+
+  private:
+  using TimeStamp = std::chrono::steady_clock::time_point;
+
+  /// @brief - A job of the graph along with its dependencies.
+  struct Node
+  {
+    AsynchronousJobShPtr job;
+    std::vector<unsigned> predecessors{};
+    std::vector<unsigned> successors{};
+
+    /// @brief - The number of predecessors not yet completed during the
+    /// current execution.
+    std::atomic_uint remaining{0u};
+
+    TimeStamp start{};
+    TimeStamp end{};
+  };
+
+  /// @brief - Sort the jobs so that each one comes after its predecessors.
+  /// @return - the identifiers of the jobs in topological order, which might
+  /// not contain all of them in case the graph has a cycle.
+  auto topologicalOrder() const -> std::vector<unsigned>;
+
+  /// @brief - Submit the job to the pool.
+  /// @param id - the identifier of the job.
+  void schedule(const unsigned id);
+
+  /// @brief - Execute the job and schedule the successors which have no more
+  /// pending dependencies.
+  /// @param id - the identifier of the job.
+  void execute(const unsigned id);
+
+  private:
+  ThreadPool &m_pool;
+  std::vector<std::unique_ptr<Node>> m_nodes;
+
+  /// @brief - The topological order of the graph computed when it was last run.
+  std::vector<unsigned> m_order;
+
+  /// @brief - The group tracking the jobs submitted to the pool.
+  TaskGroup m_group;
+  bool m_running;
+
+  /// @brief - The batch of the pool when the execution was started. A change
+  /// indicates that the pool's jobs were cancelled.
+  unsigned m_batch;
+  std::atomic_bool m_cancelled;
+  TimeStamp m_start;
+};
+
+} // namespace utils
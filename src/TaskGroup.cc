@@ -0,0 +1,95 @@
+#include "TaskGroup.hh"
+#include "CoreException.hh"
+
+namespace utils {
+
+TaskGroup::TaskGroup(ThreadPool &pool, const Priority priority)
+  : m_pool(pool)
+  , m_priority(priority)
+  , m_state(std::make_shared<State>())
+{}
+
+TaskGroup::~TaskGroup()
+{
+  waitForTasks();
+}
+
+void TaskGroup::wait()
+{
+  waitForTasks();
+  m_cancelled = m_state->cancelled.exchange(false, std::memory_order_relaxed);
+
+  if (!m_state->failed.load(std::memory_order_acquire))
+  {
+    return;
+  }
+
+  // Reset the state so that the group can be reused.
+  auto exception     = m_state->exception;
+  m_state->exception = nullptr;
+  m_state->failed.store(false, std::memory_order_relaxed);
+
+  std::rethrow_exception(exception);
+}
+
+bool TaskGroup::cancelled() const noexcept
+{
+  return m_cancelled;
+}
+
+void TaskGroup::waitForTasks()
+{
+  while (true)
+  {
+    const auto pending = m_state->pending.load(std::memory_order_acquire);
+    if (pending == 0u)
+    {
+      return;
+    }
+
+    // Help the pool rather than sleeping: the tasks we're waiting
+    // for might be sitting in its queues.
+    if (m_pool.runPendingJob())
+    {
+      continue;
+    }
+
+    m_state->pending.wait(pending, std::memory_order_acquire);
+  }
+}
+
+void TaskGroup::State::finish() noexcept
+{
+  if (pending.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+  {
+    pending.notify_all();
+  }
+}
+
+void TaskGroup::State::fail(std::exception_ptr ex) noexcept
+{
+  bool expected = false;
+  if (failed.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+  {
+    exception = ex;
+  }
+}
+
+TaskGroup::Ticket::Ticket(std::shared_ptr<State> state) noexcept
+  : m_state(std::move(state))
+{}
+
+TaskGroup::Ticket::~Ticket()
+{
+  // The task was destroyed without being executed.
+  if (m_state != nullptr)
+  {
+    const auto cause = std::string("Task was cancelled");
+    m_state->cancelled.store(true, std::memory_order_relaxed);
+    m_state->fail(
+      std::make_exception_ptr(CoreException("Failed to execute task", "group", "utils", cause)));
+    m_state->finish();
+  }
+}
+
+} // namespace utils
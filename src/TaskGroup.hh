@@ -0,0 +1,105 @@
+#pragma once
+
+#include "JobPriority.hh"
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace utils {
+
+class ThreadPool;
+
+/// @brief - Allows to submit a set of callables to a thread pool and to wait
+/// for all of them to complete. While waiting the calling thread helps the
+/// pool by executing pending jobs, which makes it safe to use a group from
+/// within a job running on the same pool.
+class TaskGroup
+{
+  public:
+  /// @brief - Create a new group submitting its tasks to the input pool.
+  /// @param pool - the pool executing the tasks.
+  /// @param priority - the priority of the tasks submitted through this group.
+  TaskGroup(ThreadPool &pool, const Priority priority = Priority::Normal);
+
+  /// @brief - Wait for all the tasks of the group to complete. Exceptions raised
+  /// by the tasks are ignored at this point: use `wait` to get them.
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  /// @brief - Submit a new callable to the pool as part of this group. Can be
+  /// called from any thread, including from a task of the group.
+  /// @param func - the callable to execute.
+  template<typename F>
+  void run(F &&func);
+
+  /// @brief - Similar to `run` but overrides the priority of the group for
+  /// this task.
+  /// @param func - the callable to execute.
+  /// @param priority - the priority of the task.
+  template<typename F>
+  void run(F &&func, const Priority priority);
+
+  /// @brief - Wait for all the tasks submitted so far to complete. In case one
+  /// of them raised an exception it is rethrown here. In case a task has been
+  /// discarded by the pool (see `ThreadPool::cancelJobs`) an exception is also
+  /// raised.
+  void wait();
+
+  /// @brief - Whether some tasks were discarded by the pool before they could
+  /// run during the last call to `wait`.
+  /// @return - `true` if at least one task was cancelled.
+  bool cancelled() const noexcept;
+
+  private:
+  /// @brief - The state of the group, shared with the tasks so that they can
+  /// safely notify their completion even if the group itself is destroyed as
+  /// soon as the last of them is done.
+  struct State
+  {
+    /// @brief - Register the completion of a task.
+    void finish() noexcept;
+
+    /// @brief - Register the failure of a task. Only the first failure is kept.
+    /// @param exception - the exception raised by the task.
+    void fail(std::exception_ptr exception) noexcept;
+
+    std::atomic<std::size_t> pending{0u};
+    std::atomic_bool failed{false};
+    std::atomic_bool cancelled{false};
+    std::exception_ptr exception{};
+  };
+
+  /// @brief - Attached to each task submitted to the pool. It notifies the group
+  /// when the task completes, or when it is destroyed without having been run.
+  class Ticket
+  {
+    public:
+    Ticket(std::shared_ptr<State> state) noexcept;
+    Ticket(Ticket &&rhs) noexcept = default;
+    ~Ticket();
+
+    /// @brief - Run the input callable and notify the group.
+    /// @param func - the callable to run.
+    template<typename F>
+    void execute(F &func) noexcept;
+
+    private:
+    std::shared_ptr<State> m_state;
+  };
+
+  /// @brief - Used to block until no task of the group is pending anymore while
+  /// executing pending jobs of the pool.
+  void waitForTasks();
+
+  private:
+  ThreadPool &m_pool;
+  Priority m_priority;
+  std::shared_ptr<State> m_state;
+  bool m_cancelled{false};
+};
+
+} // namespace utils
+
+#include "TaskGroup.hxx"
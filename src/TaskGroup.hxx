@@ -0,0 +1,42 @@
+#pragma once
+
+#include "TaskGroup.hh"
+#include "ThreadPool.hh"
+
+namespace utils {
+
+template<typename F>
+inline void TaskGroup::run(F &&func)
+{
+  run(std::forward<F>(func), m_priority);
+}
+
+template<typename F>
+inline void TaskGroup::run(F &&func, const Priority priority)
+{
+  m_state->pending.fetch_add(1u, std::memory_order_relaxed);
+
+  auto task = [ticket = Ticket(m_state), func = std::forward<F>(func)]() mutable {
+    ticket.execute(func);
+  };
+
+  m_pool.post(std::move(task), priority);
+}
+
+template<typename F>
+inline void TaskGroup::Ticket::execute(F &func) noexcept
+{
+  try
+  {
+    func();
+  }
+  catch (...)
+  {
+    m_state->fail(std::current_exception());
+  }
+
+  auto state = std::move(m_state);
+  state->finish();
+}
+
+} // namespace utils
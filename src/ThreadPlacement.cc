@@ -0,0 +1,215 @@
+#include "ThreadPlacement.hh"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+namespace utils {
+namespace {
+
+/// @brief - Where the system describes the memory nodes of the machine.
+const std::string NODES_DIRECTORY = "/sys/devices/system/node/node";
+
+/// @brief - The list of the memory nodes online, which might not be contiguous.
+const std::string ONLINE_NODES = "/sys/devices/system/node/online";
+
+/// @brief - Parse a list of CPUs in the format used by the kernel, such as
+/// `0-3,8,10-11`. Invalid entries are ignored.
+auto parseCpuList(const std::string &list) -> std::vector<unsigned>
+{
+  std::vector<unsigned> out;
+
+  std::istringstream in(list);
+  std::string range;
+  while (std::getline(in, range, ','))
+  {
+    try
+    {
+      const auto dash  = range.find('-');
+      const auto first = std::stoul(range.substr(0u, dash));
+      const auto last  = (dash == std::string::npos ? first : std::stoul(range.substr(dash + 1u)));
+
+      for (auto cpu = first; cpu <= last; ++cpu)
+      {
+        out.push_back(static_cast<unsigned>(cpu));
+      }
+    }
+    catch (const std::exception &)
+    {
+      // Ignore malformed entries.
+    }
+  }
+
+  return out;
+}
+
+/// @brief - The CPUs the process is allowed to run on.
+auto allowedCpus() -> std::vector<unsigned>
+{
+  std::vector<unsigned> out;
+
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0)
+  {
+    for (auto cpu = 0u; cpu < CPU_SETSIZE; ++cpu)
+    {
+      if (CPU_ISSET(cpu, &set))
+      {
+        out.push_back(cpu);
+      }
+    }
+  }
+#endif
+
+  if (out.empty())
+  {
+    const auto count = std::max(std::thread::hardware_concurrency(), 1u);
+    for (auto cpu = 0u; cpu < count; ++cpu)
+    {
+      out.push_back(cpu);
+    }
+  }
+
+  return out;
+}
+
+} // namespace
+
+auto CpuTopology::nodeOf(const unsigned cpu) const noexcept -> std::optional<unsigned>
+{
+  for (auto node = 0u; node < nodes.size(); ++node)
+  {
+    if (std::find(nodes[node].begin(), nodes[node].end(), cpu) != nodes[node].end())
+    {
+      return node;
+    }
+  }
+
+  return {};
+}
+
+auto detectCpuTopology() -> CpuTopology
+{
+  CpuTopology out;
+  const auto allowed = allowedCpus();
+
+  // The list of nodes uses the same format as the lists of CPUs.
+  std::ifstream online(ONLINE_NODES);
+  std::string nodes;
+  std::getline(online, nodes);
+
+  for (const auto node : parseCpuList(nodes))
+  {
+    std::ifstream in(NODES_DIRECTORY + std::to_string(node) + "/cpulist");
+    if (!in.is_open())
+    {
+      continue;
+    }
+
+    std::string list;
+    std::getline(in, list);
+
+    auto cpus = parseCpuList(list);
+    const auto forbidden = [&allowed](const unsigned cpu) {
+      return std::find(allowed.begin(), allowed.end(), cpu) == allowed.end();
+    };
+    cpus.erase(std::remove_if(cpus.begin(), cpus.end(), forbidden), cpus.end());
+
+    if (out.nodes.size() <= node)
+    {
+      out.nodes.resize(node + 1u);
+    }
+    out.nodes[node] = std::move(cpus);
+  }
+
+  const auto empty = std::all_of(out.nodes.begin(), out.nodes.end(), [](const auto &cpus) {
+    return cpus.empty();
+  });
+  if (empty)
+  {
+    out.nodes = {allowed};
+  }
+
+  return out;
+}
+
+auto assignCpus(const CpuTopology &topology, const ThreadPlacement &placement, const unsigned count)
+  -> std::vector<std::optional<unsigned>>
+{
+  std::vector<std::optional<unsigned>> out(count);
+
+  // Only keep the nodes with some CPUs.
+  std::vector<const std::vector<unsigned> *> nodes;
+  for (const auto &cpus : topology.nodes)
+  {
+    if (!cpus.empty())
+    {
+      nodes.push_back(&cpus);
+    }
+  }
+
+  switch (placement.policy)
+  {
+    case PlacementPolicy::Compact:
+    {
+      std::vector<unsigned> cpus;
+      for (const auto *node : nodes)
+      {
+        cpus.insert(cpus.end(), node->begin(), node->end());
+      }
+
+      for (auto id = 0u; id < count && !cpus.empty(); ++id)
+      {
+        out[id] = cpus[id % cpus.size()];
+      }
+      break;
+    }
+    case PlacementPolicy::Scatter:
+      for (auto id = 0u; id < count && !nodes.empty(); ++id)
+      {
+        const auto &cpus = *nodes[id % nodes.size()];
+        out[id]          = cpus[(id / nodes.size()) % cpus.size()];
+      }
+      break;
+    case PlacementPolicy::Explicit:
+      for (auto id = 0u; id < count && !placement.cpus.empty(); ++id)
+      {
+        out[id] = placement.cpus[id % placement.cpus.size()];
+      }
+      break;
+    case PlacementPolicy::None:
+    default:
+      break;
+  }
+
+  return out;
+}
+
+bool pinThread(std::thread &thread, const unsigned cpu) noexcept
+{
+#if defined(__linux__)
+  if (cpu >= CPU_SETSIZE)
+  {
+    return false;
+  }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+
+  return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+  (void)thread;
+  (void)cpu;
+  return false;
+#endif
+}
+
+} // namespace utils
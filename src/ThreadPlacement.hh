@@ -0,0 +1,66 @@
+#pragma once
+
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+/// @brief - Defines how the threads of a pool are pinned to the CPUs:
+///  - none: the threads are not pinned and the kernel is free to migrate them.
+///  - compact: the threads fill the CPUs of the first node before moving to the
+///    next one. Suited for jobs sharing a lot of data.
+///  - scatter: the threads are distributed in a round-robin fashion across the
+///    nodes. Suited for memory bandwidth bound jobs.
+///  - explicit: the threads are pinned to the list of CPUs provided by the user.
+enum class PlacementPolicy { None, Compact, Scatter, Explicit };
+
+/// @brief - The placement of the threads of a pool.
+struct ThreadPlacement
+{
+  PlacementPolicy policy{PlacementPolicy::None};
+
+  /// @brief - The CPUs to use with the explicit policy. Threads are assigned
+  /// to them in order, wrapping around in case there are more threads than
+  /// CPUs. Ignored by the other policies.
+  std::vector<unsigned> cpus{};
+};
+
+/// @brief - Describes the CPUs available to the process, grouped by memory node.
+struct CpuTopology
+{
+  /// @brief - The CPUs of each node, indexed by the identifier of the node as
+  /// reported by the system. A node might be empty in case none of its CPUs
+  /// can be used by the process, or in case the identifiers of the nodes are
+  /// not contiguous and no node has this identifier.
+  std::vector<std::vector<unsigned>> nodes{};
+
+  /// @brief - Retrieve the node to which the input CPU belongs.
+  /// @param cpu - the identifier of the CPU.
+  /// @return - the node of the CPU or an empty value if it is unknown.
+  auto nodeOf(const unsigned cpu) const noexcept -> std::optional<unsigned>;
+};
+
+/// @brief - Fetch the topology of the machine from `/sys/devices/system/node`.
+/// Only the CPUs the process is allowed to run on are considered. In case the
+/// information is not available all these CPUs are reported as part of a single
+/// node.
+/// @return - the topology of the machine.
+auto detectCpuTopology() -> CpuTopology;
+
+/// @brief - Compute the CPU each thread of a pool should be pinned to.
+/// @param topology - the topology of the machine.
+/// @param placement - the placement policy.
+/// @param count - the number of threads to place.
+/// @return - for each thread, the CPU to pin it to or an empty value in case
+/// it should not be pinned.
+auto assignCpus(const CpuTopology &topology, const ThreadPlacement &placement, const unsigned count)
+  -> std::vector<std::optional<unsigned>>;
+
+/// @brief - Restrict the input thread to run on the specified CPU.
+/// @param thread - the thread to pin.
+/// @param cpu - the CPU to pin the thread to.
+/// @return - `true` if the thread could be pinned.
+bool pinThread(std::thread &thread, const unsigned cpu) noexcept;
+
+} // namespace utils
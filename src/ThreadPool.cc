@@ -1,103 +1,276 @@
 
 #include "ThreadPool.hh"
+#include <algorithm>
 
 namespace utils {
 constexpr auto MINIMUM_NUMBER_OF_THREADS = 3u;
 
+/// @brief - The maximum number of jobs moved at once from the shared queues to
+/// the local queue of a thread in work stealing mode.
+constexpr auto MAXIMUM_REFILL_CHUNK = 32u;
+
+/// @brief - The priorities of jobs, ordered from the most urgent to the least.
+constexpr std::array<Priority, 3u> PRIORITIES_BY_URGENCY = {Priority::High,
+                                                            Priority::Normal,
+                                                            Priority::Low};
+
+/// @brief - The number of times an idle thread checks for new jobs while spinning,
+/// and then while yielding, before going to sleep.
+constexpr auto SPIN_ITERATIONS  = 64u;
+constexpr auto YIELD_ITERATIONS = 16u;
+
+/// @brief - How long jobs should wait with all the threads busy before an elastic
+/// pool creates a new thread.
+constexpr auto GROWTH_DELAY = std::chrono::milliseconds(2);
+
+/// @brief - In work stealing mode, the number of jobs a thread fetches before
+/// looking for aged jobs in the shared queues.
+constexpr auto AGING_CHECK_PERIOD = 16u;
+
 using Guard = std::lock_guard<std::mutex>;
 
-ThreadPool::ThreadPool(const unsigned size)
+namespace {
+/// @brief - The task resuming a coroutine suspended by `schedule`. It owns the
+/// coroutine: in case the task is destroyed without running, the coroutine is
+/// resumed anyway after flagging the operation as cancelled, so that it throws
+/// instead of leaking its frame and blocking whoever waits for it.
+class Resumption
+{
+  public:
+  Resumption(std::coroutine_handle<> awaiting, bool &cancelled) noexcept
+    : m_awaiting(awaiting)
+    , m_cancelled(&cancelled)
+  {}
+
+  Resumption(Resumption &&rhs) noexcept
+    : m_awaiting(std::exchange(rhs.m_awaiting, {}))
+    , m_cancelled(rhs.m_cancelled)
+  {}
+
+  Resumption(const Resumption &) = delete;
+  Resumption &operator=(const Resumption &) = delete;
+  Resumption &operator=(Resumption &&) = delete;
+
+  ~Resumption()
+  {
+    if (m_awaiting)
+    {
+      *m_cancelled = true;
+      m_awaiting.resume();
+    }
+  }
+
+  void operator()()
+  {
+    std::exchange(m_awaiting, {}).resume();
+  }
+
+  private:
+  std::coroutine_handle<> m_awaiting;
+  bool *m_cancelled;
+};
+} // namespace
+
+/// @brief - The name of the callables in the traces.
+constexpr auto TASK_TRACE_NAME = "task";
+
+/// @brief - The categories of the events in the traces.
+inline auto traceCategory(const Priority priority) noexcept -> const char *
+{
+  switch (priority)
+  {
+    case Priority::High:
+      return "high";
+    case Priority::Normal:
+      return "normal";
+    case Priority::Low:
+    default:
+      return "low";
+  }
+}
+
+inline auto toDurationStats(const LatencyHistogram &histogram) noexcept -> DurationStats
+{
+  DurationStats out;
+  out.jobs = histogram.count();
+  out.p50  = histogram.percentile(0.5);
+  out.p90  = histogram.percentile(0.9);
+  out.p99  = histogram.percentile(0.99);
+  out.max  = histogram.max();
+
+  return out;
+}
+
+/// @brief - Hint the processor that the calling thread is busy waiting.
+inline void cpuRelax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+ThreadPool::ThreadPool(const unsigned size,
+                       const SchedulingMode mode,
+                       const ThreadPlacement &placement)
+  : ThreadPool(PoolSizing{size == 0u ? MINIMUM_NUMBER_OF_THREADS : size,
+                          size == 0u ? MINIMUM_NUMBER_OF_THREADS : size,
+                          {}},
+               mode,
+               placement)
+{}
+
+ThreadPool::ThreadPool(const PoolSizing &sizing,
+                       const SchedulingMode mode,
+                       const ThreadPlacement &placement)
   : CoreObject("threadpool")
+  , m_mode(mode)
 {
   setService("pool");
-  createThreadPool(size == 0u ? MINIMUM_NUMBER_OF_THREADS : size);
+
+  m_sizing.minThreads  = std::max(sizing.minThreads, 1u);
+  m_sizing.maxThreads  = std::max(sizing.maxThreads, m_sizing.minThreads);
+  m_sizing.idleTimeout = sizing.idleTimeout;
+
+  createThreadPool(placement);
 }
 
 ThreadPool::~ThreadPool()
 {
   terminateThreads();
+
+  // Drop the jobs left while the pool is still alive, as coroutines may
+  // be resumed when they are destroyed.
+  std::vector<Job> dropped;
+  {
+    Guard guard(m_jobsLocker);
+    clearJobs(dropped);
+  }
 }
 
 void ThreadPool::notifyJobs()
 {
-  // Protect from concurrent accesses.
-  UniqueGuard guard(m_poolLocker);
-  Guard guard2(m_jobsLocker);
+  std::size_t pending = 0u;
 
-  // Determine whether some jobs have to be processed.
-  if (!hasJobs())
   {
-    warn("Tried to start jobs processing but none are defined");
-    return;
-  }
+    // Protect from concurrent accesses.
+    Guard guard(m_jobsLocker);
+
+    // Determine whether some jobs have to be processed.
+    pending = pendingJobs();
+    if (pending == 0u)
+    {
+      warn("Tried to start jobs processing but none are defined");
+      return;
+    }
 
-  // Indicate that some jobs are available.
-  m_jobsAvailable = true;
+    // Indicate that some jobs are available.
+    m_jobsAvailable = true;
+  }
 
-  // Notify working threads.
-  m_waiter.notify_all();
+  // Notify working threads: there's no need to wake up more of them
+  // than there are jobs.
+  wakeThreads(pending);
+  growIfNeeded(pending);
 }
 
-void ThreadPool::enqueueJobs(const std::vector<AsynchronousJobShPtr> &jobs, const bool invalidate)
+template<typename Range>
+void ThreadPool::pushJobs(Range &jobs, const bool invalidate, std::vector<Job> &dropped)
 {
-  // Protect from concurrent accesses.
-  Guard guard(m_jobsLocker);
-
   // Invalidate jobs if needed: this include all the remaining jobs to process
   // but also notification about the ones currently being processed.
   if (invalidate)
   {
-    m_hPrioJobs.clear();
-    m_nPrioJobs.clear();
-    m_lPrioJobs.clear();
+    clearJobs(dropped);
+    m_purgeIndex.fetch_add(1u, std::memory_order_release);
   }
 
+  // Make room for the whole batch at once rather than growing the
+  // queues while the jobs are pushed.
+  std::array<std::size_t, PRIORITIES_COUNT> counts{};
+  for (const auto &job : jobs)
   {
-    Guard guard(m_resultsLocker);
-    m_invalidateOld = invalidate;
+    if (job != nullptr)
+    {
+      ++counts[static_cast<int>(job->getPriority())];
+    }
+  }
+
+  for (const auto priority : PRIORITIES_BY_URGENCY)
+  {
+    auto &queue = queueFor(priority);
+    queue.reserve(queue.size() + counts[static_cast<int>(priority)]);
   }
 
   // Build the job by providing the batch index for these jobs.
-  for (unsigned id = 0u; id < jobs.size(); ++id)
+  const auto batch = m_batchIndex.load(std::memory_order_relaxed);
+  const auto purge = m_purgeIndex.load(std::memory_order_relaxed);
+  const auto now   = std::chrono::steady_clock::now();
+
+  auto id = 0u;
+  for (auto &job : jobs)
   {
     // Consistency check.
-    if (jobs[id] == nullptr)
+    if (job == nullptr)
     {
       warn("Discarding invalid null job " + std::to_string(id));
+      ++id;
       continue;
     }
 
-    std::vector<Job> *queue = nullptr;
+    auto &queue = queueFor(job->getPriority(), job->getNodeHint());
+    auto entry  = Job{.batch    = batch,
+                     .purge    = purge,
+                     .priority = job->getPriority(),
+                     .enqueued = now,
+                     .deadline = job->getDeadline()};
 
-    switch (jobs[id]->getPriority())
+    if constexpr (std::is_const_v<std::remove_reference_t<decltype(job)>>)
     {
-      case Priority::High:
-        queue = &m_hPrioJobs;
-        break;
-      case Priority::Normal:
-        queue = &m_nPrioJobs;
-        break;
-      case Priority::Low:
-      default:
-        // Assume low priority for unhandled priority.
-        queue = &m_lPrioJobs;
-        break;
+      entry.task = job;
     }
-
-    if (queue == nullptr)
+    else
     {
-      warn("Could not find adequate queue for job \"" + jobs[id]->getName() + "\" with priority "
-           + std::to_string(static_cast<int>(jobs[id]->getPriority())));
-
-      continue;
+      entry.task = std::move(job);
     }
 
-    queue->push_back(Job{jobs[id], m_batchIndex});
+    queue.push(std::move(entry));
+
+    ++id;
+  }
+}
+
+void ThreadPool::enqueueJobs(std::span<const AsynchronousJobShPtr> jobs, const bool invalidate)
+{
+  // Dropped jobs are destroyed once the locker is released.
+  std::vector<Job> dropped;
+
+  // Protect from concurrent accesses.
+  Guard guard(m_jobsLocker);
+  m_invalidateOld.store(invalidate, std::memory_order_relaxed);
+  pushJobs(jobs, invalidate, dropped);
+}
+
+void ThreadPool::enqueueJobs(std::vector<AsynchronousJobShPtr> &&jobs, const bool invalidate)
+{
+  std::vector<Job> dropped;
+
+  {
+    // Protect from concurrent accesses.
+    Guard guard(m_jobsLocker);
+    m_invalidateOld.store(invalidate, std::memory_order_relaxed);
+    pushJobs(jobs, invalidate, dropped);
   }
+
+  jobs.clear();
 }
 
 void ThreadPool::cancelJobs()
 {
+  // Dropped jobs are destroyed once the lockers are released.
+  std::vector<Job> dropped;
+
   // Protect from concurrent accesses.
   UniqueGuard guard(m_poolLocker);
   Guard guard2(m_jobsLocker);
@@ -105,225 +278,1771 @@ void ThreadPool::cancelJobs()
   // Clear the internal queue so that no more jobs can be fetched.
   m_jobsAvailable = false;
 
-  const auto count = m_hPrioJobs.size() + m_nPrioJobs.size() + m_lPrioJobs.size();
+  const auto count = pendingJobs();
   debug("Clearing " + std::to_string(count) + " remaining job(s), next batch will be "
         + std::to_string(m_batchIndex));
 
-  m_hPrioJobs.clear();
-  m_nPrioJobs.clear();
-  m_lPrioJobs.clear();
+  clearJobs(dropped);
+  m_purgeIndex.fetch_add(1u, std::memory_order_release);
 
   // Increment the batch index to mark any currently processing job
   // as invalid when it will complete.
   ++m_batchIndex;
 }
 
-void ThreadPool::createThreadPool(const unsigned size)
+auto ThreadPool::enqueueJobAt(AsynchronousJobShPtr job, const TimeStamp &when) -> TimerId
 {
-  // Create the results handling thread.
-  {
-    Guard guard(m_resultsLocker);
-    m_resultsHandling = true;
-  }
-  {
-    Guard guard(m_resultsThreadLocker);
-    m_resultsHandlingThread = std::thread(&ThreadPool::resultsHandlingLoop, this);
-  }
+  const auto delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    when - utils::now());
+  return addTimer(std::move(job), std::chrono::steady_clock::now() + delay, 0u);
+}
 
-  // Start the pool.
+auto ThreadPool::enqueueJobAfter(AsynchronousJobShPtr job, const Duration &delay) -> TimerId
+{
+  const auto steadyDelay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay);
+  return addTimer(std::move(job), std::chrono::steady_clock::now() + steadyDelay, 0u);
+}
+
+auto ThreadPool::enqueueJobEvery(AsynchronousJobShPtr job,
+                                 const Duration &period,
+                                 const std::optional<TimeStamp> &first) -> TimerId
+{
+  const auto ticks = std::chrono::ceil<std::chrono::milliseconds>(period).count();
+  if (ticks <= 0)
   {
-    UniqueGuard guard(m_poolLocker);
-    m_poolRunning = true;
+    error("Failed to register periodic job", "Invalid period " + durationToMsString(period));
   }
 
-  // Protect from concurrent creation of the pool.
-  Guard guard(m_threadsLocker);
+  const auto delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    first ? *first - utils::now() : period);
+  return addTimer(std::move(job),
+                  std::chrono::steady_clock::now() + delay,
+                  static_cast<std::uint64_t>(ticks));
+}
 
-  m_threads.resize(size);
-  for (unsigned id = 0u; id < m_threads.size(); ++id)
-  {
-    m_threads[id] = std::thread(&ThreadPool::jobFetchingLoop, this, id);
-  }
+bool ThreadPool::cancelTimer(const TimerId id)
+{
+  // The timers thread is not woken up: in case the timer was the next
+  // to expire it just finds nothing to enqueue.
+  Guard guard(m_timersLocker);
+  return m_timers.cancel(id);
 }
 
-void ThreadPool::terminateThreads()
+auto ThreadPool::pendingTimers() const -> std::size_t
 {
-  m_poolLocker.lock();
+  Guard guard(m_timersLocker);
+  return m_timers.size();
+}
 
-  // If no threads are created, nothing to do.
-  if (!m_poolRunning)
+void ThreadPool::dispatch(SmallTask &&task)
+{
+  enqueueTask(std::move(task), Priority::Normal);
+}
+
+ThreadPool::ScheduleOperation::ScheduleOperation(ThreadPool &pool, const Priority priority) noexcept
+  : m_pool(pool)
+  , m_priority(priority)
+{}
+
+bool ThreadPool::ScheduleOperation::await_ready() const noexcept
+{
+  return false;
+}
+
+void ThreadPool::ScheduleOperation::await_suspend(std::coroutine_handle<> awaiting)
+{
+  m_pool.enqueueTask(SmallTask(Resumption(awaiting, m_cancelled)), m_priority);
+}
+
+void ThreadPool::ScheduleOperation::await_resume() const
+{
+  if (m_cancelled)
   {
-    m_poolLocker.unlock();
-    return;
+    throw CoreException("Failed to resume coroutine",
+                        "pool",
+                        "utils",
+                        std::string("Scheduled resumption was cancelled"));
   }
+}
 
-  // Ask the threads to stop.
-  m_poolRunning = false;
-  m_poolLocker.unlock();
-  m_waiter.notify_all();
+auto ThreadPool::schedule(const Priority priority) noexcept -> ScheduleOperation
+{
+  return ScheduleOperation(*this, priority);
+}
+
+bool ThreadPool::runPendingJob()
+{
+  Job job{};
+  auto found = false;
 
-  // Wait for all threads to finish.
-  Guard guard(m_threadsLocker);
-  for (unsigned id = 0u; id < m_threads.size(); ++id)
   {
-    m_threads[id].join();
+    Guard guard(m_jobsLocker);
+    found = popJob({}, job);
   }
 
-  m_threads.clear();
-
-  // Now terminate the results handling thread.
+  if (found)
   {
-    m_resultsLocker.lock();
+    processJob(job, externalLane());
+    return true;
+  }
 
-    // If the results thread is not started we don't have
-    // to do anything.
-    if (!m_resultsHandling)
+  // In work stealing mode the jobs might also sit in the local
+  // queues of the threads.
+  for (const auto priority : PRIORITIES_BY_URGENCY)
+  {
+    for (auto &worker : m_workers)
     {
-      m_resultsLocker.unlock();
-      return;
-    }
+      std::unique_ptr<Job> stolen(worker->queues[static_cast<int>(priority)].steal());
+      if (stolen == nullptr)
+      {
+        continue;
+      }
 
-    // Stop the thread and wait for its termination.
-    m_resultsHandling = false;
-    m_resWaiter.notify_all();
-    m_resultsLocker.unlock();
+      m_counters[externalLane()].steals.fetch_add(1u, std::memory_order_relaxed);
+      if (stolen->purge == m_purgeIndex.load(std::memory_order_acquire))
+      {
+        processJob(*stolen, externalLane());
+      }
 
-    Guard guard3(m_resultsThreadLocker);
-    m_resultsHandlingThread.join();
+      return true;
+    }
   }
+
+  return false;
 }
 
-void ThreadPool::jobFetchingLoop(const unsigned threadId)
+auto ThreadPool::size() const -> unsigned
 {
-  verbose("Creating thread " + std::to_string(threadId) + " for thread pool");
-
-  // Create the locker to use to wait for job to do.
-  UniqueGuard tLock(m_poolLocker);
-
-  while (m_poolRunning)
-  {
-    // Wait until either we are requested to stop or there are some
-    // new jobs to process. Checking both conditions prevents us from
-    // being falsely waked up (see spurious wakeups).
-    m_waiter.wait(tLock, [&]() { return !m_poolRunning || m_jobsAvailable; });
+  return m_activeThreads.load(std::memory_order_relaxed);
+}
 
-    // Check whether we need to process some jobs or exit the process.
-    if (!m_poolRunning)
-    {
-      break;
-    }
+auto ThreadPool::topology() const noexcept -> const CpuTopology &
+{
+  return m_topology;
+}
 
-    // Attempt to retrieve a job to process.
-    Job job               = Job{nullptr, 0u};
-    unsigned batch        = 0u;
-    std::size_t remaining = 0u;
+auto ThreadPool::batchIndex() const noexcept -> unsigned
+{
+  return m_batchIndex.load(std::memory_order_acquire);
+}
 
-    {
-      Guard guard(m_jobsLocker);
+auto ThreadPool::cancellationToken(const unsigned batch,
+                                   const std::optional<TimeStamp> &deadline) const noexcept
+  -> CancellationToken
+{
+  return CancellationToken(m_batchIndex, batch, nullptr, deadline);
+}
 
-      // Fetch the highest priority job available.
-      if (!m_hPrioJobs.empty())
-      {
-        job = m_hPrioJobs.back();
-        m_hPrioJobs.pop_back();
-      }
-      else if (!m_nPrioJobs.empty())
-      {
-        job = m_nPrioJobs.back();
-        m_nPrioJobs.pop_back();
-      }
-      else if (!m_lPrioJobs.empty())
-      {
-        job = m_lPrioJobs.back();
-        m_lPrioJobs.pop_back();
-      }
+void ThreadPool::setResultsBatching(const unsigned maxBatch,
+                                    const std::chrono::microseconds maxDelay)
+{
+  // A batch larger than the results queue could never be filled.
+  m_maxBatch.store(std::clamp(maxBatch, 1u, RESULTS_QUEUE_CAPACITY), std::memory_order_relaxed);
+  m_maxDelay.store(std::max(maxDelay.count(), std::chrono::microseconds::rep{0}),
+                   std::memory_order_relaxed);
+}
 
-      m_jobsAvailable = hasJobs();
-      batch           = m_batchIndex;
+auto ThreadPool::completionStats() const noexcept -> CompletionStats
+{
+  CompletionStats out{};
 
-      remaining = m_hPrioJobs.size() + m_nPrioJobs.size() + m_lPrioJobs.size();
-    }
+  out.emissions    = m_emissions.load(std::memory_order_relaxed);
+  out.jobs         = m_notifiedJobs.load(std::memory_order_relaxed);
+  out.discarded    = m_discardedJobs.load(std::memory_order_relaxed);
+  out.totalLatency = std::chrono::nanoseconds(m_totalLatency.load(std::memory_order_relaxed));
+  out.maxLatency   = std::chrono::nanoseconds(m_maxLatency.load(std::memory_order_relaxed));
 
-    // Unlock the pool mutex so that we don't block other threads while
-    // processing our chunk of job. This is what effectively allows for
-    // concurrency.
-    tLock.unlock();
+  return out;
+}
 
-    // If we could fetch something process it.
-    if (job.task != nullptr)
-    {
-      verbose("Processing job for batch " + std::to_string(batch) + " in thread "
-              + std::to_string(threadId) + " (remaining: " + std::to_string(remaining) + ")");
+void ThreadPool::setJobOrdering(const JobOrdering ordering)
+{
+  Guard guard(m_jobsLocker);
 
-      job.task->compute();
+  m_ordering = ordering;
 
-      // Notify the main thread about the result.
-      UniqueGuard guard(m_resultsLocker);
-      m_results.push_back(job);
+  m_hPrioJobs.setOrdering(ordering);
+  m_nPrioJobs.setOrdering(ordering);
+  m_lPrioJobs.setOrdering(ordering);
 
-      m_resWaiter.notify_one();
+  for (auto &queues : m_nodeJobs)
+  {
+    for (auto &queue : queues)
+    {
+      queue.setOrdering(ordering);
     }
+  }
+}
 
-    // Once the job is done, reacquire the mutex in order to re-wait on
-    // the condition variable.
-    tLock.lock();
+void ThreadPool::setAging(const std::chrono::milliseconds threshold)
+{
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(threshold).count();
+  m_agingThreshold.store(std::max(ns, std::chrono::nanoseconds::rep{0}), std::memory_order_relaxed);
+}
+
+auto ThreadPool::waitTimeStats(const Priority priority) const noexcept -> WaitTimeStats
+{
+  LatencyHistogram histogram;
+  for (unsigned lane = 0u; lane <= externalLane(); ++lane)
+  {
+    histogram.merge(m_counters[lane].waitTimes[static_cast<int>(priority)]);
   }
 
-  verbose("Terminating thread " + std::to_string(threadId) + " for scheduler pool");
+  return toDurationStats(histogram);
 }
 
-void ThreadPool::resultsHandlingLoop()
+auto ThreadPool::stats() const -> PoolStats
 {
-  // Create the locker to use to wait for results to be processed.
-  UniqueGuard rLock(m_resultsLocker);
+  PoolStats out{};
 
-  while (m_resultsHandling)
+  LatencyHistogram executionTimes;
+  std::array<LatencyHistogram, PRIORITIES_COUNT> waitTimes;
+  auto interruptedTime = std::chrono::nanoseconds{0};
+
+  for (unsigned lane = 0u; lane <= externalLane(); ++lane)
   {
-    // Wait until either we are requested to stop or there are some
-    // new results to analyze. Checking both conditions prevents us
-    // from being falsely waked up (see spurious wakeups).
-    m_resWaiter.wait(rLock, [&]() { return !m_resultsHandling || !m_results.empty(); });
+    const auto &counters = m_counters[lane];
 
-    // Check whether we need to process some jobs or exit the process.
-    if (!m_resultsHandling)
+    ThreadStats thread{};
+    thread.jobs   = counters.jobs.load(std::memory_order_relaxed);
+    thread.steals = counters.steals.load(std::memory_order_relaxed);
+    thread.parks  = counters.parks.load(std::memory_order_relaxed);
+    thread.busy   = std::chrono::nanoseconds(counters.busy.load(std::memory_order_relaxed));
+
+    out.total.jobs += thread.jobs;
+    out.total.steals += thread.steals;
+    out.total.parks += thread.parks;
+    out.total.busy += thread.busy;
+    out.threads.push_back(thread);
+
+    executionTimes.merge(counters.executionTimes);
+
+    auto &cancellation = out.cancellation;
+    cancellation.interrupted += counters.interrupted.load(std::memory_order_relaxed);
+    cancellation.stale += counters.stale.load(std::memory_order_relaxed);
+    cancellation.late += counters.late.load(std::memory_order_relaxed);
+    cancellation.wasted += std::chrono::nanoseconds(
+      counters.staleTime.load(std::memory_order_relaxed));
+    interruptedTime += std::chrono::nanoseconds(
+      counters.interruptedTime.load(std::memory_order_relaxed));
+    for (unsigned id = 0u; id < PRIORITIES_COUNT; ++id)
     {
-      break;
+      waitTimes[id].merge(counters.waitTimes[id]);
     }
+  }
 
-    // We want to notify listeners of the new results: to do that we
-    // will copy the existing results to an internal handler, unlock
-    // the mutex to allow for other results to be accumulated and
-    // for longer interpretation processes to occur without ruining
-    // the concurrency brought by the thread pool.
-    std::vector<Job> local;
-    local.swap(m_results);
+  out.executionTimes = toDurationStats(executionTimes);
+  for (unsigned id = 0u; id < PRIORITIES_COUNT; ++id)
+  {
+    out.waitTimes[id] = toDurationStats(waitTimes[id]);
+  }
 
-    // Strip the batch index and keep only the jobs consistent with the
-    // current one.
-    std::vector<AsynchronousJobShPtr> res;
-    for (unsigned id = 0u; id < local.size(); ++id)
-    {
-      if (local[id].batch != m_batchIndex && m_invalidateOld)
-      {
-        debug("Discarding job for old batch " + std::to_string(local[id].batch) + " (current is "
-              + std::to_string(m_batchIndex) + ")");
-        continue;
-      }
+  out.completion = completionStats();
 
-      res.push_back(local[id].task);
-    }
+  // Jobs which ran to completion give an idea of how long the interrupted
+  // ones would have taken.
+  auto &cancellation = out.cancellation;
+  const auto completed = out.total.jobs - cancellation.interrupted;
+  if (cancellation.interrupted > 0u && completed > 0u)
+  {
+    using Rep = std::chrono::nanoseconds::rep;
 
-    // Notify listeners.
-    rLock.unlock();
-    onJobsCompleted.safeEmit(std::string("onJobsCompleted(") + std::to_string(res.size()) + ")",
-                             res);
-    rLock.lock();
+    const auto average  = (out.total.busy - interruptedTime) / static_cast<Rep>(completed);
+    const auto expected = average * static_cast<Rep>(cancellation.interrupted);
+    cancellation.saved  = std::max(expected - interruptedTime, std::chrono::nanoseconds{0});
   }
+
+  return out;
 }
 
-bool ThreadPool::hasJobs() const noexcept
+void ThreadPool::startTracing(const std::size_t capacity)
+{
+  m_tracer->start(capacity);
+}
+
+void ThreadPool::stopTracing() noexcept
 {
-  return !m_hPrioJobs.empty() || !m_nPrioJobs.empty() || !m_lPrioJobs.empty();
+  m_tracer->stop();
+}
+
+void ThreadPool::exportTrace(std::ostream &out) const
+{
+  m_tracer->exportChromeTrace(out);
+}
+
+void ThreadPool::createThreadPool(const ThreadPlacement &placement)
+{
+  // Slots are allocated for the maximum number of threads so that
+  // they don't move when the pool grows.
+  const auto slots = m_sizing.maxThreads;
+
+  // The counters are needed by all the threads, including the results
+  // one: create them first.
+  m_counters = std::make_unique<ThreadCounters[]>(slots + 1u);
+
+  std::vector<std::string> lanes;
+  for (unsigned id = 0u; id < slots; ++id)
+  {
+    lanes.push_back("worker " + std::to_string(id));
+  }
+  lanes.push_back("external");
+  lanes.push_back("results");
+  m_tracer = std::make_unique<TraceRecorder>(lanes);
+
+  // Create the results handling thread.
+  {
+    Guard guard(m_resultsLocker);
+    m_resultsHandling = true;
+  }
+  {
+    Guard guard(m_resultsThreadLocker);
+    m_resultsHandlingThread = std::thread(&ThreadPool::resultsHandlingLoop, this);
+  }
+
+  // Start the pool.
+  {
+    UniqueGuard guard(m_poolLocker);
+    m_poolRunning = true;
+  }
+
+  // Protect from concurrent creation of the pool.
+  Guard guard(m_threadsLocker);
+
+  if (m_mode == SchedulingMode::WorkStealing)
+  {
+    m_workers.resize(slots);
+    for (auto &worker : m_workers)
+    {
+      worker = std::make_unique<Worker>();
+    }
+  }
+
+  // Jobs can only be dispatched to the nodes of the threads when
+  // they are pinned.
+  m_topology   = detectCpuTopology();
+  m_threadCpus = assignCpus(m_topology, placement, slots);
+
+  m_threadNodes.resize(slots);
+  for (unsigned id = 0u; id < slots; ++id)
+  {
+    if (m_threadCpus[id])
+    {
+      m_threadNodes[id] = m_topology.nodeOf(*m_threadCpus[id]);
+    }
+  }
+
+  if (placement.policy != PlacementPolicy::None)
+  {
+    m_nodeJobs.resize(m_topology.nodes.size());
+    m_nodeThreads.resize(m_topology.nodes.size(), 0u);
+    for (auto &queues : m_nodeJobs)
+    {
+      for (auto &queue : queues)
+      {
+        queue.setOrdering(m_ordering);
+      }
+    }
+  }
+
+  m_threads.resize(slots);
+  m_activeSlots.resize(slots, false);
+  for (unsigned id = 0u; id < m_sizing.minThreads; ++id)
+  {
+    spawnThread(id);
+  }
+}
+
+void ThreadPool::spawnThread(const unsigned threadId)
+{
+  // The slot might still hold a thread which terminated because
+  // it was idle.
+  if (m_threads[threadId].joinable())
+  {
+    m_threads[threadId].join();
+  }
+
+  const auto loop = (m_mode == SchedulingMode::WorkStealing ? &ThreadPool::workStealingLoop
+                                                            : &ThreadPool::jobFetchingLoop);
+
+  m_activeSlots[threadId] = true;
+  m_activeThreads.fetch_add(1u, std::memory_order_relaxed);
+
+  if (const auto &node = m_threadNodes[threadId]; node && *node < m_nodeThreads.size())
+  {
+    Guard jobsGuard(m_jobsLocker);
+    ++m_nodeThreads[*node];
+  }
+
+  m_threads[threadId] = std::thread(loop, this, threadId);
+
+  const auto &cpu = m_threadCpus[threadId];
+  if (cpu && !pinThread(m_threads[threadId], *cpu))
+  {
+    warn("Failed to pin thread " + std::to_string(threadId) + " to cpu " + std::to_string(*cpu));
+  }
+}
+
+void ThreadPool::growIfNeeded(const std::size_t pending)
+{
+  if (m_sizing.minThreads == m_sizing.maxThreads)
+  {
+    return;
+  }
+
+  // Jobs only pile up when no thread is idle.
+  const auto idle = m_spinners.load(std::memory_order_relaxed)
+                    + m_sleepers.load(std::memory_order_relaxed);
+  if (pending == 0u || idle > 0u)
+  {
+    m_backlogSince.store(0, std::memory_order_relaxed);
+    return;
+  }
+
+  if (m_activeThreads.load(std::memory_order_relaxed) >= m_sizing.maxThreads)
+  {
+    return;
+  }
+
+  const auto now   = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+                     .count();
+  const auto delay = std::chrono::nanoseconds(GROWTH_DELAY).count();
+
+  auto since = m_backlogSince.load(std::memory_order_relaxed);
+  if (since == 0)
+  {
+    m_backlogSince.compare_exchange_strong(since, now, std::memory_order_relaxed);
+    return;
+  }
+
+  // Only one thread grows the pool, after which the backlog has to
+  // last again for a while before another thread is created.
+  if (now - since < delay
+      || !m_backlogSince.compare_exchange_strong(since, now, std::memory_order_relaxed))
+  {
+    return;
+  }
+
+  // Failing to acquire the lock means that the pool is being resized
+  // or terminated: there's no need to insist.
+  UniqueGuard guard(m_threadsLocker, std::try_to_lock);
+  if (!guard.owns_lock() || !m_poolRunning)
+  {
+    return;
+  }
+
+  for (unsigned id = 0u; id < m_activeSlots.size(); ++id)
+  {
+    if (!m_activeSlots[id])
+    {
+      spawnThread(id);
+      verbose("Growing pool to " + std::to_string(m_activeThreads) + " thread(s)");
+      return;
+    }
+  }
+}
+
+bool ThreadPool::retireThread(const unsigned threadId)
+{
+  // Purged jobs are destroyed once the lockers are released.
+  std::vector<std::unique_ptr<Job>> dropped;
+
+  // Failing to acquire the lock means that the pool is being resized
+  // or terminated: in both cases the thread should stay for now.
+  UniqueGuard guard(m_threadsLocker, std::try_to_lock);
+  if (!guard.owns_lock() || !m_poolRunning
+      || m_activeThreads.load(std::memory_order_relaxed) <= m_sizing.minThreads)
+  {
+    return false;
+  }
+
+  m_activeSlots[threadId] = false;
+  m_activeThreads.fetch_sub(1u, std::memory_order_relaxed);
+
+  verbose("Retiring idle thread " + std::to_string(threadId) + ", pool now has "
+          + std::to_string(m_activeThreads) + " thread(s)");
+
+  const auto &threadNode = m_threadNodes[threadId];
+  const auto pinned       = threadNode && *threadNode < m_nodeThreads.size();
+  if (m_mode != SchedulingMode::WorkStealing && !pinned)
+  {
+    return true;
+  }
+
+  auto moved = 0u;
+
+  {
+    Guard jobsGuard(m_jobsLocker);
+
+    // Jobs of a node without threads would only be fetched once the
+    // shared queues are empty.
+    if (pinned && --m_nodeThreads[*threadNode] == 0u)
+    {
+      for (const auto priority : PRIORITIES_BY_URGENCY)
+      {
+        auto &local = m_nodeJobs[*threadNode][static_cast<int>(priority)];
+        while (!local.empty())
+        {
+          queueFor(priority).push(local.popOldest());
+        }
+      }
+    }
+
+    // Give back the jobs of the local queues so that they don't wait
+    // for a thread to steal them.
+    if (m_mode == SchedulingMode::WorkStealing)
+    {
+      for (const auto priority : PRIORITIES_BY_URGENCY)
+      {
+        auto &local = m_workers[threadId]->queues[static_cast<int>(priority)];
+        while (auto *job = local.pop())
+        {
+          std::unique_ptr<Job> owned(job);
+          if (owned->purge != m_purgeIndex.load(std::memory_order_acquire))
+          {
+            dropped.push_back(std::move(owned));
+            continue;
+          }
+
+          const auto node = (owned->task != nullptr ? owned->task->getNodeHint()
+                                                    : std::optional<unsigned>{});
+          queueFor(priority, node).push(std::move(*owned));
+          ++moved;
+        }
+      }
+    }
+
+    if (moved > 0u)
+    {
+      m_jobsAvailable = true;
+    }
+  }
+
+  wakeThreads(moved);
+
+  return true;
+}
+
+void ThreadPool::terminateThreads()
+{
+  // Jobs of the local queues are destroyed once the lockers are released.
+  std::vector<std::unique_ptr<Job>> dropped;
+
+  // Stop the timers first so that they don't enqueue jobs anymore.
+  {
+    Guard guard(m_timersLocker);
+    m_timersRunning = false;
+  }
+  m_timersWaiter.notify_all();
+
+  if (m_timersThread.joinable())
+  {
+    m_timersThread.join();
+  }
+
+  m_poolLocker.lock();
+
+  // If no threads are created, nothing to do.
+  if (!m_poolRunning)
+  {
+    m_poolLocker.unlock();
+    return;
+  }
+
+  // Ask the threads to stop.
+  m_poolRunning = false;
+  m_poolLocker.unlock();
+  m_waiter.notify_all();
+
+  // Wait for all threads to finish, including the ones which were
+  // terminated because they were idle.
+  Guard guard(m_threadsLocker);
+  for (unsigned id = 0u; id < m_threads.size(); ++id)
+  {
+    if (m_threads[id].joinable())
+    {
+      m_threads[id].join();
+    }
+  }
+
+  m_threads.clear();
+  m_activeSlots.clear();
+  m_activeThreads.store(0u, std::memory_order_relaxed);
+
+  {
+    Guard jobsGuard(m_jobsLocker);
+    std::fill(m_nodeThreads.begin(), m_nodeThreads.end(), 0u);
+  }
+
+  // Release the jobs which might still be sitting in the local queues.
+  for (auto &worker : m_workers)
+  {
+    for (auto &queue : worker->queues)
+    {
+      while (auto *job = queue.pop())
+      {
+        dropped.emplace_back(job);
+      }
+    }
+  }
+
+  // Now terminate the results handling thread.
+  {
+    m_resultsLocker.lock();
+
+    // If the results thread is not started we don't have
+    // to do anything.
+    if (!m_resultsHandling)
+    {
+      m_resultsLocker.unlock();
+      return;
+    }
+
+    // Stop the thread and wait for its termination.
+    m_resultsHandling = false;
+    m_resWaiter.notify_all();
+    m_resultsLocker.unlock();
+
+    Guard guard3(m_resultsThreadLocker);
+    m_resultsHandlingThread.join();
+  }
+}
+
+void ThreadPool::jobFetchingLoop(const unsigned threadId)
+{
+  verbose("Creating thread " + std::to_string(threadId) + " for thread pool");
+
+  while (m_poolRunning.load(std::memory_order_relaxed))
+  {
+    // Attempt to retrieve a job to process.
+    Job job               = Job{};
+    auto found            = false;
+    unsigned batch        = 0u;
+    std::size_t remaining = 0u;
+
+    {
+      Guard guard(m_jobsLocker);
+
+      // Fetch the highest priority job available, favoring the
+      // ones meant to run on the node of this thread.
+      found     = popJob(m_threadNodes[threadId], job);
+      batch     = m_batchIndex;
+      remaining = pendingJobs();
+    }
+
+    // Wait until either we are requested to stop or there are some
+    // new jobs to process.
+    if (!found)
+    {
+      if (!waitForJobs(threadId))
+      {
+        break;
+      }
+
+      continue;
+    }
+
+    growIfNeeded(remaining);
+
+    if (isLogEnabled(log::Severity::VERBOSE))
+    {
+      verbose("Processing job for batch " + std::to_string(batch) + " in thread "
+              + std::to_string(threadId) + " (remaining: " + std::to_string(remaining) + ")");
+    }
+
+    processJob(job, threadId);
+  }
+
+  verbose("Terminating thread " + std::to_string(threadId) + " for scheduler pool");
+}
+
+void ThreadPool::workStealingLoop(const unsigned threadId)
+{
+  verbose("Creating thread " + std::to_string(threadId) + " for thread pool");
+
+  while (m_poolRunning.load(std::memory_order_relaxed))
+  {
+    Job *job = fetchJob(threadId);
+    if (job == nullptr)
+    {
+      if (!waitForJobs(threadId))
+      {
+        break;
+      }
+
+      continue;
+    }
+
+    job = promoteAgedJob(threadId, job);
+
+    // Jobs purged while they were waiting in a local queue are
+    // simply dropped.
+    if (job->purge == m_purgeIndex.load(std::memory_order_acquire))
+    {
+      processJob(*job, threadId);
+    }
+
+    delete job;
+  }
+
+  verbose("Terminating thread " + std::to_string(threadId) + " for scheduler pool");
+}
+
+auto ThreadPool::fetchJob(const unsigned threadId) -> Job *
+{
+  auto &worker = *m_workers[threadId];
+
+  // Favor the local and shared queues in order of priority and only
+  // attempt to steal when both are empty: this keeps the threads
+  // working on their own data as much as possible.
+  for (const auto priority : PRIORITIES_BY_URGENCY)
+  {
+    if (auto *job = worker.queues[static_cast<int>(priority)].pop(); job != nullptr)
+    {
+      return job;
+    }
+
+    if (auto *job = refillLocalJobs(threadId, priority); job != nullptr)
+    {
+      return job;
+    }
+  }
+
+  for (const auto priority : PRIORITIES_BY_URGENCY)
+  {
+    if (auto *job = stealJob(threadId, priority); job != nullptr)
+    {
+      m_counters[threadId].steals.fetch_add(1u, std::memory_order_relaxed);
+      return job;
+    }
+  }
+
+  return nullptr;
+}
+
+auto ThreadPool::promoteAgedJob(const unsigned threadId, Job *job) -> Job *
+{
+  auto &worker = *m_workers[threadId];
+
+  // Looking into the shared queues requires to lock them: only do it
+  // from time to time.
+  if (m_agingThreshold.load(std::memory_order_relaxed) <= 0
+      || ++worker.fetched % AGING_CHECK_PERIOD != 0u)
+  {
+    return job;
+  }
+
+  Job *aged = nullptr;
+
+  {
+    Guard guard(m_jobsLocker);
+
+    auto *queue = agedQueue(m_threadNodes[threadId], job->priority);
+    if (queue == nullptr)
+    {
+      return job;
+    }
+
+    aged            = new Job(queue->popOldest());
+    m_jobsAvailable = hasJobs();
+  }
+
+  worker.queues[static_cast<int>(job->priority)].push(job);
+
+  return aged;
+}
+
+auto ThreadPool::refillLocalJobs(const unsigned threadId, const Priority priority) -> Job *
+{
+  auto &local  = m_workers[threadId]->queues[static_cast<int>(priority)];
+  Job *out     = nullptr;
+  auto count   = 0u;
+  auto pending = std::size_t{0u};
+
+  {
+    Guard guard(m_jobsLocker);
+    auto *queue = nextQueue(priority, m_threadNodes[threadId]);
+    if (queue == nullptr)
+    {
+      return nullptr;
+    }
+
+    // Take a fair share of the jobs so that the other threads can
+    // also refill from the shared queue instead of stealing.
+    const auto share = std::min(queue->size(), queue->size() / m_workers.size() + 1u);
+    count            = std::min<std::size_t>(share, MAXIMUM_REFILL_CHUNK);
+
+    out = new Job(queue->pop());
+
+    // The thread pops the most recent jobs of its local queue first:
+    // push the chunk in reverse order to preserve the ordering.
+    std::array<Job *, MAXIMUM_REFILL_CHUNK> chunk{};
+    for (auto id = 1u; id < count; ++id)
+    {
+      chunk[id] = new Job(queue->pop());
+    }
+    for (auto id = count; id > 1u; --id)
+    {
+      local.push(chunk[id - 1u]);
+    }
+
+    m_jobsAvailable = hasJobs();
+    pending         = pendingJobs();
+  }
+
+  // Wake up sleeping threads so that they can steal the jobs we
+  // just moved to our local queue.
+  if (count > 1u)
+  {
+    wakeThreads(count - 1u);
+  }
+
+  growIfNeeded(pending);
+
+  return out;
+}
+
+auto ThreadPool::stealJob(const unsigned threadId, const Priority priority) -> Job *
+{
+  const auto count = m_workers.size();
+  const auto &node = m_threadNodes[threadId];
+
+  // Steal from the threads of the same node first to keep the data
+  // in the caches of this node.
+  for (const auto sameNode : {true, false})
+  {
+    for (auto offset = 1u; offset < count; ++offset)
+    {
+      const auto victimId = (threadId + offset) % count;
+      if ((m_threadNodes[victimId] == node) != sameNode)
+      {
+        continue;
+      }
+
+      auto &victim = m_workers[victimId]->queues[static_cast<int>(priority)];
+      if (auto *job = victim.steal(); job != nullptr)
+      {
+        return job;
+      }
+    }
+  }
+
+  return nullptr;
+}
+
+bool ThreadPool::waitForJobs(const unsigned threadId)
+{
+  // Jobs often come in bursts: spin for a little while and then yield
+  // before going to sleep as waking up a thread is costly.
+  m_spinners.fetch_add(1u, std::memory_order_relaxed);
+  for (auto it = 0u; it < SPIN_ITERATIONS + YIELD_ITERATIONS; ++it)
+  {
+    if (!m_poolRunning.load(std::memory_order_relaxed) || jobsReady())
+    {
+      break;
+    }
+
+    if (it < SPIN_ITERATIONS)
+    {
+      cpuRelax();
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+  m_spinners.fetch_sub(1u, std::memory_order_relaxed);
+
+  if (!m_poolRunning.load(std::memory_order_relaxed))
+  {
+    return false;
+  }
+  if (jobsReady())
+  {
+    return true;
+  }
+
+  m_counters[threadId].parks.fetch_add(1u, std::memory_order_relaxed);
+  const auto parked = std::chrono::steady_clock::now();
+
+  UniqueGuard tLock(m_poolLocker);
+
+  // The fence pairs with the one in `wakeThreads`: either we see the
+  // jobs or the thread providing them sees that we are sleeping.
+  m_sleepers.fetch_add(1u, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  // Checking both conditions prevents us from being falsely waked
+  // up (see spurious wakeups).
+  const auto ready = [&]() { return !m_poolRunning || jobsReady(); };
+
+  auto woken = true;
+  if (m_sizing.minThreads < m_sizing.maxThreads)
+  {
+    woken = m_waiter.wait_for(tLock, m_sizing.idleTimeout, ready);
+  }
+  else
+  {
+    m_waiter.wait(tLock, ready);
+  }
+
+  m_sleepers.fetch_sub(1u, std::memory_order_relaxed);
+
+  if (m_tracer->enabled())
+  {
+    m_tracer->record(threadId, "park", "idle", parked, std::chrono::steady_clock::now());
+  }
+
+  if (!m_poolRunning)
+  {
+    return false;
+  }
+  if (woken)
+  {
+    return true;
+  }
+
+  // The thread was idle for too long.
+  tLock.unlock();
+  return !retireThread(threadId);
+}
+
+bool ThreadPool::jobsReady() const noexcept
+{
+  return m_jobsAvailable.load(std::memory_order_relaxed)
+         || (m_mode == SchedulingMode::WorkStealing && hasLocalJobs());
+}
+
+void ThreadPool::wakeThreads(const std::size_t count)
+{
+  // The fence pairs with the one in `waitForJobs`.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const auto sleepers = m_sleepers.load(std::memory_order_relaxed);
+  if (sleepers == 0u)
+  {
+    return;
+  }
+
+  UniqueGuard guard(m_poolLocker);
+  for (auto id = std::size_t{0u}; id < std::min<std::size_t>(count, sleepers); ++id)
+  {
+    m_waiter.notify_one();
+  }
+}
+
+void ThreadPool::enqueueTask(SmallTask &&task, const Priority priority)
+{
+  std::size_t pending = 0u;
+
+  {
+    Guard guard(m_jobsLocker);
+
+    auto &queue = queueFor(priority);
+    queue.push(Job{.call     = std::move(task),
+                   .batch    = m_batchIndex,
+                   .purge    = m_purgeIndex.load(std::memory_order_relaxed),
+                   .priority = priority,
+                   .enqueued = std::chrono::steady_clock::now()});
+
+    m_jobsAvailable = true;
+    pending         = pendingJobs();
+  }
+
+  // Only a single thread is needed to process this task.
+  wakeThreads(1u);
+  growIfNeeded(pending);
+}
+
+void ThreadPool::processJob(Job &job, const unsigned lane)
+{
+  const auto start = std::chrono::steady_clock::now();
+  m_counters[lane].waitTimes[static_cast<int>(job.priority)].record(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(start - job.enqueued));
+
+  if (job.task != nullptr)
+  {
+    const CancellationToken token(m_batchIndex, job.batch, &m_invalidateOld, job.deadline);
+    job.task->compute(token);
+    recordExecution(job, lane, start, &token);
+
+    // Notify the main thread about the result.
+    pushResult(std::move(job));
+    return;
+  }
+
+  try
+  {
+    job.call();
+  }
+  catch (const CoreException &e)
+  {
+    warn("Caught exception while executing task", e.what());
+  }
+  catch (const std::exception &e)
+  {
+    warn("Caught unexpected exception while executing task", e.what());
+  }
+  catch (...)
+  {
+    warn("Unknown error while executing task");
+  }
+
+  recordExecution(job, lane, start);
+}
+
+void ThreadPool::recordExecution(const Job &job,
+                                 const unsigned lane,
+                                 const std::chrono::steady_clock::time_point start,
+                                 const CancellationToken *token)
+{
+  const auto end  = std::chrono::steady_clock::now();
+  const auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+
+  auto &counters = m_counters[lane];
+  counters.jobs.fetch_add(1u, std::memory_order_relaxed);
+  counters.busy.fetch_add(busy.count(), std::memory_order_relaxed);
+  counters.executionTimes.record(busy);
+
+  if (token != nullptr)
+  {
+    // Check whether the job stopped early before polling the token.
+    if (token->stopObserved())
+    {
+      counters.interrupted.fetch_add(1u, std::memory_order_relaxed);
+      counters.interruptedTime.fetch_add(busy.count(), std::memory_order_relaxed);
+    }
+    if (token->cancelled())
+    {
+      counters.stale.fetch_add(1u, std::memory_order_relaxed);
+      counters.staleTime.fetch_add(busy.count(), std::memory_order_relaxed);
+    }
+    if (token->expired())
+    {
+      counters.late.fetch_add(1u, std::memory_order_relaxed);
+    }
+  }
+
+  if (m_tracer->enabled())
+  {
+    const auto name = (job.task != nullptr ? std::string_view(job.task->getName())
+                                           : std::string_view(TASK_TRACE_NAME));
+    m_tracer->record(lane, name, traceCategory(job.priority), start, end);
+  }
+}
+
+auto ThreadPool::externalLane() const noexcept -> unsigned
+{
+  return m_sizing.maxThreads;
+}
+
+void ThreadPool::pushResult(Job job)
+{
+  job.completed = std::chrono::steady_clock::now();
+
+  // In case the results thread lags behind, wait for it to make
+  // some room in the queue.
+  while (!m_results.tryPush(job))
+  {
+    std::this_thread::yield();
+  }
+
+  // Only wake up the results thread if it is sleeping and waiting
+  // for the amount of jobs now available. The fence pairs with the
+  // one in `waitForResults`.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const auto wakeAt = m_resultsWakeAt.load(std::memory_order_relaxed);
+  if (wakeAt > 0u && m_results.size() >= wakeAt)
+  {
+    Guard guard(m_resultsLocker);
+    m_resWaiter.notify_one();
+  }
+}
+
+void ThreadPool::resultsHandlingLoop()
+{
+  while (collectResults())
+  {
+    // Strip the batch index and keep only the jobs consistent with the
+    // current one.
+    const auto batchIndex    = m_batchIndex.load(std::memory_order_relaxed);
+    const auto invalidateOld = m_invalidateOld.load(std::memory_order_relaxed);
+    const auto now           = std::chrono::steady_clock::now();
+
+    auto discarded  = 0u;
+    auto total      = std::chrono::nanoseconds::rep{0};
+    auto maxLatency = m_maxLatency.load(std::memory_order_relaxed);
+
+    m_notified.clear();
+    for (auto &job : m_collected)
+    {
+      if (job.batch != batchIndex && invalidateOld)
+      {
+        if (isLogEnabled(log::Severity::DEBUG))
+        {
+          debug("Discarding job for old batch " + std::to_string(job.batch) + " (current is "
+                + std::to_string(batchIndex) + ")");
+        }
+        ++discarded;
+        continue;
+      }
+
+      const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(now
+                                                                                - job.completed);
+      total += latency.count();
+      maxLatency = std::max(maxLatency, latency.count());
+
+      m_notified.push_back(std::move(job.task));
+    }
+
+    m_collected.clear();
+
+    m_discardedJobs.fetch_add(discarded, std::memory_order_relaxed);
+    m_maxLatency.store(maxLatency, std::memory_order_relaxed);
+
+    if (m_notified.empty())
+    {
+      continue;
+    }
+
+    m_totalLatency.fetch_add(total, std::memory_order_relaxed);
+    m_notifiedJobs.fetch_add(m_notified.size(), std::memory_order_relaxed);
+    m_emissions.fetch_add(1u, std::memory_order_relaxed);
+
+    // Notify listeners.
+    const auto emitted = std::chrono::steady_clock::now();
+    onJobsCompleted.safeEmit(std::string("onJobsCompleted(") + std::to_string(m_notified.size())
+                               + ")",
+                             m_notified);
+
+    if (m_tracer->enabled())
+    {
+      m_tracer->record(externalLane() + 1u,
+                       "onJobsCompleted",
+                       "results",
+                       emitted,
+                       std::chrono::steady_clock::now());
+    }
+  }
+}
+
+bool ThreadPool::collectResults()
+{
+  const auto maxBatch = std::max(m_maxBatch.load(std::memory_order_relaxed), 1u);
+  const auto maxDelay = std::chrono::microseconds(m_maxDelay.load(std::memory_order_relaxed));
+
+  std::chrono::steady_clock::time_point deadline{};
+
+  while (m_resultsHandling.load(std::memory_order_acquire))
+  {
+    Job job{};
+    while (m_collected.size() < maxBatch && m_results.tryPop(job))
+    {
+      // The batch can't be delayed further than the maximum delay
+      // after the oldest job in it completed.
+      if (m_collected.empty())
+      {
+        deadline = job.completed + maxDelay;
+      }
+
+      m_collected.push_back(std::move(job));
+    }
+
+    if (m_collected.size() >= maxBatch)
+    {
+      return true;
+    }
+
+    if (m_collected.empty())
+    {
+      waitForResults(1u, {});
+      continue;
+    }
+
+    if (std::chrono::steady_clock::now() >= deadline)
+    {
+      return true;
+    }
+
+    waitForResults(maxBatch - m_collected.size(), deadline);
+  }
+
+  return false;
+}
+
+void ThreadPool::waitForResults(
+  const std::size_t count,
+  const std::optional<std::chrono::steady_clock::time_point> &deadline)
+{
+  UniqueGuard rLock(m_resultsLocker);
+
+  // Publish the amount of jobs we're waiting for: the fence pairs
+  // with the one in `pushResult` so that either we see the jobs
+  // pushed in the queue or the thread pushing them sees that it
+  // needs to wake us up.
+  m_resultsWakeAt.store(count, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  // Checking both conditions prevents us from being falsely waked
+  // up (see spurious wakeups).
+  const auto ready = [&]() { return !m_resultsHandling || m_results.size() >= count; };
+
+  if (deadline)
+  {
+    m_resWaiter.wait_until(rLock, *deadline, ready);
+  }
+  else
+  {
+    m_resWaiter.wait(rLock, ready);
+  }
+
+  m_resultsWakeAt.store(0u, std::memory_order_relaxed);
+}
+
+auto ThreadPool::addTimer(AsynchronousJobShPtr job,
+                          const std::chrono::steady_clock::time_point &deadline,
+                          const std::uint64_t period) -> TimerId
+{
+  if (job == nullptr)
+  {
+    error("Failed to register timer", "Invalid null job");
+  }
+
+  const auto tick = toTimerTick(deadline);
+
+  UniqueGuard guard(m_timersLocker);
+
+  const auto id = m_timers.add(tick, period, std::move(job));
+
+  if (!m_timersThread.joinable())
+  {
+    m_timersRunning = true;
+    m_timersThread  = std::thread(&ThreadPool::timersLoop, this);
+    return id;
+  }
+
+  // Only wake up the timers thread if it would sleep past the deadline.
+  if (tick < m_timersWakeAt)
+  {
+    m_timersWakeAt = tick;
+    guard.unlock();
+    m_timersWaiter.notify_one();
+  }
+
+  return id;
+}
+
+auto ThreadPool::toTimerTick(const std::chrono::steady_clock::time_point &moment) const noexcept
+  -> std::uint64_t
+{
+  if (moment <= m_timersOrigin)
+  {
+    return 0u;
+  }
+
+  const auto elapsed = std::chrono::ceil<std::chrono::milliseconds>(moment - m_timersOrigin);
+  return static_cast<std::uint64_t>(elapsed.count());
+}
+
+void ThreadPool::timersLoop()
+{
+  std::vector<AsynchronousJobShPtr> due;
+
+  UniqueGuard guard(m_timersLocker);
+  while (m_timersRunning)
+  {
+    const auto elapsed = std::chrono::floor<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - m_timersOrigin);
+    m_timers.advance(static_cast<std::uint64_t>(elapsed.count()),
+                     [&due](const AsynchronousJobShPtr &job) { due.push_back(job); });
+
+    if (!due.empty())
+    {
+      // Timers can be registered while the jobs are enqueued.
+      guard.unlock();
+
+      const auto count    = due.size();
+      std::size_t pending = 0u;
+      std::vector<Job> dropped;
+      {
+        Guard guard2(m_jobsLocker);
+        pushJobs(due, false, dropped);
+
+        m_jobsAvailable = true;
+        pending         = pendingJobs();
+      }
+
+      wakeThreads(count);
+      growIfNeeded(pending);
+
+      due.clear();
+      guard.lock();
+      continue;
+    }
+
+    const auto next = m_timers.nextExpiry();
+    m_timersWakeAt  = next.value_or(UINT64_MAX);
+
+    if (next)
+    {
+      m_timersWaiter.wait_until(guard, m_timersOrigin + std::chrono::milliseconds(*next));
+    }
+    else
+    {
+      m_timersWaiter.wait(guard);
+    }
+  }
+}
+
+auto ThreadPool::queueFor(const Priority priority, const std::optional<unsigned> &node) noexcept
+  -> JobQueue &
+{
+  if (node && *node < m_nodeThreads.size() && m_nodeThreads[*node] > 0u)
+  {
+    return m_nodeJobs[*node][static_cast<int>(priority)];
+  }
+
+  switch (priority)
+  {
+    case Priority::High:
+      return m_hPrioJobs;
+    case Priority::Normal:
+      return m_nPrioJobs;
+    case Priority::Low:
+    default:
+      // Assume low priority for unhandled priority.
+      return m_lPrioJobs;
+  }
+}
+
+auto ThreadPool::nextQueue(const Priority priority, const std::optional<unsigned> &node) noexcept
+  -> JobQueue *
+{
+  if (node && *node < m_nodeJobs.size())
+  {
+    auto &local = m_nodeJobs[*node][static_cast<int>(priority)];
+    if (!local.empty())
+    {
+      return &local;
+    }
+  }
+
+  auto &shared = queueFor(priority);
+  if (!shared.empty())
+  {
+    return &shared;
+  }
+
+  for (auto &queues : m_nodeJobs)
+  {
+    auto &queue = queues[static_cast<int>(priority)];
+    if (!queue.empty())
+    {
+      return &queue;
+    }
+  }
+
+  return nullptr;
+}
+
+bool ThreadPool::popJob(const std::optional<unsigned> &node, Job &job)
+{
+  for (const auto priority : PRIORITIES_BY_URGENCY)
+  {
+    auto *queue = nextQueue(priority, node);
+    if (queue == nullptr)
+    {
+      continue;
+    }
+
+    // A job of lower priority which waited for too long goes first.
+    if (auto *aged = agedQueue(node, priority); aged != nullptr)
+    {
+      job = aged->popOldest();
+    }
+    else
+    {
+      job = queue->pop();
+    }
+
+    m_jobsAvailable = hasJobs();
+    return true;
+  }
+
+  m_jobsAvailable = false;
+  return false;
+}
+
+auto ThreadPool::agedQueue(const std::optional<unsigned> &node, const Priority priority)
+  -> JobQueue *
+{
+  const auto threshold = m_agingThreshold.load(std::memory_order_relaxed);
+  if (threshold <= 0)
+  {
+    return nullptr;
+  }
+
+  // Priorities are ordered from the least to the most urgent: a job is
+  // promoted by one level for each period of `threshold` it waited.
+  const auto now = std::chrono::steady_clock::now();
+  auto level     = static_cast<long>(priority);
+  JobQueue *out  = nullptr;
+
+  for (auto lower = 0; lower < static_cast<int>(priority); ++lower)
+  {
+    auto *queue = nextQueue(static_cast<Priority>(lower), node);
+    if (queue == nullptr)
+    {
+      continue;
+    }
+
+    const auto waited  = std::chrono::duration_cast<std::chrono::nanoseconds>(now
+                                                                             - queue->oldest());
+    const auto boosted = static_cast<long>(lower + waited.count() / threshold);
+    if (boosted > level)
+    {
+      level = boosted;
+      out   = queue;
+    }
+  }
+
+  return out;
+}
+
+void ThreadPool::clearJobs(std::vector<Job> &dropped)
+{
+  m_hPrioJobs.clear(dropped);
+  m_nPrioJobs.clear(dropped);
+  m_lPrioJobs.clear(dropped);
+
+  for (auto &queues : m_nodeJobs)
+  {
+    for (auto &queue : queues)
+    {
+      queue.clear(dropped);
+    }
+  }
+}
+
+auto ThreadPool::pendingJobs() const noexcept -> std::size_t
+{
+  auto out = m_hPrioJobs.size() + m_nPrioJobs.size() + m_lPrioJobs.size();
+
+  for (const auto &queues : m_nodeJobs)
+  {
+    for (const auto &queue : queues)
+    {
+      out += queue.size();
+    }
+  }
+
+  return out;
+}
+
+bool ThreadPool::hasJobs() const noexcept
+{
+  return pendingJobs() > 0u;
+}
+
+ThreadPool::JobQueue::JobQueue(const std::size_t capacity)
+  : m_jobs(capacity)
+{}
+
+void ThreadPool::JobQueue::setOrdering(const JobOrdering ordering)
+{
+  if (ordering == m_ordering)
+  {
+    return;
+  }
+
+  const auto reorganize = (ordering == JobOrdering::Deadline
+                           || m_ordering == JobOrdering::Deadline);
+  m_ordering            = ordering;
+
+  if (!reorganize)
+  {
+    return;
+  }
+
+  std::vector<Job> jobs;
+  jobs.reserve(m_jobs.size());
+  while (!m_jobs.empty())
+  {
+    jobs.push_back(m_jobs.popFront());
+  }
+  m_bySubmission.clear();
+
+  // The heap does not keep the order of submission: restore it.
+  const auto bySubmission = [](const Job &lhs, const Job &rhs) {
+    return lhs.sequence < rhs.sequence;
+  };
+  std::sort(jobs.begin(), jobs.end(), bySubmission);
+
+  for (auto &job : jobs)
+  {
+    push(std::move(job));
+  }
+}
+
+void ThreadPool::JobQueue::reserve(const std::size_t capacity)
+{
+  m_jobs.reserve(capacity);
+}
+
+void ThreadPool::JobQueue::push(Job &&job)
+{
+  job.sequence = m_pushed++;
+
+  if (m_ordering != JobOrdering::Deadline)
+  {
+    m_jobs.pushBack(std::move(job));
+    return;
+  }
+
+  // Jobs moved back from a local queue might be older than the others.
+  const auto id = m_jobs.size();
+  job.slot      = m_bySubmission.size();
+  m_bySubmission.push_back(id);
+  m_jobs.pushBack(std::move(job));
+
+  siftUpSlot(m_jobs[id].slot);
+  siftUp(id);
+}
+
+auto ThreadPool::JobQueue::pop() -> Job
+{
+  switch (m_ordering)
+  {
+    case JobOrdering::Fifo:
+      return m_jobs.popFront();
+    case JobOrdering::Deadline:
+      return removeAt(0u);
+    case JobOrdering::Lifo:
+    default:
+      return m_jobs.popBack();
+  }
+}
+
+auto ThreadPool::JobQueue::popOldest() -> Job
+{
+  if (m_ordering == JobOrdering::Deadline)
+  {
+    return removeAt(m_bySubmission[0u]);
+  }
+
+  return m_jobs.popFront();
+}
+
+auto ThreadPool::JobQueue::oldest() const noexcept -> std::chrono::steady_clock::time_point
+{
+  if (m_ordering == JobOrdering::Deadline)
+  {
+    return m_jobs[m_bySubmission[0u]].enqueued;
+  }
+
+  return m_jobs[0u].enqueued;
+}
+
+void ThreadPool::JobQueue::clear(std::vector<Job> &dropped)
+{
+  dropped.reserve(dropped.size() + m_jobs.size());
+  while (!m_jobs.empty())
+  {
+    dropped.push_back(m_jobs.popBack());
+  }
+
+  m_bySubmission.clear();
+}
+
+auto ThreadPool::JobQueue::size() const noexcept -> std::size_t
+{
+  return m_jobs.size();
+}
+
+bool ThreadPool::JobQueue::empty() const noexcept
+{
+  return m_jobs.empty();
+}
+
+bool ThreadPool::JobQueue::after(const Job &lhs, const Job &rhs) noexcept
+{
+  // Jobs without deadline come last.
+  if (lhs.deadline != rhs.deadline)
+  {
+    if (!lhs.deadline || !rhs.deadline)
+    {
+      return !lhs.deadline;
+    }
+
+    return *lhs.deadline > *rhs.deadline;
+  }
+
+  return lhs.sequence > rhs.sequence;
+}
+
+bool ThreadPool::JobQueue::younger(const Job &lhs, const Job &rhs) noexcept
+{
+  if (lhs.enqueued != rhs.enqueued)
+  {
+    return lhs.enqueued > rhs.enqueued;
+  }
+
+  return lhs.sequence > rhs.sequence;
+}
+
+auto ThreadPool::JobQueue::removeAt(const std::size_t id) -> Job
+{
+  // Move the job to the end of the heap and remove it from the index of
+  // the oldest jobs while it is still in the queue.
+  const auto last = m_jobs.size() - 1u;
+  swapJobs(id, last);
+
+  const auto slot     = m_jobs[last].slot;
+  const auto lastSlot = m_bySubmission.size() - 1u;
+  swapSlots(slot, lastSlot);
+  m_bySubmission.pop_back();
+
+  if (slot < m_bySubmission.size())
+  {
+    siftDownSlot(slot);
+    siftUpSlot(slot);
+  }
+
+  auto out = m_jobs.popBack();
+  if (id < m_jobs.size())
+  {
+    siftDown(id);
+    siftUp(id);
+  }
+
+  return out;
+}
+
+void ThreadPool::JobQueue::swapJobs(const std::size_t lhs, const std::size_t rhs) noexcept
+{
+  if (lhs == rhs)
+  {
+    return;
+  }
+
+  std::swap(m_jobs[lhs], m_jobs[rhs]);
+  m_bySubmission[m_jobs[lhs].slot] = lhs;
+  m_bySubmission[m_jobs[rhs].slot] = rhs;
+}
+
+void ThreadPool::JobQueue::siftUp(std::size_t id)
+{
+  while (id > 0u)
+  {
+    const auto parent = (id - 1u) / 2u;
+    if (!after(m_jobs[parent], m_jobs[id]))
+    {
+      return;
+    }
+
+    swapJobs(parent, id);
+    id = parent;
+  }
+}
+
+void ThreadPool::JobQueue::siftDown(std::size_t id)
+{
+  const auto size = m_jobs.size();
+
+  while (true)
+  {
+    const auto left  = 2u * id + 1u;
+    const auto right = left + 1u;
+    auto first       = id;
+
+    if (left < size && after(m_jobs[first], m_jobs[left]))
+    {
+      first = left;
+    }
+    if (right < size && after(m_jobs[first], m_jobs[right]))
+    {
+      first = right;
+    }
+
+    if (first == id)
+    {
+      return;
+    }
+
+    swapJobs(first, id);
+    id = first;
+  }
+}
+
+void ThreadPool::JobQueue::swapSlots(const std::size_t lhs, const std::size_t rhs) noexcept
+{
+  if (lhs == rhs)
+  {
+    return;
+  }
+
+  std::swap(m_bySubmission[lhs], m_bySubmission[rhs]);
+  m_jobs[m_bySubmission[lhs]].slot = lhs;
+  m_jobs[m_bySubmission[rhs]].slot = rhs;
+}
+
+void ThreadPool::JobQueue::siftUpSlot(std::size_t id)
+{
+  while (id > 0u)
+  {
+    const auto parent = (id - 1u) / 2u;
+    if (!younger(m_jobs[m_bySubmission[parent]], m_jobs[m_bySubmission[id]]))
+    {
+      return;
+    }
+
+    swapSlots(parent, id);
+    id = parent;
+  }
+}
+
+void ThreadPool::JobQueue::siftDownSlot(std::size_t id)
+{
+  const auto size = m_bySubmission.size();
+
+  while (true)
+  {
+    const auto left  = 2u * id + 1u;
+    const auto right = left + 1u;
+    auto first       = id;
+
+    if (left < size && younger(m_jobs[m_bySubmission[first]], m_jobs[m_bySubmission[left]]))
+    {
+      first = left;
+    }
+    if (right < size && younger(m_jobs[m_bySubmission[first]], m_jobs[m_bySubmission[right]]))
+    {
+      first = right;
+    }
+
+    if (first == id)
+    {
+      return;
+    }
+
+    swapSlots(first, id);
+    id = first;
+  }
+}
+
+bool ThreadPool::hasLocalJobs() const noexcept
+{
+  for (const auto &worker : m_workers)
+  {
+    for (const auto &queue : worker->queues)
+    {
+      if (!queue.empty())
+      {
+        return true;
+      }
+    }
+  }
+
+  return false;
 }
 
 } // namespace utils
@@ -3,16 +3,37 @@
 
 #include "AsynchronousJob.hh"
 #include "CoreObject.hh"
+#include "Dispatcher.hh"
+#include "Future.hh"
+#include "LatencyHistogram.hh"
+#include "MpscQueue.hh"
+#include "PoolSizing.hh"
+#include "RingBuffer.hh"
+#include "SchedulingMode.hh"
 #include "Signal.hh"
+#include "SmallTask.hh"
+#include "ThreadPlacement.hh"
+#include "ThreadPoolStats.hh"
+#include "TimeUtils.hh"
+#include "TimerWheel.hh"
+#include "TraceRecorder.hh"
+#include "WorkStealingDeque.hh"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <coroutine>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace utils {
 
-class ThreadPool : public CoreObject
+class ThreadPool : public CoreObject, public Dispatcher
 {
   public:
   /// @brief - Create a new thread pool with the specified thread count. It allows
@@ -20,7 +41,22 @@ class ThreadPool : public CoreObject
   /// in case the provided value is `0` the value returned by `getThreadPoolSize`
   /// will be used instead.
   /// @param size - the number of threads to create for this pool.
-  ThreadPool(const unsigned size = 3u);
+  /// @param mode - the strategy used by the threads to fetch jobs. The default
+  /// is to share a single set of queues between all threads.
+  /// @param placement - how the threads are pinned to the CPUs. When they are,
+  /// jobs with a node hint are preferably processed by threads of this node.
+  ThreadPool(const unsigned size              = 3u,
+             const SchedulingMode mode        = SchedulingMode::SharedQueue,
+             const ThreadPlacement &placement = ThreadPlacement{});
+
+  /// @brief - Create a new elastic thread pool. The number of threads varies
+  /// between the bounds defined by the sizing depending on the load.
+  /// @param sizing - the bounds on the number of threads.
+  /// @param mode - the strategy used by the threads to fetch jobs.
+  /// @param placement - how the threads are pinned to the CPUs.
+  ThreadPool(const PoolSizing &sizing,
+             const SchedulingMode mode        = SchedulingMode::SharedQueue,
+             const ThreadPlacement &placement = ThreadPlacement{});
 
   /// @brief - Used to destroy the pool and terminate all the threads used to process
   /// the jobs. The jobs will be finished before destroying the threads.
@@ -41,19 +77,437 @@ class ThreadPool : public CoreObject
   /// @param jobs - the list of jobs to enqueue.
   /// @param invalidate - prevent notification of jobs from previous batches if set
   /// to `true`.
-  void enqueueJobs(const std::vector<AsynchronousJobShPtr> &jobs, const bool invalidate);
+  void enqueueJobs(std::span<const AsynchronousJobShPtr> jobs, const bool invalidate);
+
+  /// @brief - Similar to the above method but the jobs are moved into the queues
+  /// instead of being copied, which avoids updating their reference count. This
+  /// is the preferred way to enqueue large batches of jobs. The input vector is
+  /// left empty.
+  /// @param jobs - the list of jobs to enqueue.
+  /// @param invalidate - prevent notification of jobs from previous batches if set
+  /// to `true`.
+  void enqueueJobs(std::vector<AsynchronousJobShPtr> &&jobs, const bool invalidate);
 
   /// @brief - Used to cancel any existing jobs being processed for this scheduler.
   /// This function is needed in order to be able to call `enqueueJobs` again.
   void cancelJobs();
 
+  /// @brief - Identifies a job registered to be enqueued later.
+  using TimerId = TimerWheel<AsynchronousJobShPtr>::TimerId;
+
+  /// @brief - Register a job to be enqueued at the specified time. Once the time
+  /// is reached the job is pushed in the queue of its priority as part of the
+  /// current batch and the threads are notified right away, so there's no need
+  /// to call `notifyJobs`. All the timers are handled by a single thread with a
+  /// resolution of a millisecond: jobs are never enqueued early.
+  /// Note that `cancelJobs` does not cancel the timers.
+  /// @param job - the job to enqueue.
+  /// @param when - the moment the job should be enqueued. A moment in the past
+  /// enqueues the job right away.
+  /// @return - an identifier allowing to cancel the timer.
+  auto enqueueJobAt(AsynchronousJobShPtr job, const TimeStamp &when) -> TimerId;
+
+  /// @brief - Similar to `enqueueJobAt` but the moment is expressed relatively
+  /// to now.
+  /// @param job - the job to enqueue.
+  /// @param delay - how long to wait before enqueuing the job.
+  /// @return - an identifier allowing to cancel the timer.
+  auto enqueueJobAfter(AsynchronousJobShPtr job, const Duration &delay) -> TimerId;
+
+  /// @brief - Register a job to be enqueued periodically until the timer is
+  /// cancelled. The periods are measured from the first deadline so that they
+  /// don't drift, and the periods missed because the pool was late are skipped
+  /// rather than enqueued in a burst. In case the job takes longer than its
+  /// period to compute, it might be processed by several threads at once.
+  /// @param job - the job to enqueue.
+  /// @param period - the time between two enqueues of the job.
+  /// @param first - the moment the job is first enqueued. The default is to wait
+  /// for a period.
+  /// @return - an identifier allowing to cancel the timer.
+  auto enqueueJobEvery(AsynchronousJobShPtr job,
+                       const Duration &period,
+                       const std::optional<TimeStamp> &first = {}) -> TimerId;
+
+  /// @brief - Cancel a timer registered through one of the above methods. Jobs
+  /// already enqueued by the timer are not affected.
+  /// @param id - the identifier of the timer.
+  /// @return - `true` if the timer was still pending.
+  bool cancelTimer(const TimerId id);
+
+  /// @brief - Return the number of timers waiting to enqueue their job.
+  /// @return - the number of pending timers.
+  auto pendingTimers() const -> std::size_t;
+
+  /// @brief - Submit a callable to be executed by the pool and return a future
+  /// which receives its result. This is a lighter alternative to the creation of
+  /// an `AsynchronousJob`: the result does not go through `onJobsCompleted` and
+  /// the threads are notified right away so there's no need to call `notifyJobs`.
+  /// The callable is subject to the same cancellation rules as the jobs: if it
+  /// is discarded by `cancelJobs` or by an invalidating `enqueueJobs` before it
+  /// runs the future reports it as cancelled. The result is stored by value: a
+  /// callable returning a reference produces a copy of the referenced object.
+  /// @param func - the callable to execute.
+  /// @param priority - the priority of the execution.
+  /// @return - a future receiving the result of the callable.
+  template<typename F>
+  auto submit(F &&func, const Priority priority = Priority::Normal)
+    -> Future<std::decay_t<std::invoke_result_t<std::decay_t<F>>>>;
+
+  /// @brief - Similar to `submit` but does not provide any way to retrieve the
+  /// result of the callable. Small callables are stored directly in the queues
+  /// of the pool, so that this does not allocate any memory. Exceptions raised
+  /// by the callable are caught and logged.
+  /// @param func - the callable to execute.
+  /// @param priority - the priority of the execution.
+  template<typename F>
+  void post(F &&func, const Priority priority = Priority::Normal);
+
+  /// @brief - Implementation of the `Dispatcher` interface, equivalent to `post`
+  /// with a normal priority. This allows to queue the slots of a signal on the
+  /// pool. Just like the posted callables, the dispatched ones are dropped by
+  /// `cancelJobs`.
+  /// @param task - the callable to execute.
+  void dispatch(SmallTask &&task) override;
+
+  /// @brief - Awaitable returned by `schedule`: the awaiting coroutine is suspended
+  /// and then resumed by a thread of the pool.
+  class ScheduleOperation
+  {
+    public:
+    ScheduleOperation(ThreadPool &pool, const Priority priority) noexcept;
+
+    bool await_ready() const noexcept;
+    void await_suspend(std::coroutine_handle<> awaiting);
+
+    /// @brief - Throws a `CoreException` in case the resumption was dropped
+    /// from the queues of the pool.
+    void await_resume() const;
+
+    private:
+    ThreadPool &m_pool;
+    Priority m_priority;
+
+    /// @brief - Set when the coroutine is resumed because its resumption was
+    /// dropped. The operation lives in the frame of the suspended coroutine.
+    bool m_cancelled{false};
+  };
+
+  /// @brief - Used by coroutines to continue their execution on a thread of the
+  /// pool, with `co_await pool.schedule(priority)`. Resuming the coroutine is a
+  /// small callable stored in the queues like the ones provided to `post`. When
+  /// it is dropped, for example by `cancelJobs`, the coroutine is resumed by the
+  /// thread dropping it and the `co_await` expression throws, so that the frame
+  /// is not leaked and whoever awaits the coroutine is notified.
+  /// @param priority - the priority of the rest of the coroutine.
+  /// @return - the awaitable to use.
+  auto schedule(const Priority priority = Priority::Normal) noexcept -> ScheduleOperation;
+
+  /// @brief - Used to execute a single pending job in the calling thread. This
+  /// allows a thread waiting for some jobs to complete to help the pool instead
+  /// of blocking, which avoids deadlocks when the waiting thread is itself part
+  /// of the pool.
+  /// @return - `true` if a job was fetched from the queues.
+  bool runPendingJob();
+
+  /// @brief - Return the number of threads used by the pool to process jobs. For
+  /// an elastic pool this value changes over time.
+  /// @return - the number of threads of the pool.
+  auto size() const -> unsigned;
+
+  /// @brief - Return the topology of the machine as detected by the pool. The
+  /// identifiers of its nodes are the ones to use as hint for the jobs.
+  /// @return - the topology used to place the threads.
+  auto topology() const noexcept -> const CpuTopology &;
+
+  /// @brief - Return the index of the current batch of jobs. It is incremented
+  /// each time `cancelJobs` is called, which allows external schedulers to find
+  /// out whether the work they submitted has been cancelled in the meantime.
+  /// @return - the index of the current batch.
+  auto batchIndex() const noexcept -> unsigned;
+
+  /// @brief - Create a token which is cancelled once the jobs of the input batch
+  /// are cancelled, see `cancelJobs`. This is the token received by the jobs
+  /// executed by the pool, which allows external schedulers to provide the same
+  /// guarantees. The token should not outlive the pool.
+  /// @param batch - the index of the batch, as returned by `batchIndex`.
+  /// @param deadline - the time by which the job should be done, if any.
+  /// @return - the token for this batch.
+  auto cancellationToken(const unsigned batch,
+                         const std::optional<TimeStamp> &deadline = {}) const noexcept
+    -> CancellationToken;
+
+  /// @brief - Used to configure how completed jobs are grouped before being
+  /// notified through the `onJobsCompleted` signal. The results thread emits
+  /// the signal as soon as `maxBatch` jobs are available or when the oldest
+  /// pending job has waited for `maxDelay`, whichever comes first. The default
+  /// is to notify results as soon as they are available which favors latency.
+  /// Larger values reduce the emission rate and favor throughput.
+  /// @param maxBatch - the maximum number of jobs notified at once. A value of
+  /// `0` is interpreted as `1`.
+  /// @param maxDelay - how long the results thread is allowed to wait for more
+  /// jobs before notifying the ones it already has.
+  void setResultsBatching(const unsigned maxBatch, const std::chrono::microseconds maxDelay);
+
+  /// @brief - Return a snapshot of the statistics about the notification of the
+  /// completed jobs since the creation of the pool.
+  /// @return - the statistics for this pool.
+  auto completionStats() const noexcept -> CompletionStats;
+
+  /// @brief - Used to define in which order the jobs of a given priority are
+  /// processed. The jobs already waiting in the queues are reorganized to follow
+  /// the new order. The default is to process the most recent jobs first.
+  /// @param ordering - the new order of the jobs.
+  void setJobOrdering(const JobOrdering ordering);
+
+  /// @brief - Used to prevent the starvation of low priority jobs under load. A
+  /// job is processed as if its priority was raised by one level for each period
+  /// of `threshold` it spent waiting in the queues. A value of `0` disables the
+  /// aging of jobs, which is the default.
+  /// @param threshold - the waiting time after which a job is promoted.
+  void setAging(const std::chrono::milliseconds threshold);
+
+  /// @brief - Return the distribution of the time spent in the queues by the jobs
+  /// of the input priority since the creation of the pool.
+  /// @param priority - the priority of the jobs.
+  /// @return - the statistics for this priority.
+  auto waitTimeStats(const Priority priority) const noexcept -> WaitTimeStats;
+
+  /// @brief - Return a snapshot of the activity of the pool since its creation.
+  /// The counters are kept by each thread and gathered when this method is
+  /// called, so that maintaining them doesn't slow down the processing of jobs.
+  /// @return - the statistics for this pool.
+  auto stats() const -> PoolStats;
+
+  /// @brief - Start recording the execution of the jobs and the idle periods of
+  /// the threads. Any previous recording is discarded. Each thread keeps at most
+  /// `capacity` events, later ones being dropped.
+  /// @param capacity - the maximum number of events recorded per thread.
+  void startTracing(const std::size_t capacity = 65536u);
+
+  /// @brief - Stop recording events. The events recorded so far are kept until
+  /// the next call to `startTracing`.
+  void stopTracing() noexcept;
+
+  /// @brief - Write the recorded events to the stream as a JSON trace, which can
+  /// be loaded in `chrome://tracing` or Perfetto to look at scheduling gaps.
+  /// @param out - the stream to write to.
+  void exportTrace(std::ostream &out) const;
+
+  private:
+  /**
+       * @brief - Convenience define to refer to a unique lock on the mutex used to
+       *          protect the pool's running status.
+       */
+  using UniqueGuard = std::unique_lock<std::mutex>;
+
+  /// @brief - Convenience structure representing a job and the corresponding batch
+  /// index. This allows to identify whether a result is linked to the current
+  /// batch or to an old one.
+  /// A job either wraps an `AsynchronousJob` or a callable submitted through
+  /// `submit` or `post`.
+  struct Job
+  {
+    AsynchronousJobShPtr task{};
+    SmallTask call{};
+    unsigned batch{0u};
+
+    /// @brief - The value of the purge index when the job was enqueued. Used in
+    /// work stealing mode to drop jobs which were invalidated while sitting in a
+    /// local queue.
+    unsigned purge{0u};
+
+    /// @brief - The moment the job finished its computation. Used to measure the
+    /// latency of the notification of results.
+    std::chrono::steady_clock::time_point completed{};
+
+    /// @brief - The priority of the job, also defined for callables.
+    Priority priority{Priority::Normal};
+
+    /// @brief - The moment the job was enqueued. Used to age jobs and to measure
+    /// the time they spend waiting.
+    std::chrono::steady_clock::time_point enqueued{};
+
+    /// @brief - The time by which the job should be done, if any.
+    std::optional<TimeStamp> deadline{};
+
+    /// @brief - The rank of the job in its queue, used to keep the order of
+    /// submission of jobs sharing the same deadline.
+    std::uint64_t sequence{0u};
+
+    /// @brief - When the jobs are ordered by deadline, the position of the job
+    /// in the index used to find the oldest job of the queue.
+    std::size_t slot{0u};
+  };
+
+  /// @brief - The number of completed jobs which can wait in the results queue.
+  /// Threads finishing a job while the queue is full wait for some room to be
+  /// made by the results thread.
+  static constexpr auto RESULTS_QUEUE_CAPACITY = 4096u;
+
+  /// @brief - The number of jobs each queue can hold before having to grow.
+  static constexpr auto JOBS_QUEUE_CAPACITY = 1024u;
+
+  /// @brief - The number of distinct priorities for a job.
+  static constexpr auto PRIORITIES_COUNT = 3u;
+
+  /// @brief - The local queues of a thread in work stealing mode: one for each
+  /// priority, indexed by the value of the priority.
+  struct Worker
+  {
+    std::array<WorkStealingDeque<Job *>, PRIORITIES_COUNT> queues{};
+
+    /// @brief - The number of jobs fetched by the thread. Used to check for aged
+    /// jobs in the shared queues from time to time.
+    unsigned fetched{0u};
+  };
+
+  /// @brief - The activity of a thread. Each thread of the pool updates its own
+  /// counters, which live on separate cache lines so that threads don't contend
+  /// when updating them.
+  struct alignas(64) ThreadCounters
+  {
+    std::atomic_uint64_t jobs{0u};
+    std::atomic_uint64_t steals{0u};
+    std::atomic_uint64_t parks{0u};
+    std::atomic<std::chrono::nanoseconds::rep> busy{0};
+
+    /// @brief - The time spent by the jobs in the queues, for each priority.
+    std::array<LatencyHistogram, PRIORITIES_COUNT> waitTimes{};
+
+    LatencyHistogram executionTimes{};
+
+    /// @brief - The jobs which stopped early, and the time they ran.
+    std::atomic_uint64_t interrupted{0u};
+    std::atomic<std::chrono::nanoseconds::rep> interruptedTime{0};
+
+    /// @brief - The jobs whose batch was cancelled by the time they were done,
+    /// and the time they ran.
+    std::atomic_uint64_t stale{0u};
+    std::atomic<std::chrono::nanoseconds::rep> staleTime{0};
+
+    /// @brief - The jobs which were done after their deadline.
+    std::atomic_uint64_t late{0u};
+  };
+
+  /// @brief - A queue holding jobs of a given priority, which are fetched in the
+  /// configured order. The jobs are kept in a ring buffer which is used as a
+  /// binary heap in case they are ordered by deadline.
+  class JobQueue
+  {
+    public:
+    JobQueue(const std::size_t capacity = 0u);
+
+    /// @brief - Change the order in which the jobs are fetched. The jobs already
+    /// in the queue are reorganized if needed.
+    /// @param ordering - the new order of the jobs.
+    void setOrdering(const JobOrdering ordering);
+
+    void reserve(const std::size_t capacity);
+
+    void push(Job &&job);
+
+    /// @brief - Remove the next job according to the ordering of the queue.
+    /// Undefined behavior if the queue is empty.
+    /// @return - the removed job.
+    auto pop() -> Job;
+
+    /// @brief - Remove the job which has been waiting for the longest time, also
+    /// when the jobs are ordered by deadline. Undefined behavior if the queue is
+    /// empty.
+    /// @return - the removed job.
+    auto popOldest() -> Job;
+
+    /// @brief - The moment the job returned by `popOldest` was enqueued.
+    /// @return - the enqueue time of the oldest job.
+    auto oldest() const noexcept -> std::chrono::steady_clock::time_point;
+
+    /// @brief - Remove all the jobs of the queue.
+    /// @param dropped - receives the removed jobs.
+    void clear(std::vector<Job> &dropped);
+
+    auto size() const noexcept -> std::size_t;
+
+    bool empty() const noexcept;
+
+    private:
+    /// @brief - Whether `lhs` should be processed after `rhs` when the jobs are
+    /// ordered by deadline.
+    static bool after(const Job &lhs, const Job &rhs) noexcept;
+
+    /// @brief - Whether `lhs` was enqueued after `rhs`.
+    static bool younger(const Job &lhs, const Job &rhs) noexcept;
+
+    /// @brief - Remove the job at the input position of the heap of jobs ordered
+    /// by deadline.
+    /// @param id - the position of the job.
+    /// @return - the removed job.
+    auto removeAt(const std::size_t id) -> Job;
+
+    /// @brief - Swap two jobs of the heap ordered by deadline, keeping the index
+    /// of the oldest jobs up to date.
+    void swapJobs(const std::size_t lhs, const std::size_t rhs) noexcept;
+
+    void siftUp(std::size_t id);
+    void siftDown(std::size_t id);
+
+    /// @brief - Same as the functions above for the index of the oldest jobs.
+    void swapSlots(const std::size_t lhs, const std::size_t rhs) noexcept;
+    void siftUpSlot(std::size_t id);
+    void siftDownSlot(std::size_t id);
+
+    private:
+    JobOrdering m_ordering{JobOrdering::Lifo};
+    RingBuffer<Job> m_jobs;
+    std::uint64_t m_pushed{0u};
+
+    /// @brief - When the jobs are ordered by deadline, a heap of the positions
+    /// of the jobs in `m_jobs` ordered by enqueue time, so that the oldest job
+    /// can be found and aged. Each job knows its slot in this heap.
+    std::vector<std::size_t> m_bySubmission{};
+  };
+
+  /// @brief - A set of queues holding jobs, indexed by the value of their priority.
+  using JobQueues = std::array<JobQueue, PRIORITIES_COUNT>;
+
   private:
   /// @brief - Used to create the thread pool used by this scheduler to perform the user's
   /// computations. The threads are created while building this scheduler and are waiting
   /// for jobs to be enqueued. The number of threads to create is retrieved from the input
   /// argument.
-  /// @param size - the number of thread(s) to create for this pool.
-  void createThreadPool(const unsigned size);
+  /// @param placement - how the threads are pinned to the CPUs.
+  void createThreadPool(const ThreadPlacement &placement);
+
+  /// @brief - Used to register a range of jobs in the queues. Jobs provided through
+  /// a range of mutable elements are moved, the others are copied. Assumes that the
+  /// locker protecting the queues is acquired.
+  /// @param jobs - the jobs to register.
+  /// @param invalidate - whether the jobs of previous batches should be discarded.
+  /// @param dropped - receives the discarded jobs, see `clearJobs`.
+  template<typename Range>
+  void pushJobs(Range &jobs, const bool invalidate, std::vector<Job> &dropped);
+
+  /// @brief - Used to start a thread processing jobs in the input slot. A thread
+  /// which previously used the slot is joined first. Assumes that the locker
+  /// protecting the threads is acquired.
+  /// @param threadId - the slot of the thread.
+  void spawnThread(const unsigned threadId);
+
+  /// @brief - Used to create a new thread in case the pool is elastic and jobs
+  /// have been waiting for a while with all the threads busy.
+  /// @param pending - the number of jobs waiting in the queues.
+  void growIfNeeded(const std::size_t pending);
+
+  /// @brief - Used by an idle thread of an elastic pool to terminate itself. In
+  /// work stealing mode the jobs left in its local queues are moved back to the
+  /// shared queues.
+  /// @param threadId - the slot of the thread.
+  /// @return - `true` if the thread should terminate.
+  bool retireThread(const unsigned threadId);
+
+  /// @brief - Used to wake up some of the sleeping threads, at most `count` of
+  /// them.
+  /// @param count - the number of threads needed.
+  void wakeThreads(const std::size_t count);
 
   /// @brief - Used to terminate the threads associated to the thread pool. This is typically
   /// called upon destroying the scheduler.
@@ -67,11 +521,173 @@ class ThreadPool : public CoreObject
   /// to easily determine from which thread the completed jobs come from.
   void jobFetchingLoop(const unsigned threadId);
 
+  /// @brief - Thread loop used instead of `jobFetchingLoop` when the pool is in
+  /// work stealing mode. Each thread processes jobs from its local queues, refills
+  /// them from the shared queues in chunks and steals from its peers when both are
+  /// empty. The priority of jobs is respected within each of these sources.
+  /// @param threadId - the index of the thread in the pool.
+  void workStealingLoop(const unsigned threadId);
+
+  /// @brief - Used in work stealing mode to fetch the next job to process for
+  /// the specified thread.
+  /// @param threadId - the index of the thread looking for a job.
+  /// @return - the job to process or `nullptr` if none could be found.
+  auto fetchJob(const unsigned threadId) -> Job *;
+
+  /// @brief - Used in work stealing mode to replace the job fetched by a thread
+  /// with a job from the shared queues which waited for too long, if any. The
+  /// fetched job is then put back in the local queue of the thread.
+  /// @param threadId - the index of the thread.
+  /// @param job - the job fetched by the thread.
+  /// @return - the job to process.
+  auto promoteAgedJob(const unsigned threadId, Job *job) -> Job *;
+
+  /// @brief - Used in work stealing mode to move a chunk of jobs with the input
+  /// priority from the shared queues to the local queue of the thread. Returns
+  /// one of these jobs so that it can be processed right away.
+  /// @param threadId - the index of the thread to refill.
+  /// @param priority - the priority of the jobs to move.
+  /// @return - a job to process or `nullptr` if the shared queue is empty.
+  auto refillLocalJobs(const unsigned threadId, const Priority priority) -> Job *;
+
+  /// @brief - Used in work stealing mode to steal a job from the local queue of
+  /// another thread.
+  /// @param threadId - the index of the thread stealing.
+  /// @param priority - the priority of the job to steal.
+  /// @return - the stolen job or `nullptr` if none could be stolen.
+  auto stealJob(const unsigned threadId, const Priority priority) -> Job *;
+
+  /// @brief - Used to wait until some jobs are available or the pool is terminated.
+  /// The thread first spins, then yields and finally goes to sleep, which avoids
+  /// the cost of a wake up when jobs come in quick succession. An idle thread of an
+  /// elastic pool might also terminate while waiting.
+  /// @param threadId - the slot of the waiting thread.
+  /// @return - `true` if the thread should keep processing jobs.
+  bool waitForJobs(const unsigned threadId);
+
+  /// @brief - Used by idle threads to determine whether there might be some jobs
+  /// to process.
+  /// @return - `true` if some jobs are available.
+  bool jobsReady() const noexcept;
+
+  /// @brief - Used to fetch the most urgent job from the queues. Assumes that the
+  /// locker protecting the queues is acquired.
+  /// @param node - the node of the thread or an empty value if it's not pinned.
+  /// @param job - output argument receiving the job.
+  /// @return - `true` if a job was found.
+  bool popJob(const std::optional<unsigned> &node, Job &job);
+
+  /// @brief - Used to find a queue with a job of lower priority than the input one
+  /// which waited long enough to be processed first. Assumes that the locker
+  /// protecting the queues is acquired.
+  /// @param node - the node of the thread or an empty value if it's not pinned.
+  /// @param priority - the priority of the job which would be processed otherwise.
+  /// @return - the queue holding the aged job or `nullptr` if there's none.
+  auto agedQueue(const std::optional<unsigned> &node, const Priority priority) -> JobQueue *;
+
+  /// @brief - Used to communicate a processed job to the results handling thread.
+  /// @param job - the job which was just computed.
+  void pushResult(Job job);
+
+  /// @brief - Used to register a callable in the queue matching its priority and
+  /// to wake up a thread to process it.
+  /// @param task - the callable to register.
+  /// @param priority - the priority of the callable.
+  void enqueueTask(SmallTask &&task, const Priority priority);
+
+  /// @brief - Used to execute a job fetched by a thread of the pool, be it an
+  /// `AsynchronousJob` or a callable.
+  /// @param job - the job to execute.
+  /// @param lane - the index of the counters of the executing thread.
+  void processJob(Job &job, const unsigned lane);
+
+  /// @brief - Update the counters of the executing thread once a job is done and
+  /// record its execution when tracing.
+  /// @param job - the job which was executed.
+  /// @param lane - the index of the counters of the executing thread.
+  /// @param start - the moment the execution started.
+  /// @param token - the token used by the job, if any.
+  void recordExecution(const Job &job,
+                       const unsigned lane,
+                       const std::chrono::steady_clock::time_point start,
+                       const CancellationToken *token = nullptr);
+
+  /// @brief - The index of the counters used by external threads executing jobs,
+  /// right after the ones of the threads of the pool.
+  auto externalLane() const noexcept -> unsigned;
+
+  /// @brief - Used to retrieve the shared queue holding the jobs of the input
+  /// priority. Assumes that the locker protecting the queues is acquired.
+  /// @param priority - the priority of the jobs.
+  /// @param node - the node the jobs should run on. Jobs for a node on which no
+  /// thread is pinned go to the queues shared by all nodes.
+  /// @return - the queue for this priority.
+  auto queueFor(const Priority priority, const std::optional<unsigned> &node = {}) noexcept
+    -> JobQueue &;
+
+  /// @brief - Used to find the queue from which a thread of the input node should
+  /// fetch its next job with the specified priority. Queues of the node come first,
+  /// then the ones shared by all nodes and finally the ones of the other nodes, so
+  /// that jobs are not stuck in case the threads of their node are busy. Assumes
+  /// that the locker protecting the queues is acquired.
+  /// @param priority - the priority of the jobs.
+  /// @param node - the node of the thread or an empty value if it's not pinned.
+  /// @return - a non-empty queue or `nullptr` if there are no jobs with this priority.
+  auto nextQueue(const Priority priority, const std::optional<unsigned> &node) noexcept
+    -> JobQueue *;
+
+  /// @brief - Used to remove all the jobs waiting in the queues. Assumes that the
+  /// locker protecting the queues is acquired. The jobs are moved out rather than
+  /// destroyed: dropping a job may resume a coroutine, see `schedule`, which must
+  /// happen once the lockers are released.
+  /// @param dropped - receives the removed jobs.
+  void clearJobs(std::vector<Job> &dropped);
+
+  /// @brief - Used to count the jobs waiting in the queues. Assumes that the locker
+  /// protecting the queues is acquired.
+  /// @return - the number of pending jobs.
+  auto pendingJobs() const noexcept -> std::size_t;
+
+  /// @brief - Used by the results thread to gather completed jobs. It waits for
+  /// at least one job and then for as many as needed to fill a batch, within
+  /// the limits defined by `setResultsBatching`.
+  /// @return - `false` if the results thread should terminate.
+  bool collectResults();
+
+  /// @brief - Used by the results thread to wait until the results queue holds
+  /// at least `count` jobs or the deadline is reached.
+  /// @param count - the number of jobs to wait for.
+  /// @param deadline - a time after which the method returns anyway. An empty
+  /// value means that no time limit is applied.
+  void waitForResults(const std::size_t count,
+                      const std::optional<std::chrono::steady_clock::time_point> &deadline);
+
   /// @brief - Used as a thread loop method when creating the pool to handle the results produced
   /// by the threads and notify it somehow to external listeners. The results are analyzed to determine
   /// whether they belong to the batch currently being processed: in any other case they are discarded.
   void resultsHandlingLoop();
 
+  /// @brief - Used to register a job in the timers and to start the timers thread
+  /// if needed.
+  /// @param job - the job to enqueue.
+  /// @param deadline - the moment the job should be enqueued.
+  /// @param period - the period of the job or `0` if it is enqueued once.
+  /// @return - the identifier of the timer.
+  auto addTimer(AsynchronousJobShPtr job,
+                const std::chrono::steady_clock::time_point &deadline,
+                const std::uint64_t period) -> TimerId;
+
+  /// @brief - Convert a moment to a tick of the timers, rounded up so that jobs
+  /// are never enqueued early.
+  /// @param moment - the moment to convert.
+  /// @return - the corresponding tick.
+  auto toTimerTick(const std::chrono::steady_clock::time_point &moment) const noexcept
+    -> std::uint64_t;
+
+  /// @brief - Used as a thread loop method to enqueue the jobs of the timers when
+  /// they are due. The thread sleeps until the next expiration of a timer.
+  void timersLoop();
+
   /**
        * @brief - Used to determine whether any jobs at all are registered. Scans all the priority queues
        *          and return `true` if at least one of them is not empty. Assumes that the locker used to
@@ -80,21 +696,15 @@ class ThreadPool : public CoreObject
        */
   bool hasJobs() const noexcept;
 
-  private:
-  /**
-       * @brief - Convenience define to refer to a unique lock on the mutex used to
-       *          protect the pool's running status.
-       */
-  using UniqueGuard = std::unique_lock<std::mutex>;
+  /// @brief - Used in work stealing mode to determine whether any of the local
+  /// queues of the threads holds a job. The answer is only an approximation as
+  /// threads keep on pushing and popping jobs concurrently.
+  /// @return - `true` if at least one local queue is not empty.
+  bool hasLocalJobs() const noexcept;
 
-  /// @brief - Convenience structure representing a job and the corresponding batch
-  /// index. This allows to identify whether a result is linked to the current
-  /// batch or to an old one.
-  struct Job
-  {
-    AsynchronousJobShPtr task{};
-    unsigned batch{0u};
-  };
+  private:
+  /// @brief - The strategy used by the threads to fetch jobs.
+  SchedulingMode m_mode{SchedulingMode::SharedQueue};
 
   /// @brief - A mutex protecting concurrent accesses to the threads composing the
   /// pool. Typically used to start or stop the thread pool.
@@ -106,55 +716,149 @@ class ThreadPool : public CoreObject
 
   /// @brief - Keep track of whether the pool is running. As long as this value is
   /// `true` individual threads can continue fetching information and wait for jobs.
-  bool m_poolRunning{false};
+  /// The value is only modified under the `m_poolLocker` but can be read without
+  /// it by threads in work stealing mode.
+  std::atomic_bool m_poolRunning{false};
 
   /// @brief - Indicates whether there are some jobs to process. A `true` value
-  /// tells that the internal queue for computing jobs has at least one value. We
-  /// protect this boolean behind the same locker (i.e. the `m_poolLocker` one) as
-  /// the `m_poolRunning` boolean because we want threads to be notified either
-  /// when the pool needs to be terminated or when some new jobs are available.
-  bool m_jobsAvailable{false};
+  /// tells that the internal queue for computing jobs has at least one value. It
+  /// is modified along with the queues, under the `m_jobsLocker`, but can be read
+  /// without locking by idle threads. Sleeping threads are woken up under the
+  /// `m_poolLocker` when it becomes `true`.
+  std::atomic_bool m_jobsAvailable{false};
+
+  /// @brief - The bounds on the number of threads of the pool.
+  PoolSizing m_sizing{};
 
   /// @brief - Protect concurrent accesses to the array of threads.
-  std::mutex m_threadsLocker{};
+  mutable std::mutex m_threadsLocker{};
 
-  /// @brief - The threads used by the pool. When the pool is up and running there
-  /// should be the configured amount of threads registered in the vector. A
-  /// termination of the pool destroys the thread but in general they should not be
-  /// accessed directly.
+  /// @brief - The threads used by the pool. There's one slot for each thread the
+  /// pool can have but only the active ones are processing jobs: the others are
+  /// either not started yet or terminated and waiting to be joined. A termination
+  /// of the pool destroys the thread but in general they should not be accessed
+  /// directly.
   std::vector<std::thread> m_threads{};
 
+  /// @brief - Whether each slot of `m_threads` holds a thread processing jobs.
+  std::vector<bool> m_activeSlots{};
+
+  /// @brief - The number of threads processing jobs.
+  std::atomic_uint m_activeThreads{0u};
+
+  /// @brief - The CPU each thread should be pinned to, if any.
+  std::vector<std::optional<unsigned>> m_threadCpus{};
+
   /// @brief - Protect concurrent accesses to the jobs queue and related properties.
   std::mutex m_jobsLocker{};
 
   /// @brief - The list of jobs currently available for processing. Contains all the
-  /// high priority jobs.
-  std::vector<Job> m_hPrioJobs{};
+  /// high priority jobs. The queues are allocated upfront so that enqueuing jobs
+  /// usually doesn't allocate memory.
+  JobQueue m_hPrioJobs{JOBS_QUEUE_CAPACITY};
 
   /// @brief - Similar to the `m_hPrioJobs` queue but contains normal priority jobs.
-  std::vector<Job> m_nPrioJobs{};
+  JobQueue m_nPrioJobs{JOBS_QUEUE_CAPACITY};
 
   /// @brief - Similar to the `m_hPrioJobs` queue but contains the low priority jobs.
-  std::vector<Job> m_lPrioJobs{};
+  JobQueue m_lPrioJobs{JOBS_QUEUE_CAPACITY};
+
+  /// @brief - The order in which the jobs of a given priority are processed.
+  JobOrdering m_ordering{JobOrdering::Lifo};
+
+  /// @brief - The waiting time in nanoseconds after which a job is promoted to the
+  /// next priority level. A value of `0` disables the aging of jobs.
+  std::atomic<std::chrono::nanoseconds::rep> m_agingThreshold{0};
+
+  /// @brief - The counters of each thread slot, followed by the ones shared by the
+  /// external threads executing jobs through `runPendingJob`.
+  std::unique_ptr<ThreadCounters[]> m_counters{};
+
+  /// @brief - Records the events of the threads of the pool when tracing. Lanes
+  /// are ordered like the counters, with an additional one for the results thread.
+  std::unique_ptr<TraceRecorder> m_tracer{};
+
+  /// @brief - The topology of the machine, used to place the threads.
+  CpuTopology m_topology{};
+
+  /// @brief - The queues holding the jobs which should run on a specific node. Only
+  /// defined when the threads are pinned: jobs for any node are kept in the shared
+  /// queues otherwise.
+  std::vector<JobQueues> m_nodeJobs{};
+
+  /// @brief - The number of threads processing jobs pinned to each node. Jobs for
+  /// a node without such threads are kept in the shared queues. Modified under
+  /// the `m_jobsLocker`.
+  std::vector<unsigned> m_nodeThreads{};
+
+  /// @brief - The node of each thread of the pool or an empty value in case the
+  /// thread is not pinned.
+  std::vector<std::optional<unsigned>> m_threadNodes{};
+
+  /// @brief - The local queues of each thread when the pool is in work stealing
+  /// mode. Empty otherwise.
+  std::vector<std::unique_ptr<Worker>> m_workers{};
+
+  /// @brief - Incremented each time the pending jobs are cleared. The jobs which
+  /// already moved to a local queue of a thread are discarded if their purge index
+  /// does not match this value anymore.
+  std::atomic_uint m_purgeIndex{0u};
+
+  /// @brief - The number of threads sleeping while waiting for jobs. Allows to
+  /// avoid locking when nobody needs to be woken up.
+  std::atomic_uint m_sleepers{0u};
+
+  /// @brief - The number of idle threads spinning while waiting for jobs.
+  std::atomic_uint m_spinners{0u};
+
+  /// @brief - The moment, in nanoseconds since the epoch of the steady clock, at
+  /// which jobs started to wait with no idle thread to process them. A value of
+  /// `0` means that the pool is keeping up with the load.
+  std::atomic<std::chrono::nanoseconds::rep> m_backlogSince{0};
 
   /// @brief - An index identifying the current batch of jobs being fed to the
   /// threads. Any completion related to another batch will be discarded as it's
   /// probably irrelevant anymore.
-  unsigned m_batchIndex{0u};
+  std::atomic_uint m_batchIndex{0u};
 
-  /// @brief - Protects the access to the results properties (thread and waiting condition).
+  /// @brief - Protects the waiting condition used to put the results thread to sleep.
   std::mutex m_resultsLocker{};
 
   /// @brief - Indicates whether the results handling process should still be occuring.
   /// This allows to terminate gracefully the results thread.
-  bool m_resultsHandling{false};
+  std::atomic_bool m_resultsHandling{false};
+
+  /// @brief - The list of jobs already computed, available for analysis. Threads of
+  /// the pool push into it without locking and the results thread drains it.
+  MpscQueue<Job> m_results{RESULTS_QUEUE_CAPACITY};
+
+  /// @brief - The number of jobs the results thread is waiting for while sleeping. A
+  /// value of `0` indicates that it is not sleeping: in this case the threads of the
+  /// pool don't need to wake it up after pushing a result.
+  std::atomic<std::size_t> m_resultsWakeAt{0u};
+
+  /// @brief - The maximum number of jobs notified at once through `onJobsCompleted`.
+  std::atomic_uint m_maxBatch{RESULTS_QUEUE_CAPACITY};
 
-  /// @brief - The list of jobs already computed, available for analysis.
-  std::vector<Job> m_results{};
+  /// @brief - The maximum time in microseconds the results thread waits to fill a batch.
+  std::atomic<std::chrono::microseconds::rep> m_maxDelay{0};
+
+  /// @brief - The jobs gathered by the results thread for the next notification. Kept
+  /// as attributes to avoid reallocating them for each batch.
+  std::vector<Job> m_collected{};
+  std::vector<AsynchronousJobShPtr> m_notified{};
+
+  /// @brief - Statistics about the notification of results. Only written by the results
+  /// thread but can be read from any thread through `completionStats`.
+  std::atomic_uint64_t m_emissions{0u};
+  std::atomic_uint64_t m_notifiedJobs{0u};
+  std::atomic_uint64_t m_discardedJobs{0u};
+  std::atomic<std::chrono::nanoseconds::rep> m_totalLatency{0};
+  std::atomic<std::chrono::nanoseconds::rep> m_maxLatency{0};
 
   /// @brief - Defines whether the job related to an old batch should be considered valid
   /// or if no notification should be produced for them.
-  bool m_invalidateOld{true};
+  std::atomic_bool m_invalidateOld{true};
 
   /// @brief - Waiting condition to communicate results to the dedicated thread.
   std::condition_variable m_resWaiter{};
@@ -167,6 +871,29 @@ class ThreadPool : public CoreObject
   /// hang the program.
   std::thread m_resultsHandlingThread{};
 
+  /// @brief - The moment of the first tick of the timers. Ticks last a millisecond.
+  std::chrono::steady_clock::time_point m_timersOrigin{std::chrono::steady_clock::now()};
+
+  /// @brief - Protects the timers and the related properties.
+  mutable std::mutex m_timersLocker{};
+
+  /// @brief - Used to put the timers thread to sleep until the next expiration.
+  std::condition_variable m_timersWaiter{};
+
+  /// @brief - The jobs waiting to be enqueued at a later time.
+  TimerWheel<AsynchronousJobShPtr> m_timers{};
+
+  /// @brief - The tick at which the timers thread will wake up. Registering a
+  /// timer only needs to wake it up in case the timer expires before.
+  std::uint64_t m_timersWakeAt{UINT64_MAX};
+
+  /// @brief - Whether the timers thread should keep running.
+  bool m_timersRunning{false};
+
+  /// @brief - The thread enqueuing the jobs of the timers. Only started when the
+  /// first timer is registered.
+  std::thread m_timersThread{};
+
   public:
   /// @brief - This signal is emitted by the scheduler as soon as some jobs have been
   /// successfully rendered by the thread pool.
@@ -178,3 +905,5 @@ class ThreadPool : public CoreObject
 using ThreadPoolShPtr = std::shared_ptr<ThreadPool>;
 
 } // namespace utils
+
+#include "ThreadPool.hxx"
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ThreadPool.hh"
+
+namespace utils {
+
+template<typename F>
+inline auto ThreadPool::submit(F &&func, const Priority priority)
+  -> Future<std::decay_t<std::invoke_result_t<std::decay_t<F>>>>
+{
+  using Result = std::decay_t<std::invoke_result_t<std::decay_t<F>>>;
+
+  Promise<Result> promise;
+  auto future = promise.getFuture();
+
+  enqueueTask(SmallTask(
+                [promise = std::move(promise), func = std::forward<F>(func)]() mutable {
+                  try
+                  {
+                    if constexpr (std::is_void<Result>::value)
+                    {
+                      func();
+                      promise.setValue();
+                    }
+                    else
+                    {
+                      promise.setValue(func());
+                    }
+                  }
+                  catch (...)
+                  {
+                    promise.setException(std::current_exception());
+                  }
+                }),
+              priority);
+
+  return future;
+}
+
+template<typename F>
+inline void ThreadPool::post(F &&func, const Priority priority)
+{
+  enqueueTask(SmallTask(std::forward<F>(func)), priority);
+}
+
+} // namespace utils
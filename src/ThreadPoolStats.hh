@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace utils {
+
+/// @brief - Statistics about the notification of completed jobs by a thread
+/// pool. They allow to tune the batching of results for either throughput or
+/// latency.
+struct CompletionStats
+{
+  /// @brief - The number of times the `onJobsCompleted` signal was emitted.
+  std::uint64_t emissions{0u};
+
+  /// @brief - The number of jobs notified through the `onJobsCompleted` signal.
+  std::uint64_t jobs{0u};
+
+  /// @brief - The number of completed jobs which were not notified because they
+  /// belonged to an invalidated batch.
+  std::uint64_t discarded{0u};
+
+  /// @brief - The accumulated time elapsed between the end of the computation of
+  /// the notified jobs and the emission of the signal for them.
+  std::chrono::nanoseconds totalLatency{0};
+
+  /// @brief - The longest time elapsed between the end of the computation of a
+  /// job and the emission of the signal for it.
+  std::chrono::nanoseconds maxLatency{0};
+};
+
+/// @brief - Distribution of a duration measured for each job processed by a pool,
+/// such as the time spent in the queues or the time spent executing.
+struct DurationStats
+{
+  /// @brief - The number of jobs which were processed.
+  std::uint64_t jobs{0u};
+
+  std::chrono::nanoseconds p50{0};
+  std::chrono::nanoseconds p90{0};
+  std::chrono::nanoseconds p99{0};
+  std::chrono::nanoseconds max{0};
+};
+
+/// @brief - Distribution of the time spent by the jobs of a given priority in the
+/// queues of a pool before being processed.
+using WaitTimeStats = DurationStats;
+
+/// @brief - Activity of a single thread of a pool.
+struct ThreadStats
+{
+  /// @brief - The number of jobs executed by the thread.
+  std::uint64_t jobs{0u};
+
+  /// @brief - In work stealing mode, the number of jobs the thread took from the
+  /// local queues of other threads.
+  std::uint64_t steals{0u};
+
+  /// @brief - The number of times the thread went to sleep for lack of jobs.
+  std::uint64_t parks{0u};
+
+  /// @brief - The accumulated time spent executing jobs.
+  std::chrono::nanoseconds busy{0};
+};
+
+/// @brief - Statistics about the jobs computed while their result was not needed
+/// anymore, and about the jobs which stopped early thanks to their cancellation
+/// token.
+struct CancellationStats
+{
+  /// @brief - The number of jobs which stopped early because their token reported
+  /// that they were cancelled or late.
+  std::uint64_t interrupted{0u};
+
+  /// @brief - The number of jobs whose batch was cancelled by the time they were
+  /// done, be they interrupted or not. Their results are discarded.
+  std::uint64_t stale{0u};
+
+  /// @brief - The number of jobs which were done after their deadline.
+  std::uint64_t late{0u};
+
+  /// @brief - The time spent computing stale jobs.
+  std::chrono::nanoseconds wasted{0};
+
+  /// @brief - An estimation of the time saved by interrupting jobs: the average
+  /// execution time of the jobs which were not interrupted is used as the time
+  /// the interrupted ones would have taken otherwise.
+  std::chrono::nanoseconds saved{0};
+};
+
+/// @brief - A snapshot of the activity of a thread pool since its creation.
+struct PoolStats
+{
+  /// @brief - The activity of each thread slot of the pool. The last entry gathers
+  /// the jobs executed by external threads through `runPendingJob`.
+  std::vector<ThreadStats> threads{};
+
+  /// @brief - The sum of the activity of all the threads.
+  ThreadStats total{};
+
+  /// @brief - The time spent by the jobs in the queues, indexed by priority.
+  std::array<DurationStats, 3u> waitTimes{};
+
+  /// @brief - The time spent by the jobs executing, all priorities included.
+  DurationStats executionTimes{};
+
+  /// @brief - The lag of the results thread when notifying completed jobs.
+  CompletionStats completion{};
+
+  /// @brief - The work spent on jobs which were not needed anymore.
+  CancellationStats cancellation{};
+};
+
+} // namespace utils
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace utils {
+
+/// @brief - A hierarchical timing wheel holding timers expressed in ticks. Each
+/// level is a ring of `SLOTS` lists of timers: the first level has a resolution
+/// of a tick and each next level has a resolution `SLOTS` times coarser. Timers
+/// are moved to finer levels as time goes by, so that inserting and cancelling
+/// a timer are constant time operations regardless of the number of timers.
+/// Timers are stored in a slab and linked in the lists of the wheel through
+/// indices, so that the wheel only allocates memory when it grows.
+/// This class is not thread-safe.
+template<typename T>
+class TimerWheel
+{
+  public:
+  /// @brief - Identifies a timer of the wheel. It stays valid until the timer
+  /// expires or is cancelled, and is never reused afterwards.
+  using TimerId = std::uint64_t;
+
+  /// @brief - Create an empty wheel starting at the input tick.
+  /// @param now - the current tick.
+  TimerWheel(const std::uint64_t now = 0u);
+
+  /// @brief - Register a new timer. A deadline in the past expires during the
+  /// next call to `advance`.
+  /// @param deadline - the tick at which the timer expires.
+  /// @param period - for periodic timers, the number of ticks between two
+  /// expirations. A value of `0` defines a timer expiring once.
+  /// @param payload - the data attached to the timer.
+  /// @return - the identifier of the timer.
+  auto add(const std::uint64_t deadline, const std::uint64_t period, T payload) -> TimerId;
+
+  /// @brief - Remove a timer from the wheel.
+  /// @param id - the identifier of the timer.
+  /// @return - `true` if the timer was still pending.
+  bool cancel(const TimerId id);
+
+  /// @brief - Move the wheel forward to the input tick, calling `expired` with the
+  /// payload of each timer whose deadline is reached. Periodic timers are then
+  /// registered again for their next deadline: deadlines which are already past
+  /// are skipped so that a late wheel doesn't fire a burst of expirations. The
+  /// callable must not modify the wheel.
+  /// @param now - the current tick.
+  /// @param expired - the callable invoked for each expired timer.
+  template<typename Callback>
+  void advance(const std::uint64_t now, Callback &&expired);
+
+  /// @brief - Compute a tick before which no timer expires. The wheel should be
+  /// advanced at this tick at the latest: timers registered in the coarser levels
+  /// are only moved to finer levels at this moment.
+  /// @return - the tick or an empty value in case the wheel is empty.
+  auto nextExpiry() const noexcept -> std::optional<std::uint64_t>;
+
+  /// @brief - The tick the wheel was last advanced to.
+  auto now() const noexcept -> std::uint64_t;
+
+  /// @brief - The number of pending timers.
+  auto size() const noexcept -> std::size_t;
+
+  bool empty() const noexcept;
+
+  private:
+  static constexpr auto SLOT_BITS = 6u;
+  static constexpr auto SLOTS     = 1u << SLOT_BITS;
+  static constexpr auto SLOT_MASK = std::uint64_t{SLOTS - 1u};
+
+  /// @brief - With a tick of a millisecond, five levels cover about twelve days.
+  /// Timers further away wait in an overflow list.
+  static constexpr auto LEVELS = 5u;
+
+  static constexpr auto NIL           = UINT32_MAX;
+  static constexpr auto OVERFLOW_LIST = LEVELS * SLOTS;
+  static constexpr auto LISTS_COUNT   = LEVELS * SLOTS + 1u;
+
+  struct Node
+  {
+    std::uint64_t deadline{0u};
+    std::uint64_t period{0u};
+    T payload{};
+
+    /// @brief - Incremented each time the node is released, so that stale
+    /// identifiers don't match a reused node.
+    std::uint32_t generation{0u};
+
+    /// @brief - The list holding the node, or `NIL` if the node is free.
+    std::uint32_t list{NIL};
+    std::uint32_t prev{NIL};
+    std::uint32_t next{NIL};
+  };
+
+  /// @brief - Insert the node in the list matching its deadline.
+  void insert(const std::uint32_t id);
+
+  void link(const std::uint32_t id, const std::uint32_t list);
+  void unlink(const std::uint32_t id);
+
+  /// @brief - Put the node back in the free list.
+  void release(const std::uint32_t id);
+
+  /// @brief - Redistribute the timers of the coarser levels reaching the input
+  /// tick to the finer levels.
+  void cascade(const std::uint64_t tick);
+
+  /// @brief - Expire the timers of the first level for the input tick.
+  template<typename Callback>
+  void expire(const std::uint64_t tick, Callback &expired);
+
+  private:
+  std::uint64_t m_now;
+  std::size_t m_size{0u};
+
+  std::vector<Node> m_nodes{};
+  std::uint32_t m_free{NIL};
+
+  std::array<std::uint32_t, LISTS_COUNT> m_heads{};
+
+  /// @brief - For each level, a bit is set for each non-empty slot.
+  std::array<std::uint64_t, LEVELS> m_occupied{};
+};
+
+} // namespace utils
+
+#include "TimerWheel.hxx"
@@ -0,0 +1,308 @@
+#pragma once
+
+#include "TimerWheel.hh"
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace utils {
+
+template<typename T>
+inline TimerWheel<T>::TimerWheel(const std::uint64_t now)
+  : m_now(now)
+{
+  m_heads.fill(NIL);
+}
+
+template<typename T>
+inline auto TimerWheel<T>::add(const std::uint64_t deadline, const std::uint64_t period, T payload)
+  -> TimerId
+{
+  std::uint32_t id = m_free;
+  if (id != NIL)
+  {
+    m_free = m_nodes[id].next;
+  }
+  else
+  {
+    id = static_cast<std::uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+  }
+
+  auto &node = m_nodes[id];
+
+  // Deadlines in the past expire at the next tick.
+  node.deadline = std::max(deadline, m_now + 1u);
+  node.period   = period;
+  node.payload  = std::move(payload);
+
+  insert(id);
+  ++m_size;
+
+  return (static_cast<TimerId>(node.generation) << 32u) | id;
+}
+
+template<typename T>
+inline bool TimerWheel<T>::cancel(const TimerId id)
+{
+  const auto index      = static_cast<std::uint32_t>(id & UINT32_MAX);
+  const auto generation = static_cast<std::uint32_t>(id >> 32u);
+
+  if (index >= m_nodes.size())
+  {
+    return false;
+  }
+
+  const auto &node = m_nodes[index];
+  if (node.generation != generation || node.list == NIL)
+  {
+    return false;
+  }
+
+  unlink(index);
+  release(index);
+
+  return true;
+}
+
+template<typename T>
+template<typename Callback>
+inline void TimerWheel<T>::advance(const std::uint64_t now, Callback &&expired)
+{
+  while (m_now < now)
+  {
+    const auto tick = m_now + 1u;
+    m_now           = tick;
+
+    if ((tick & SLOT_MASK) == 0u)
+    {
+      cascade(tick);
+    }
+
+    expire(tick, expired);
+
+    // Nothing happens until the next cascade when the first level is
+    // empty: jump right before it.
+    if (m_occupied[0] == 0u)
+    {
+      m_now = std::min(now, m_now | SLOT_MASK);
+    }
+  }
+}
+
+template<typename T>
+inline auto TimerWheel<T>::nextExpiry() const noexcept -> std::optional<std::uint64_t>
+{
+  if (m_size == 0u)
+  {
+    return {};
+  }
+
+  std::optional<std::uint64_t> out;
+
+  for (auto level = 0u; level < LEVELS; ++level)
+  {
+    if (m_occupied[level] == 0u)
+    {
+      continue;
+    }
+
+    // Look for the first non-empty slot after the current one: the
+    // bit `k` of the rotated mask is the slot `current + 1 + k`.
+    const auto shift   = SLOT_BITS * level;
+    const auto current = m_now >> shift;
+    const auto rotated = std::rotr(m_occupied[level], static_cast<int>((current + 1u) & SLOT_MASK));
+    const auto offset  = static_cast<std::uint64_t>(std::countr_zero(rotated));
+
+    const auto tick = (current + 1u + offset) << shift;
+    out             = std::min(out.value_or(tick), tick);
+  }
+
+  if (m_heads[OVERFLOW_LIST] != NIL)
+  {
+    const auto shift = SLOT_BITS * (LEVELS - 1u);
+    const auto tick  = ((m_now >> shift) + 1u) << shift;
+    out              = std::min(out.value_or(tick), tick);
+  }
+
+  return out;
+}
+
+template<typename T>
+inline auto TimerWheel<T>::now() const noexcept -> std::uint64_t
+{
+  return m_now;
+}
+
+template<typename T>
+inline auto TimerWheel<T>::size() const noexcept -> std::size_t
+{
+  return m_size;
+}
+
+template<typename T>
+inline bool TimerWheel<T>::empty() const noexcept
+{
+  return m_size == 0u;
+}
+
+template<typename T>
+inline void TimerWheel<T>::insert(const std::uint32_t id)
+{
+  // The deadline is never before the current tick: a deadline equal
+  // to it only happens while cascading, right before the timers of
+  // this tick expire.
+  const auto deadline = m_nodes[id].deadline;
+  const auto delta    = deadline - m_now;
+
+  for (auto level = 0u; level < LEVELS; ++level)
+  {
+    const auto shift = SLOT_BITS * level;
+    if (delta < (std::uint64_t{1u} << (shift + SLOT_BITS)))
+    {
+      const auto slot = (deadline >> shift) & SLOT_MASK;
+      link(id, static_cast<std::uint32_t>(level * SLOTS + slot));
+      return;
+    }
+  }
+
+  link(id, OVERFLOW_LIST);
+}
+
+template<typename T>
+inline void TimerWheel<T>::link(const std::uint32_t id, const std::uint32_t list)
+{
+  auto &node = m_nodes[id];
+  node.list  = list;
+  node.prev  = NIL;
+  node.next  = m_heads[list];
+
+  if (node.next != NIL)
+  {
+    m_nodes[node.next].prev = id;
+  }
+
+  m_heads[list] = id;
+
+  if (list != OVERFLOW_LIST)
+  {
+    m_occupied[list / SLOTS] |= std::uint64_t{1u} << (list % SLOTS);
+  }
+}
+
+template<typename T>
+inline void TimerWheel<T>::unlink(const std::uint32_t id)
+{
+  auto &node      = m_nodes[id];
+  const auto list = node.list;
+
+  if (node.prev != NIL)
+  {
+    m_nodes[node.prev].next = node.next;
+  }
+  else
+  {
+    m_heads[list] = node.next;
+  }
+
+  if (node.next != NIL)
+  {
+    m_nodes[node.next].prev = node.prev;
+  }
+
+  if (m_heads[list] == NIL && list != OVERFLOW_LIST)
+  {
+    m_occupied[list / SLOTS] &= ~(std::uint64_t{1u} << (list % SLOTS));
+  }
+
+  node.list = NIL;
+  node.prev = NIL;
+  node.next = NIL;
+}
+
+template<typename T>
+inline void TimerWheel<T>::release(const std::uint32_t id)
+{
+  auto &node   = m_nodes[id];
+  node.payload = T{};
+  node.list    = NIL;
+  node.next    = m_free;
+  ++node.generation;
+
+  m_free = id;
+  --m_size;
+}
+
+template<typename T>
+inline void TimerWheel<T>::cascade(const std::uint64_t tick)
+{
+  const auto redistribute = [this](const std::uint32_t list) {
+    auto id       = m_heads[list];
+    m_heads[list] = NIL;
+
+    while (id != NIL)
+    {
+      const auto next = m_nodes[id].next;
+      insert(id);
+      id = next;
+    }
+  };
+
+  for (auto level = 1u; level < LEVELS; ++level)
+  {
+    const auto slot = (tick >> (SLOT_BITS * level)) & SLOT_MASK;
+
+    m_occupied[level] &= ~(std::uint64_t{1u} << slot);
+    redistribute(static_cast<std::uint32_t>(level * SLOTS + slot));
+
+    // The coarser levels only move when this one wraps around.
+    if (slot != 0u)
+    {
+      return;
+    }
+  }
+
+  // The last level wrapped: some timers of the overflow list might now
+  // fit in the wheel.
+  redistribute(OVERFLOW_LIST);
+}
+
+template<typename T>
+template<typename Callback>
+inline void TimerWheel<T>::expire(const std::uint64_t tick, Callback &expired)
+{
+  const auto slot = tick & SLOT_MASK;
+  auto id         = m_heads[slot];
+
+  m_heads[slot] = NIL;
+  m_occupied[0] &= ~(std::uint64_t{1u} << slot);
+
+  while (id != NIL)
+  {
+    auto &node      = m_nodes[id];
+    const auto next = node.next;
+    node.list       = NIL;
+
+    expired(std::as_const(node.payload));
+
+    if (node.period == 0u)
+    {
+      release(id);
+    }
+    else
+    {
+      // Skip the periods which were missed by a late wheel.
+      node.deadline += node.period;
+      if (node.deadline <= m_now)
+      {
+        node.deadline += ((m_now - node.deadline) / node.period + 1u) * node.period;
+      }
+
+      insert(id);
+    }
+
+    id = next;
+  }
+}
+
+} // namespace utils
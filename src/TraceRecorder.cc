@@ -0,0 +1,200 @@
+#include "TraceRecorder.hh"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <thread>
+
+namespace utils {
+namespace {
+void writeEscaped(std::ostream &out, const std::string_view str)
+{
+  for (const auto c : str)
+  {
+    switch (c)
+    {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      case '\t':
+        out << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20u)
+        {
+          char code[8];
+          std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+          out << code;
+        }
+        else
+        {
+          out << c;
+        }
+        break;
+    }
+  }
+}
+
+/// @brief - Timestamps in the trace format are expressed in microseconds.
+auto toMicroseconds(const std::chrono::steady_clock::duration d) -> double
+{
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+} // namespace
+
+TraceRecorder::TraceRecorder(const std::vector<std::string> &lanes)
+{
+  m_lanes.reserve(lanes.size());
+  for (const auto &name : lanes)
+  {
+    m_lanes.push_back(std::make_unique<Lane>());
+    m_lanes.back()->name = name;
+  }
+}
+
+void TraceRecorder::start(const std::size_t capacity)
+{
+  m_enabled.store(false);
+
+  for (auto &lane : m_lanes)
+  {
+    // Threads which saw the recording enabled might still be writing.
+    while (lane->writers.load() > 0u)
+    {
+      std::this_thread::yield();
+    }
+
+    if (lane->capacity != capacity)
+    {
+      lane->events   = std::make_unique<Event[]>(capacity);
+      lane->capacity = capacity;
+    }
+    else
+    {
+      const auto used = std::min(lane->used.load(std::memory_order_relaxed), capacity);
+      for (std::size_t id = 0u; id < used; ++id)
+      {
+        lane->events[id].ready.store(false, std::memory_order_relaxed);
+      }
+    }
+
+    lane->used.store(0u, std::memory_order_relaxed);
+  }
+
+  m_dropped.store(0u, std::memory_order_relaxed);
+  m_origin.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                 std::memory_order_relaxed);
+  m_enabled.store(true, std::memory_order_release);
+}
+
+void TraceRecorder::stop() noexcept
+{
+  m_enabled.store(false, std::memory_order_release);
+}
+
+bool TraceRecorder::enabled() const noexcept
+{
+  return m_enabled.load(std::memory_order_relaxed);
+}
+
+void TraceRecorder::record(const unsigned lane,
+                           const std::string_view name,
+                           const char *category,
+                           const std::chrono::steady_clock::time_point start,
+                           const std::chrono::steady_clock::time_point end)
+{
+  if (!enabled() || lane >= m_lanes.size())
+  {
+    return;
+  }
+
+  // Registering as a writer before checking the recording again lets `start`
+  // wait for the threads which might use the slots.
+  auto &target = *m_lanes[lane];
+  target.writers.fetch_add(1u);
+
+  if (m_enabled.load())
+  {
+    const auto id = target.used.fetch_add(1u, std::memory_order_relaxed);
+    if (id < target.capacity)
+    {
+      auto &event     = target.events[id];
+      const auto size = std::min<std::size_t>(name.size(), NAME_CAPACITY);
+      std::memcpy(event.name, name.data(), size);
+
+      event.size     = static_cast<std::uint8_t>(size);
+      event.category = category;
+      event.start    = start;
+      event.end      = end;
+      event.ready.store(true, std::memory_order_release);
+    }
+    else
+    {
+      m_dropped.fetch_add(1u, std::memory_order_relaxed);
+    }
+  }
+
+  target.writers.fetch_sub(1u, std::memory_order_release);
+}
+
+auto TraceRecorder::dropped() const noexcept -> std::uint64_t
+{
+  return m_dropped.load(std::memory_order_relaxed);
+}
+
+void TraceRecorder::exportChromeTrace(std::ostream &out) const
+{
+  const auto origin = std::chrono::steady_clock::time_point(
+    std::chrono::steady_clock::duration(m_origin.load(std::memory_order_relaxed)));
+
+  // Keep a nanosecond resolution for the timestamps.
+  const auto flags     = out.flags();
+  const auto precision = out.precision();
+  out << std::fixed << std::setprecision(3);
+
+  out << "{\"traceEvents\":[";
+
+  auto first = true;
+  for (unsigned id = 0u; id < m_lanes.size(); ++id)
+  {
+    const auto &lane = *m_lanes[id];
+
+    // Metadata events give a name to the lanes.
+    out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+        << id << ",\"args\":{\"name\":\"";
+    writeEscaped(out, lane.name);
+    out << "\"}}";
+    first = false;
+
+    const auto used = std::min(lane.used.load(std::memory_order_relaxed), lane.capacity);
+    for (std::size_t slot = 0u; slot < used; ++slot)
+    {
+      // Skip the events still being written.
+      const auto &event = lane.events[slot];
+      if (!event.ready.load(std::memory_order_acquire))
+      {
+        continue;
+      }
+
+      out << ",\n{\"name\":\"";
+      writeEscaped(out, std::string_view(event.name, event.size));
+      out << "\",\"cat\":\"" << (event.category != nullptr ? event.category : "")
+          << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << id
+          << ",\"ts\":" << toMicroseconds(event.start - origin)
+          << ",\"dur\":" << toMicroseconds(event.end - event.start) << "}";
+    }
+  }
+
+  out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+  out.flags(flags);
+  out.precision(precision);
+}
+
+} // namespace utils
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utils {
+
+/// @brief - Records timed events happening on several threads and exports them
+/// in the trace event format understood by `chrome://tracing` and Perfetto. Each
+/// thread records its events in its own lane so that recording is not contended:
+/// the events are stored in slots allocated by `start` and recording takes no
+/// lock. The recording is disabled by default and checking whether it is enabled
+/// is a single atomic load.
+class TraceRecorder
+{
+  public:
+  /// @brief - Create a recorder with one lane for each of the input names. The
+  /// names are used to label the lanes in the exported trace.
+  /// @param lanes - the names of the lanes.
+  TraceRecorder(const std::vector<std::string> &lanes);
+
+  ~TraceRecorder() = default;
+
+  TraceRecorder(const TraceRecorder &) = delete;
+  TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+  /// @brief - Discard the events recorded so far and start recording new ones. At
+  /// most `capacity` events are kept per lane: later events are dropped so that
+  /// recording never allocates memory. Should not be called while the events are
+  /// exported.
+  /// @param capacity - the maximum number of events kept per lane.
+  void start(const std::size_t capacity);
+
+  /// @brief - Stop recording events. The events recorded so far are kept until
+  /// the next call to `start`.
+  void stop() noexcept;
+
+  /// @brief - Whether events are currently recorded.
+  /// @return - `true` if the recording is running.
+  bool enabled() const noexcept;
+
+  /// @brief - Register an event which started and ended at the input times. This
+  /// is a no-op in case the recording is not running.
+  /// @param lane - the lane of the thread which executed the event.
+  /// @param name - the name of the event, truncated to `NAME_CAPACITY` bytes.
+  /// @param category - the category of the event, used to filter events.
+  /// @param start - the moment the event started.
+  /// @param end - the moment the event ended.
+  void record(const unsigned lane,
+              const std::string_view name,
+              const char *category,
+              const std::chrono::steady_clock::time_point start,
+              const std::chrono::steady_clock::time_point end);
+
+  /// @brief - The number of events which could not be recorded because their
+  /// lane was full.
+  /// @return - the number of dropped events since the last call to `start`.
+  auto dropped() const noexcept -> std::uint64_t;
+
+  /// @brief - Write the events recorded so far as a JSON trace to the stream.
+  /// This is meant to be called once the recording is stopped: events recorded
+  /// while exporting might be missing from the trace.
+  /// @param out - the stream to write to.
+  void exportChromeTrace(std::ostream &out) const;
+
+  /// @brief - The maximum length of the name of an event. Longer names are
+  /// truncated, so that an event fits in a cache line.
+  static constexpr auto NAME_CAPACITY = 38u;
+
+  private:
+  struct Event
+  {
+    const char *category{nullptr};
+    std::chrono::steady_clock::time_point start{};
+    std::chrono::steady_clock::time_point end{};
+
+    /// @brief - Set once the event is completely written.
+    std::atomic_bool ready{false};
+    std::uint8_t size{0u};
+    char name[NAME_CAPACITY]{};
+  };
+
+  /// @brief - The events recorded in a lane. Lanes are mostly written by a single
+  /// thread, but the threads running jobs outside of a pool share a lane: slots
+  /// are reserved with an atomic counter.
+  struct alignas(64) Lane
+  {
+    std::string name{};
+    std::size_t capacity{0u};
+    std::unique_ptr<Event[]> events{};
+
+    /// @brief - The number of slots reserved, which can exceed the capacity.
+    std::atomic_size_t used{0u};
+
+    /// @brief - The number of threads currently recording an event in the lane,
+    /// waited for by `start` before reusing the slots.
+    std::atomic_uint writers{0u};
+  };
+
+  std::atomic_bool m_enabled{false};
+  std::atomic_uint64_t m_dropped{0u};
+
+  /// @brief - The moment the recording started, used as origin of the trace.
+  std::atomic<std::chrono::steady_clock::rep> m_origin{0};
+
+  std::vector<std::unique_ptr<Lane>> m_lanes{};
+};
+
+} // namespace utils
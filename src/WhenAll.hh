@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Task.hh"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+/// @brief - The result of `whenAll`: the values of the tasks in the order of the
+/// tasks, or nothing for tasks which don't return anything.
+template<typename T>
+using WhenAllResult = std::conditional_t<std::is_void<T>::value, void, std::vector<T>>;
+
+/// @brief - The result of `whenAny`: the index of the first task to complete and
+/// the value it returned, if any.
+template<typename T>
+using WhenAnyResult = std::conditional_t<std::is_void<T>::value,
+                                         std::size_t,
+                                         std::pair<std::size_t, T>>;
+
+/// @brief - Create a task starting all the input tasks concurrently and completing
+/// once all of them are done. The tasks are started one after the other in the
+/// thread awaiting the result: they run concurrently as soon as they schedule
+/// themselves on a pool. In case some tasks raise an exception, the one of the
+/// first of them in the list is rethrown once all tasks are done.
+/// @param tasks - the tasks to run.
+/// @return - a task returning the results of the tasks.
+template<typename T>
+auto whenAll(std::vector<Task<T>> tasks) -> Task<WhenAllResult<T>>;
+
+/// @brief - Create a task starting all the input tasks concurrently and completing
+/// as soon as one of them is done. The other tasks keep on running in the
+/// background until they are done and their results are discarded. In case the
+/// first task to complete raised an exception it is rethrown. An exception is
+/// raised in case the list of tasks is empty.
+/// @param tasks - the tasks to run.
+/// @return - a task returning the index and the result of the first task done.
+template<typename T>
+auto whenAny(std::vector<Task<T>> tasks) -> Task<WhenAnyResult<T>>;
+
+} // namespace utils
+
+#include "WhenAll.hxx"
@@ -0,0 +1,428 @@
+#pragma once
+
+#include "CoreException.hh"
+#include "WhenAll.hh"
+#include <atomic>
+#include <memory>
+
+namespace utils {
+namespace details {
+
+/// @brief - Counts the tasks of a `whenAll` which are done. The coroutine awaiting
+/// them counts as an additional task which is done once all the tasks started:
+/// the last one to arrive resumes the awaiting coroutine.
+class WhenAllLatch
+{
+  public:
+  explicit WhenAllLatch(const std::size_t count) noexcept
+    : m_count(count + 1u)
+  {}
+
+  /// @brief - Register the awaiting coroutine once all the tasks are started.
+  /// @param awaiting - the coroutine to resume when the tasks are done.
+  /// @return - `false` if all the tasks are already done, in which case the
+  /// coroutine should not be suspended.
+  bool suspend(std::coroutine_handle<> awaiting) noexcept
+  {
+    m_awaiting = awaiting;
+    return m_count.fetch_sub(1u, std::memory_order_acq_rel) > 1u;
+  }
+
+  /// @brief - Notify that a task is done.
+  /// @return - the coroutine to resume next.
+  auto arrive() noexcept -> std::coroutine_handle<>
+  {
+    if (m_count.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+    {
+      return m_awaiting;
+    }
+
+    return std::noop_coroutine();
+  }
+
+  private:
+  std::atomic_size_t m_count;
+  std::coroutine_handle<> m_awaiting{};
+};
+
+/// @brief - A coroutine awaiting one of the tasks of a `whenAll` and notifying the
+/// latch once it is done.
+class WhenAllTask
+{
+  public:
+  class promise_type : public PooledPromise
+  {
+    public:
+    struct FinalAwaiter
+    {
+      bool await_ready() const noexcept
+      {
+        return false;
+      }
+
+      auto await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+        -> std::coroutine_handle<>
+      {
+        return handle.promise().m_latch->arrive();
+      }
+
+      void await_resume() const noexcept {}
+    };
+
+    auto get_return_object() noexcept -> WhenAllTask
+    {
+      return WhenAllTask(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    auto initial_suspend() const noexcept -> std::suspend_always
+    {
+      return {};
+    }
+
+    auto final_suspend() const noexcept -> FinalAwaiter
+    {
+      return {};
+    }
+
+    void return_void() const noexcept {}
+
+    void unhandled_exception() const noexcept
+    {
+      // The body of the coroutine catches all exceptions.
+      std::terminate();
+    }
+
+    WhenAllLatch *m_latch{nullptr};
+  };
+
+  explicit WhenAllTask(std::coroutine_handle<promise_type> handle) noexcept
+    : m_handle(handle)
+  {}
+
+  ~WhenAllTask()
+  {
+    if (m_handle)
+    {
+      m_handle.destroy();
+    }
+  }
+
+  WhenAllTask(WhenAllTask &&rhs) noexcept
+    : m_handle(std::exchange(rhs.m_handle, {}))
+  {}
+
+  WhenAllTask(const WhenAllTask &) = delete;
+  WhenAllTask &operator=(const WhenAllTask &) = delete;
+  WhenAllTask &operator=(WhenAllTask &&) = delete;
+
+  void start(WhenAllLatch &latch) noexcept
+  {
+    m_handle.promise().m_latch = &latch;
+    m_handle.resume();
+  }
+
+  private:
+  std::coroutine_handle<promise_type> m_handle;
+};
+
+template<typename T>
+inline auto makeWhenAllTask(Task<T> task,
+                            std::optional<TaskValue<T>> &value,
+                            std::exception_ptr &exception) -> WhenAllTask
+{
+  try
+  {
+    if constexpr (std::is_void<T>::value)
+    {
+      co_await task;
+      value.emplace();
+    }
+    else
+    {
+      value.emplace(co_await task);
+    }
+  }
+  catch (...)
+  {
+    exception = std::current_exception();
+  }
+}
+
+struct WhenAllAwaiter
+{
+  WhenAllLatch &latch;
+  std::vector<WhenAllTask> &tasks;
+
+  bool await_ready() const noexcept
+  {
+    return false;
+  }
+
+  bool await_suspend(std::coroutine_handle<> awaiting) noexcept
+  {
+    for (auto &task : tasks)
+    {
+      task.start(latch);
+    }
+
+    return latch.suspend(awaiting);
+  }
+
+  void await_resume() const noexcept {}
+};
+
+/// @brief - The state of a `whenAny`, shared by the tasks as they might complete
+/// after the awaiting coroutine was resumed. The first task to complete and the
+/// awaiting coroutine, once all the tasks started, both arrive: the last of them
+/// resumes the awaiting coroutine.
+template<typename T>
+struct WhenAnyState
+{
+  std::atomic_bool decided{false};
+  std::atomic_uint arrivals{0u};
+  std::coroutine_handle<> awaiting{};
+
+  std::size_t index{0u};
+  std::optional<TaskValue<T>> value{};
+  std::exception_ptr exception{};
+
+  auto arrive() noexcept -> std::coroutine_handle<>
+  {
+    if (arrivals.fetch_add(1u, std::memory_order_acq_rel) == 1u)
+    {
+      return awaiting;
+    }
+
+    return std::noop_coroutine();
+  }
+};
+
+/// @brief - A coroutine awaiting one of the tasks of a `whenAny`. It is detached
+/// once started and destroys itself when done: the coroutine returns the one to
+/// resume next.
+class WhenAnyTask
+{
+  public:
+  class promise_type : public PooledPromise
+  {
+    public:
+    struct FinalAwaiter
+    {
+      bool await_ready() const noexcept
+      {
+        return false;
+      }
+
+      auto await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+        -> std::coroutine_handle<>
+      {
+        const auto next = handle.promise().m_next;
+        handle.destroy();
+        return next;
+      }
+
+      void await_resume() const noexcept {}
+    };
+
+    auto get_return_object() noexcept -> WhenAnyTask
+    {
+      return WhenAnyTask(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    auto initial_suspend() const noexcept -> std::suspend_always
+    {
+      return {};
+    }
+
+    auto final_suspend() const noexcept -> FinalAwaiter
+    {
+      return {};
+    }
+
+    void return_value(std::coroutine_handle<> next) noexcept
+    {
+      m_next = next;
+    }
+
+    void unhandled_exception() const noexcept
+    {
+      // The body of the coroutine catches all exceptions.
+      std::terminate();
+    }
+
+    private:
+    std::coroutine_handle<> m_next{std::noop_coroutine()};
+  };
+
+  explicit WhenAnyTask(std::coroutine_handle<promise_type> handle) noexcept
+    : m_handle(handle)
+  {}
+
+  ~WhenAnyTask()
+  {
+    if (m_handle)
+    {
+      m_handle.destroy();
+    }
+  }
+
+  WhenAnyTask(WhenAnyTask &&rhs) noexcept
+    : m_handle(std::exchange(rhs.m_handle, {}))
+  {}
+
+  WhenAnyTask(const WhenAnyTask &) = delete;
+  WhenAnyTask &operator=(const WhenAnyTask &) = delete;
+  WhenAnyTask &operator=(WhenAnyTask &&) = delete;
+
+  void start() noexcept
+  {
+    std::exchange(m_handle, {}).resume();
+  }
+
+  private:
+  std::coroutine_handle<promise_type> m_handle;
+};
+
+template<typename T>
+inline auto makeWhenAnyTask(Task<T> task,
+                            std::shared_ptr<WhenAnyState<T>> state,
+                            const std::size_t index) -> WhenAnyTask
+{
+  std::optional<TaskValue<T>> value;
+  std::exception_ptr exception;
+
+  try
+  {
+    if constexpr (std::is_void<T>::value)
+    {
+      co_await task;
+      value.emplace();
+    }
+    else
+    {
+      value.emplace(co_await task);
+    }
+  }
+  catch (...)
+  {
+    exception = std::current_exception();
+  }
+
+  if (state->decided.exchange(true, std::memory_order_acq_rel))
+  {
+    co_return std::noop_coroutine();
+  }
+
+  state->index     = index;
+  state->value     = std::move(value);
+  state->exception = exception;
+
+  co_return state->arrive();
+}
+
+template<typename T>
+struct WhenAnyAwaiter
+{
+  WhenAnyState<T> &state;
+  std::vector<WhenAnyTask> &tasks;
+
+  bool await_ready() const noexcept
+  {
+    return false;
+  }
+
+  bool await_suspend(std::coroutine_handle<> awaiting) noexcept
+  {
+    state.awaiting = awaiting;
+    for (auto &task : tasks)
+    {
+      task.start();
+    }
+
+    return state.arrivals.fetch_add(1u, std::memory_order_acq_rel) == 0u;
+  }
+
+  void await_resume() const noexcept {}
+};
+
+} // namespace details
+
+template<typename T>
+inline auto whenAll(std::vector<Task<T>> tasks) -> Task<WhenAllResult<T>>
+{
+  std::vector<std::optional<details::TaskValue<T>>> values(tasks.size());
+  std::vector<std::exception_ptr> exceptions(tasks.size());
+
+  std::vector<details::WhenAllTask> children;
+  children.reserve(tasks.size());
+  for (std::size_t id = 0u; id < tasks.size(); ++id)
+  {
+    children.push_back(details::makeWhenAllTask(std::move(tasks[id]), values[id], exceptions[id]));
+  }
+
+  details::WhenAllLatch latch(children.size());
+  co_await details::WhenAllAwaiter{latch, children};
+
+  for (const auto &exception : exceptions)
+  {
+    if (exception)
+    {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  if constexpr (std::is_void<T>::value)
+  {
+    co_return;
+  }
+  else
+  {
+    std::vector<T> out;
+    out.reserve(values.size());
+    for (auto &value : values)
+    {
+      out.push_back(std::move(*value));
+    }
+
+    co_return out;
+  }
+}
+
+template<typename T>
+inline auto whenAny(std::vector<Task<T>> tasks) -> Task<WhenAnyResult<T>>
+{
+  if (tasks.empty())
+  {
+    throw CoreException("Failed to wait for any task",
+                        "task",
+                        "utils",
+                        std::string("No task to wait for"));
+  }
+
+  auto state = std::make_shared<details::WhenAnyState<T>>();
+
+  std::vector<details::WhenAnyTask> children;
+  children.reserve(tasks.size());
+  for (std::size_t id = 0u; id < tasks.size(); ++id)
+  {
+    children.push_back(details::makeWhenAnyTask(std::move(tasks[id]), state, id));
+  }
+
+  co_await details::WhenAnyAwaiter<T>{*state, children};
+
+  if (state->exception)
+  {
+    std::rethrow_exception(state->exception);
+  }
+
+  if constexpr (std::is_void<T>::value)
+  {
+    co_return state->index;
+  }
+  else
+  {
+    co_return WhenAnyResult<T>{state->index, std::move(*state->value)};
+  }
+}
+
+} // namespace utils
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace utils {
+
+/// @brief - A Chase-Lev work stealing deque. The owner of the deque pushes and
+/// pops elements at the bottom without any lock while other threads can steal
+/// elements from the top. The implementation follows the paper "Correct and
+/// Efficient Work-Stealing for Weak Memory Models" (Le et al., 2013).
+/// The elements are expected to be pointers: a `nullptr` value is returned to
+/// indicate that no element could be fetched.
+template<typename T>
+class WorkStealingDeque
+{
+  static_assert(std::is_pointer<T>::value, "Must be a pointer type");
+
+  public:
+  /// @brief - Create a new deque with the specified initial capacity. The value
+  /// is rounded up to the next power of two. The deque grows automatically when
+  /// more elements are pushed.
+  /// @param capacity - the initial capacity of the deque.
+  WorkStealingDeque(const std::size_t capacity = 64u);
+
+  ~WorkStealingDeque() = default;
+
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+  WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+  /// @brief - Push a new element at the bottom of the deque. Should only be
+  /// called by the owner of the deque.
+  /// @param item - the element to push.
+  void push(T item);
+
+  /// @brief - Pop the element at the bottom of the deque, i.e. the last one
+  /// pushed. Should only be called by the owner of the deque.
+  /// @return - the element or `nullptr` if the deque is empty.
+  auto pop() noexcept -> T;
+
+  /// @brief - Steal the element at the top of the deque, i.e. the oldest one.
+  /// Can be called by any thread.
+  /// @return - the element or `nullptr` if the deque is empty or if another
+  /// thread won the race to get it.
+  auto steal() noexcept -> T;
+
+  /// @brief - Return an approximation of the number of elements in the deque.
+  /// The value might be outdated as soon as it is returned.
+  /// @return - the approximate size of the deque.
+  auto size() const noexcept -> std::size_t;
+
+  /// @brief - Whether the deque seems empty. Same remark as for `size`.
+  /// @return - `true` if the deque seems empty.
+  bool empty() const noexcept;
+
+  private:
+  /// @brief - A circular array of elements. Its capacity is a power of two so
+  /// that indices can be wrapped with a mask.
+  struct Buffer
+  {
+    Buffer(const std::int64_t capacity);
+
+    auto get(const std::int64_t id) const noexcept -> T;
+    void put(const std::int64_t id, T item) noexcept;
+
+    std::int64_t capacity;
+    std::int64_t mask;
+    std::unique_ptr<std::atomic<T>[]> items;
+  };
+
+  /// @brief - Create a buffer twice as big as the input one and copy the
+  /// elements in the range `[top; bottom[` in it.
+  /// @param buffer - the buffer to grow.
+  /// @param bottom - the current bottom of the deque.
+  /// @param top - the current top of the deque.
+  /// @return - the new buffer.
+  auto grow(Buffer *buffer, const std::int64_t bottom, const std::int64_t top) -> Buffer *;
+
+  private:
+  /// @brief - The index of the oldest element, where thieves steal from. We keep
+  /// it on its own cache line to avoid false sharing with the bottom index which
+  /// is only written by the owner.
+  alignas(64) std::atomic<std::int64_t> m_top{0};
+
+  /// @brief - The index where the next element will be pushed by the owner.
+  alignas(64) std::atomic<std::int64_t> m_bottom{0};
+
+  /// @brief - The buffer currently used to store the elements.
+  std::atomic<Buffer *> m_buffer{nullptr};
+
+  /// @brief - All the buffers ever allocated by this deque. As thieves might
+  /// still be reading from an old buffer while the owner grows the deque we
+  /// can't release them before the deque itself is destroyed.
+  std::vector<std::unique_ptr<Buffer>> m_buffers{};
+};
+
+} // namespace utils
+
+#include "WorkStealingDeque.hxx"
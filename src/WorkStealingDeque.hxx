@@ -0,0 +1,147 @@
+#pragma once
+
+#include "WorkStealingDeque.hh"
+
+namespace utils {
+
+template<typename T>
+inline WorkStealingDeque<T>::Buffer::Buffer(const std::int64_t cap)
+  : capacity(cap)
+  , mask(cap - 1)
+  , items(std::make_unique<std::atomic<T>[]>(cap))
+{}
+
+template<typename T>
+inline auto WorkStealingDeque<T>::Buffer::get(const std::int64_t id) const noexcept -> T
+{
+  return items[id & mask].load(std::memory_order_relaxed);
+}
+
+template<typename T>
+inline void WorkStealingDeque<T>::Buffer::put(const std::int64_t id, T item) noexcept
+{
+  items[id & mask].store(item, std::memory_order_relaxed);
+}
+
+template<typename T>
+inline WorkStealingDeque<T>::WorkStealingDeque(const std::size_t capacity)
+{
+  std::int64_t cap = 1;
+  while (cap < static_cast<std::int64_t>(capacity))
+  {
+    cap <<= 1;
+  }
+
+  m_buffers.push_back(std::make_unique<Buffer>(cap));
+  m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+}
+
+template<typename T>
+inline void WorkStealingDeque<T>::push(T item)
+{
+  const auto b = m_bottom.load(std::memory_order_relaxed);
+  const auto t = m_top.load(std::memory_order_acquire);
+  auto *a      = m_buffer.load(std::memory_order_relaxed);
+
+  if (b - t > a->capacity - 1)
+  {
+    a = grow(a, b, t);
+  }
+
+  a->put(b, item);
+  std::atomic_thread_fence(std::memory_order_release);
+  m_bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+template<typename T>
+inline auto WorkStealingDeque<T>::pop() noexcept -> T
+{
+  const auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+  auto *a      = m_buffer.load(std::memory_order_relaxed);
+  m_bottom.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto t = m_top.load(std::memory_order_relaxed);
+
+  if (t > b)
+  {
+    // The deque is empty: restore the bottom index.
+    m_bottom.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  T item = a->get(b);
+  if (t == b)
+  {
+    // This is the last element: we might race with a thief.
+    if (!m_top.compare_exchange_strong(t,
+                                       t + 1,
+                                       std::memory_order_seq_cst,
+                                       std::memory_order_relaxed))
+    {
+      item = nullptr;
+    }
+    m_bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  return item;
+}
+
+template<typename T>
+inline auto WorkStealingDeque<T>::steal() noexcept -> T
+{
+  auto t = m_top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const auto b = m_bottom.load(std::memory_order_acquire);
+
+  if (t >= b)
+  {
+    return nullptr;
+  }
+
+  auto *a = m_buffer.load(std::memory_order_acquire);
+  T item  = a->get(t);
+  if (!m_top.compare_exchange_strong(t,
+                                     t + 1,
+                                     std::memory_order_seq_cst,
+                                     std::memory_order_relaxed))
+  {
+    // Another thread (owner or thief) won the race for this element.
+    return nullptr;
+  }
+
+  return item;
+}
+
+template<typename T>
+inline auto WorkStealingDeque<T>::size() const noexcept -> std::size_t
+{
+  const auto b = m_bottom.load(std::memory_order_relaxed);
+  const auto t = m_top.load(std::memory_order_relaxed);
+  return b > t ? static_cast<std::size_t>(b - t) : 0u;
+}
+
+template<typename T>
+inline bool WorkStealingDeque<T>::empty() const noexcept
+{
+  return size() == 0u;
+}
+
+template<typename T>
+inline auto WorkStealingDeque<T>::grow(Buffer *buffer,
+                                       const std::int64_t bottom,
+                                       const std::int64_t top) -> Buffer *
+{
+  auto next = std::make_unique<Buffer>(buffer->capacity * 2);
+  for (auto id = top; id < bottom; ++id)
+  {
+    next->put(id, buffer->get(id));
+  }
+
+  auto *out = next.get();
+  m_buffers.push_back(std::move(next));
+  m_buffer.store(out, std::memory_order_release);
+
+  return out;
+}
+
+} // namespace utils
@@ -16,6 +16,12 @@ class ILogger
 
   virtual void setLevel(const Severity severity) noexcept = 0;
 
+  /// @brief - Whether a message with the input severity would be displayed. This
+  /// allows to skip building messages which would be discarded anyway.
+  /// @param severity - the severity of the message.
+  /// @return - `true` if messages with this severity are displayed.
+  virtual bool isEnabled(const Severity severity) const noexcept = 0;
+
   virtual void verbose(const std::string &message,
                        const std::string &module,
                        const std::string &service) const = 0;
@@ -13,6 +13,11 @@ void NullLogger::setLevel(const Severity /*severity*/) noexcept
   // Intentionally empty
 }
 
+bool NullLogger::isEnabled(const Severity /*severity*/) const noexcept
+{
+  return false;
+}
+
 void NullLogger::verbose(const std::string & /*message*/,
                          const std::string & /*module*/,
                          const std::string & /*service*/) const
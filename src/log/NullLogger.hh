@@ -12,6 +12,8 @@ class NullLogger : public ILogger
 
   void setLevel(const Severity severity) noexcept override;
 
+  bool isEnabled(const Severity severity) const noexcept override;
+
   void verbose(const std::string &message,
                const std::string &module,
                const std::string &service) const override;
@@ -11,7 +11,21 @@ auto consolidate(const std::string &str) -> std::string
     return str;
   }
 
-  return "[" + str + "]";
+  std::string out;
+  out.reserve(str.size() + 2u);
+  out.append(1u, '[').append(str).append(1u, ']');
+
+  return out;
+}
+
+/// @brief - Append the consolidated version of the input string to the output
+/// one, separated by a space. The result is built in place rather than with
+/// temporaries, which gcc wrongly flags as overlapping copies in release.
+void appendConsolidated(std::string &out, const std::string &str)
+{
+  const auto suffix = consolidate(str);
+  out.reserve(out.size() + 1u + suffix.size());
+  out.append(1u, ' ').append(suffix);
 }
 } // namespace
 
@@ -43,7 +57,7 @@ void PrefixedLogger::addModule(const std::string &module) noexcept
 {
   if (!module.empty())
   {
-    m_module += " " + consolidate(module);
+    appendConsolidated(m_module, module);
   }
 }
 
@@ -59,7 +73,7 @@ void PrefixedLogger::addService(const std::string &service) noexcept
 {
   if (!service.empty())
   {
-    m_service += " " + consolidate(service);
+    appendConsolidated(m_service, service);
   }
 }
 
@@ -73,6 +87,11 @@ void PrefixedLogger::setLevel(const Severity severity) noexcept
   Locator::getLogger().setLevel(severity);
 }
 
+bool PrefixedLogger::isEnabled(const Severity severity) const noexcept
+{
+  return Locator::getLogger().isEnabled(severity);
+}
+
 void PrefixedLogger::verbose(const std::string &message) const
 {
   Locator::getLogger().verbose(message, m_module, m_service);
@@ -104,7 +123,7 @@ auto concatenate(const std::string &str, const std::string &suffix)
   auto out = consolidate(str);
   if (!suffix.empty())
   {
-    out += " " + consolidate(suffix);
+    appendConsolidated(out, suffix);
   }
 
   return out;
@@ -45,6 +45,8 @@ class PrefixedLogger : public ILogger
 
   void setLevel(const Severity severity) noexcept override;
 
+  bool isEnabled(const Severity severity) const noexcept override;
+
   void verbose(const std::string &message) const;
   void debug(const std::string &message) const;
   void info(const std::string &message) const;
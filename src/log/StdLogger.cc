@@ -14,7 +14,6 @@ void StdLogger::setAllowLog(const bool allowLog) noexcept
 
 void StdLogger::setLevel(const Severity severity) noexcept
 {
-  const std::lock_guard guard(m_locker);
   m_severity = severity;
 }
 
@@ -80,18 +79,24 @@ auto getTimestampAsStr() -> std::string
 }
 } // namespace
 
+bool StdLogger::isEnabled(const Severity severity) const noexcept
+{
+  return m_allowLog && canBeDisplayed(severity, m_severity);
+}
+
 void StdLogger::logTrace(const Severity severity,
                          const std::string &message,
                          const std::string &module,
                          const std::string &service,
                          const std::optional<std::string> &cause) const
 {
-  const std::lock_guard guard(m_locker);
-  if (!m_allowLog || !canBeDisplayed(severity, m_severity))
+  if (!isEnabled(severity))
   {
     return;
   }
 
+  const std::lock_guard guard(m_locker);
+
   std::stringstream out;
 
   setStreamColor(out, Color::MAGENTA);
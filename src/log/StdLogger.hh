@@ -2,6 +2,7 @@
 #pragma once
 
 #include "ILogger.hh"
+#include <atomic>
 #include <mutex>
 
 namespace utils::log {
@@ -16,6 +17,8 @@ class StdLogger : public ILogger
 
   void setLevel(const Severity severity) noexcept override;
 
+  bool isEnabled(const Severity severity) const noexcept override;
+
   void verbose(const std::string &message,
                const std::string &module,
                const std::string &service) const override;
@@ -39,8 +42,8 @@ class StdLogger : public ILogger
 
   private:
   mutable std::mutex m_locker{};
-  bool m_allowLog{true};
-  Severity m_severity{Severity::DEBUG};
+  std::atomic_bool m_allowLog{true};
+  std::atomic<Severity> m_severity{Severity::DEBUG};
 
   void logTrace(const Severity severity,
                 const std::string &message,